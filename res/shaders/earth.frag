@@ -5,17 +5,49 @@ in vec3 FragPos;
 
 out vec4 FragColor;
 
-uniform sampler2D dayEarthTexture;
-uniform sampler2D nightEarthTexture;
-uniform float nightIntensity; // Сила ночной текстуры
-uniform vec3 lightPos; // Позиция источника света (в мировых координатах)
-uniform vec3 lightColor;
-
-uniform float ambientStrength;
-uniform float specularStrength;
-uniform vec3 viewPos;
+// Слои Earth::MapLayer: 0 - день, 1 - ночь
+uniform sampler2DArray earthMaps;
+
+// Виртуальная текстура дня (VirtualTexture): атлас тайлов и таблица страниц
+uniform sampler2D virtualAtlas;
+uniform sampler2D virtualPageTable;
+uniform int virtualMaxLevel; // -1 - нет, только слой дня earthMaps
+uniform vec3 virtualLayout; // размер тайла, рамка, размер атласа (тексели)
+layout (std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+};
+
+layout (std140) uniform Lighting {
+    vec3 lightPos; // Позиция источника света (в мировых координатах)
+    float ambientStrength;
+    vec3 lightColor;
+    float specularStrength;
+    float nightIntensity; // Сила ночной текстуры
+};
 //uniform vec3 objectColor;
 
+vec3 virtualColor(vec2 uv, vec3 fallback) {
+    // Уровень дерева: размер пикселя в текселях самого подробного уровня
+    vec2 texels = uv * vec2(2.0, 1.0) * exp2(float(virtualMaxLevel)) * virtualLayout.x;
+    float footprint = max(length(dFdx(texels)), length(dFdy(texels)));
+    int level = clamp(virtualMaxLevel - int(ceil(log2(max(footprint, 1e-6)))), 0, virtualMaxLevel);
+
+    // Запись таблицы: слот самого подробного загруженного тайла не глубже level
+    vec2 wrapped = vec2(fract(uv.x), clamp(uv.y, 0.0, 0.999999));
+    vec4 entry = textureLod(virtualPageTable, wrapped, float(virtualMaxLevel - level));
+    if (entry.a < 0.5)
+        return fallback;
+    vec2 slot = floor(entry.rg * 255.0 + 0.5);
+    float resident = floor(entry.b * 255.0 + 0.5);
+
+    vec2 inTile = fract(wrapped * vec2(2.0, 1.0) * exp2(resident));
+    float slotSize = virtualLayout.x + 2.0 * virtualLayout.y;
+    vec2 atlasTexel = slot * slotSize + virtualLayout.y + inTile * virtualLayout.x;
+    return textureLod(virtualAtlas, atlasTexel / virtualLayout.z, 0.0).rgb;
+}
+
 void main() {
     // Ambient освещение (фоновый свет)
     //float ambientStrength = 0.1;
@@ -35,9 +67,11 @@ void main() {
 
     vec3 lightning = ambient + diffuse + specular;
 
-    // Текстуры
-    vec3 dayColor = texture(dayEarthTexture, UV).rgb;
-    vec3 nightColor = texture(nightEarthTexture, UV).rgb;
+    // Текстуры: оба слоя из одного массива по одним координатам
+    vec3 dayColor = texture(earthMaps, vec3(UV, 0.0)).rgb;
+    vec3 nightColor = texture(earthMaps, vec3(UV, 1.0)).rgb;
+    if (virtualMaxLevel >= 0)
+        dayColor = virtualColor(UV, dayColor);
 
     // Смешивание: ночная текстура появится там, где мало света
     float nightFactor = 1.0 - max(max(lightning.r, lightning.g), lightning.b);
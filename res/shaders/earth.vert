@@ -8,8 +8,14 @@ out vec3 Normal;
 out vec3 FragPos;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+uniform mat3 normalMatrix; // transpose(inverse(mat3(model))), считается на CPU
+
+// общие для всех программ данные кадра (FrameUniforms)
+layout (std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+};
 
 void main() {
     // преобразуем позицию в мировые координаты
@@ -18,5 +24,5 @@ void main() {
     gl_Position = projection * view * model * vec4(aPos, 1.0);
     UV = aUV;
     // Передаем нормаль (учитываем поворот модели, но не масштабирование)
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    Normal = normalMatrix * aNormal;
 }
\ No newline at end of file
@@ -0,0 +1,12 @@
+#version 330 core
+in vec3 Color;
+
+out vec4 FragColor;
+
+void main() {
+    // круглая точка вместо квадрата
+    vec2 offset = gl_PointCoord - vec2(0.5);
+    if (dot(offset, offset) > 0.25)
+        discard;
+    FragColor = vec4(Color, 1.0);
+}
@@ -0,0 +1,29 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in float aLight;  // доля диска Солнца; < 0 - положение не посчитано
+layout (location = 2) in vec4 aColor;
+layout (location = 3) in float aSize;
+
+out vec3 Color;
+
+layout (std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+};
+
+uniform float shadowBrightness;
+
+void main() {
+    if (aLight < 0.0) {
+        // за пределами отсекающего объёма - точка отбрасывается
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        gl_PointSize = 0.0;
+        Color = vec3(0.0);
+        return;
+    }
+    // положения уже в системе сцены, матрица модели не нужна
+    gl_Position = projection * view * vec4(aPos, 1.0);
+    gl_PointSize = aSize;
+    Color = aColor.rgb * mix(shadowBrightness, 1.0, aLight);
+}
@@ -0,0 +1,146 @@
+#version 330 core
+// Околоземная часть SGP4 для одного объекта на вершину (gl_VertexID - индекс
+// в пакете), одинарная точность. Угловые элементы приведены на CPU к опорному
+// моменту, minutes - время от него, поэтому линейные по времени члены не теряют
+// точность; многочлены торможения считаются от эпохи TLE (t), они малы
+
+uniform samplerBuffer coefficients;     // 9 текселей RGBA32F на объект
+uniform float minutes;
+uniform mat3 temeToScene;
+uniform vec3 sunPosition;               // TEME, км
+uniform float xke;
+uniform float j2;
+uniform float earthRadius;
+uniform float sunRadius;
+
+out vec3 outPosition;   // система сцены
+out float outLight;     // доля диска Солнца; -1 - положение не посчитано
+
+const float twoPi = 6.28318530717958648;
+
+float fmod2pi(float x) {
+    return x - twoPi * floor(x / twoPi);
+}
+
+// Доля видимого диска Солнца по конической модели тени, как Illumination
+float sunlitFraction(vec3 p) {
+    vec3 d = sunPosition - p;
+    float r = length(p);
+    float dist = length(d);
+    float sinB = min(earthRadius / r, 1.0);
+    float sinA = sunRadius / dist;
+    float cosB = sqrt(1.0 - sinB * sinB);
+    float cosA = sqrt(1.0 - sinA * sinA);
+    float cosC = -dot(p, d) / (r * dist);
+    float inner = cosA * cosB + sinA * sinB;
+    return clamp((inner - cosC) / (2.0 * sinA * sinB), 0.0, 1.0);
+}
+
+void main() {
+    int base = gl_VertexID * 9;
+    vec4 c0 = texelFetch(coefficients, base);
+    vec4 c1 = texelFetch(coefficients, base + 1);
+    vec4 c2 = texelFetch(coefficients, base + 2);
+    vec4 c3 = texelFetch(coefficients, base + 3);
+    vec4 c4 = texelFetch(coefficients, base + 4);
+    vec4 c5 = texelFetch(coefficients, base + 5);
+    vec4 c6 = texelFetch(coefficients, base + 6);
+    vec4 c7 = texelFetch(coefficients, base + 7);
+    vec4 c8 = texelFetch(coefficients, base + 8);
+
+    float dt = minutes;
+    float t = c0.x + dt;    // минуты от эпохи TLE
+    float bstar = c2.x;
+
+    // Вековые возмущения от гравитации и торможения
+    float xmdf = c0.y + c0.z * dt;
+    float argpdf = c0.w + c1.x * dt;
+    float t2 = t * t;
+    float nodem = c1.y + c1.z * dt + c1.w * dt * dt;
+    float tempa = 1.0 - c2.y * t;
+    float tempe = bstar * c2.z * t;
+    float templ = c3.x * t2;
+
+    float delmtemp = 1.0 + c5.y * cos(xmdf);
+    float delm = c5.x * (delmtemp * delmtemp * delmtemp - c5.z);
+    float temp = c4.w * t + delm;
+    float mm = xmdf + temp;
+    float argpm = argpdf - temp;
+    float t3 = t2 * t;
+    float t4 = t3 * t;
+    tempa = tempa - c4.x * t2 - c4.y * t3 - c4.z * t4;
+    tempe = tempe + bstar * c2.w * (sin(mm) - c5.w);
+    templ = templ + c3.y * t3 + t4 * (c3.z + t * c3.w);
+
+    float am = c6.x * tempa * tempa;
+    float nm = xke / (am * sqrt(am));
+    float em = c6.z - tempe;
+    bool invalid = em >= 1.0 || em < -0.001;
+    em = max(em, 1.0e-6);
+
+    mm = mm + c6.y * templ;
+    float xlm = mm + argpm + nodem;
+    nodem = fmod2pi(nodem);
+    argpm = fmod2pi(argpm);
+    xlm = fmod2pi(xlm);
+    mm = fmod2pi(xlm - argpm - nodem);
+
+    // Долгопериодические члены
+    float axnl = em * cos(argpm);
+    temp = 1.0 / (am * (1.0 - em * em));
+    float aynl = em * sin(argpm) + temp * c7.z;
+    float xl = mm + argpm + nodem + temp * c7.w * axnl;
+
+    // Уравнение Кеплера
+    float u = fmod2pi(xl - nodem);
+    float eo1 = u;
+    float sineo1 = 0.0;
+    float coseo1 = 0.0;
+    for (int ktr = 0; ktr < 10; ktr++) {
+        sineo1 = sin(eo1);
+        coseo1 = cos(eo1);
+        float step = (u - aynl * coseo1 + axnl * sineo1 - eo1) / (1.0 - coseo1 * axnl - sineo1 * aynl);
+        step = clamp(step, -0.95, 0.95);
+        eo1 += step;
+        if (abs(step) < 1.0e-6)
+            break;
+    }
+
+    // Короткопериодические члены
+    float ecose = axnl * coseo1 + aynl * sineo1;
+    float esine = axnl * sineo1 - aynl * coseo1;
+    float el2 = axnl * axnl + aynl * aynl;
+    float pl = am * (1.0 - el2);
+    invalid = invalid || pl < 0.0;
+
+    float rl = am * (1.0 - ecose);
+    float betal = sqrt(max(1.0 - el2, 0.0));
+    temp = esine / (1.0 + betal);
+    float sinu = am / rl * (sineo1 - aynl - axnl * temp);
+    float cosu = am / rl * (coseo1 - axnl + aynl * temp);
+    float su = atan(sinu, cosu);
+    float sin2u = (cosu + cosu) * sinu;
+    float cos2u = 1.0 - 2.0 * sinu * sinu;
+    temp = 1.0 / pl;
+    float temp1 = 0.5 * j2 * temp;
+    float temp2 = temp1 * temp;
+
+    float mrt = rl * (1.0 - 1.5 * temp2 * betal * c8.x) + 0.5 * temp1 * c8.y * cos2u;
+    su = su - 0.25 * temp2 * c8.z * sin2u;
+    float xnode = nodem + 1.5 * temp2 * c7.x * sin2u;
+    float xinc = c6.w + 1.5 * temp2 * c7.x * c7.y * cos2u;
+    invalid = invalid || mrt < 1.0;
+
+    // Ориентация орбиты
+    float sinsu = sin(su), cossu = cos(su);
+    float snod = sin(xnode), cnod = cos(xnode);
+    float sini = sin(xinc), cosi = cos(xinc);
+    vec3 direction = vec3(
+        -snod * cosi * sinsu + cnod * cossu,
+        cnod * cosi * sinsu + snod * cossu,
+        sini * sinsu);
+    vec3 teme = mrt * earthRadius * direction;
+
+    outPosition = invalid ? vec3(0.0) : temeToScene * teme;
+    outLight = invalid ? -1.0 : sunlitFraction(teme);
+}
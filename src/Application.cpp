@@ -1,7 +1,9 @@
 #include "Application.h"
 
 #include <iostream>
+#include <algorithm>
 #include <cmath>
+#include <cstdio>
 
 Application::Application(const char* appTitle, int appWidth, int appHeight) :
 	title(appTitle), width(appWidth), height(appHeight)
@@ -21,7 +23,7 @@ bool Application::init()
 
 	window = SDL_CreateWindow(title.c_str(), width, height, SDL_WINDOW_OPENGL);
 
-	//   openGL
+	// Настройка контекста openGL
 	context = SDL_GL_CreateContext(window);
 	SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
 	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
@@ -51,27 +53,37 @@ bool Application::init()
 
 void Application::start()
 {
-	//  
-	shaderProgram = Shader::create("res/shaders/earth.vert", "res/shaders/earth.frag");
-
-	//   
-	earth = new Earth();
-
-	//    ()
-	//         ,
-	//    
-	sun.setLightning(shaderProgram);
-
-	//  OpenGL
+	// Загрузка шейдера
+	shaderProgram = new ShaderProgram(Shader::create("res/shaders/earth.vert", "res/shaders/earth.frag"));
+	frameUniforms = new FrameUniforms();
+
+	// Создание модели Земли
+	textureLoader = new TextureLoader();
+	earth = new Earth(*textureLoader);
+	earthTimer = new GpuTimer();
+	satellites = new Satellites();
+
+	// Каталог спутников: БД прошлого запуска, затем источник - в фоне,
+	// чтобы сеть не задерживала кадры
+	dataManager = new DataManager(tleSourceUrl, std::chrono::minutes(120), databasePath);
+	propagation = new PropagationScheduler();
+	gpuPropagator = new GpuPropagator();
+	dataThread = std::thread(&Application::dataLoop, this);
+
+	// Создание источника света (Солнца); дальше положение обновляется
+	// в update() по модельному времени
+	sun.setLightning(*frameUniforms, clock.utc());
+
+	// Настройка OpenGL
 	glEnable(GL_DEPTH_TEST);
 	//glEnable(GL_LIGHTING);
 	glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
 
 	auto previousTime = std::chrono::steady_clock::now();
 	double lag = 0.0;
-	constexpr double fixed_dt = 1.0 / 60.0; //     
+	constexpr double fixed_dt = 1.0 / 60.0; // Фиксированный шаг для обновления физики
 
-	SDL_GL_SetSwapInterval(1); //  vsync
+	SDL_GL_SetSwapInterval(1); // Включаем vsync
 
 	while (isRunning) {
 		auto currentTime = std::chrono::steady_clock::now();
@@ -81,7 +93,7 @@ void Application::start()
 
 		processInput();
 
-		//    ( 5   )
+		// Фиксированное обновление физики (максимум 5 раз за кадр)
 		int updateCount = 0;
 		while (lag >= fixed_dt && updateCount < 5) {
 			update(fixed_dt);
@@ -89,7 +101,7 @@ void Application::start()
 			updateCount++;
 		}
 		
-		//     
+		// Интерполяция для более плавного рендера
 		double alpha = lag / fixed_dt;
 		render(alpha);
 
@@ -99,14 +111,85 @@ void Application::start()
 
 void Application::shutdown()
 {
+	// Поток данных останавливается первым: идущая загрузка дорабатывает до конца
+	{
+		std::lock_guard<std::mutex> lock(dataMutex);
+		dataStopping = true;
+	}
+	dataWake.notify_all();
+	if (dataThread.joinable())
+		dataThread.join();
+	delete propagation;
+	delete gpuPropagator;
+	delete dataManager;
+
 	delete camera;
 	delete earth;
-	glDeleteProgram(shaderProgram);
+	delete textureLoader;
+	delete earthTimer;
+	delete satellites;
+	delete shaderProgram;
+	delete frameUniforms;
 	SDL_GL_DestroyContext(context);
 	SDL_DestroyWindow(window);
 	SDL_Quit();
 }
 
+void Application::dataLoop()
+{
+	if (!dataManager->initialize()) {
+		std::cerr << "Satellite data is unavailable, nothing to track" << std::endl;
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(dataMutex);
+	while (!dataStopping) {
+		lock.unlock();
+		dataManager->update();
+		// Не реже раза в минуту: неудачная загрузка повторяется по расписанию DataManager
+		auto wait = std::clamp(dataManager->timeUntilUpdate(), std::chrono::minutes(1), std::chrono::minutes(60));
+		lock.lock();
+		dataWake.wait_for(lock, wait, [this] { return dataStopping; });
+	}
+}
+
+void Application::uploadSatellites()
+{
+	if (gpuPropagation) {
+		if (!gpuPropagator->propagate(satelliteBatch, clock.utc())) {
+			std::cerr << "Catalog does not fit GPU propagation, falling back to CPU" << std::endl;
+			gpuPropagation = false;
+			propagation->propagate(satelliteBatch, clock.utc(), satelliteBatch.version());
+		}
+		else {
+			{
+				auto lock = dataManager->lockCatalog();
+				satellites->upload(*gpuPropagator, dataManager->getCatalog());
+			}
+			// Сверка читает буфер с GPU - только по запросу и после смены каталога
+			if (gpuCheckedVersion != satelliteBatch.version())
+				gpuCheckPending = true;
+			if (gpuCheckPending) {
+				gpuCheck = gpuPropagator->crossCheck(satelliteBatch);
+				if (gpuCheck.compared > 0) {
+					gpuCheckPending = false;
+					gpuCheckedVersion = satelliteBatch.version();
+					std::cout << "GPU propagation vs CPU: " << gpuCheck.compared << " objects, max "
+						<< gpuCheck.maxErrorKm << " km, rms " << gpuCheck.rmsErrorKm << " km" << std::endl;
+				}
+			}
+			return;
+		}
+	}
+
+	// Последний опубликованный кадр положений; имена и группы - из каталога
+	if (const PositionFrame* frame = propagation->positions().acquire()) {
+		auto lock = dataManager->lockCatalog();
+		satellites->upload(*frame, dataManager->getCatalog());
+		propagation->positions().release(frame);
+	}
+}
+
 void Application::processInput()
 {
 	SDL_Event event;
@@ -160,26 +243,35 @@ void Application::processInput()
 void Application::update(double dt)
 {
 	camera->update(dt);
+	clock.advance(dt);
+	sun.setLightning(*frameUniforms, clock.utc());
+
+	// Положения спутников на модельное время. Пакет пересобирается только
+	// после изменения каталога, сам расчёт идёт без блокировки каталога.
+	// В режиме GPU расчёт - в render(), раз за кадр
+	{
+		auto lock = dataManager->lockCatalog();
+		if (satelliteBatch.isStale(dataManager->getCatalog()))
+			satelliteBatch.build(dataManager->getCatalog());
+	}
+	if (!gpuPropagation)
+		propagation->propagate(satelliteBatch, clock.utc(), satelliteBatch.version());
 	
-	//  
-	Shader::setFloat(shaderProgram, "ambientStrength", inputParams.ambientStrength);
-	Shader::setFloat(shaderProgram, "specularStrength", inputParams.specularStrength);
-	Shader::setVec3(shaderProgram, "objectColor", glm::vec3(0.8f, 0.8f, 0.8f));
-	Shader::setVec3(shaderProgram, "lightColor", glm::vec3(inputParams.lightColor[0], inputParams.lightColor[1], inputParams.lightColor[2]));
-
-	Shader::setFloat(shaderProgram, "nightIntensity", inputParams.nightTextureIntensity);
+	// Настройка освещения; на GPU уходит одним блоком в render()
+	frameUniforms->setLighting(glm::vec3(inputParams.lightColor[0], inputParams.lightColor[1], inputParams.lightColor[2]),
+		inputParams.ambientStrength, inputParams.specularStrength, inputParams.nightTextureIntensity);
 }
 
 void Application::render(double alpha)
 {
-	//  
+	// Очистка буферов
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	
-	//     
+	// Интерполяция позиции камеры для плавности
 	//glm::vec3 renderCameraPos = prevCameraPosition +
 	//	(currentCameraPosition - prevCameraPosition) * alpha;
 
-	////  view    
+	//// Обновляем view матрицу с интерполированной позицией
 	//glm::mat4 interpolatedView = glm::lookAt(
 	//	renderCameraPos,
 	//	glm::vec3(0.0f, 0.0f, 0.0f),
@@ -188,8 +280,21 @@ void Application::render(double alpha)
 
 	camera->render(alpha);
 
-	//  
-	earth->render(camera->getView(), camera->getProjection(), shaderProgram);
+	// Очередная порция текстур на GPU
+	textureLoader->update();
+	earth->stream(*camera);
+
+	// Камера и освещение - один раз за кадр для всех программ
+	frameUniforms->setCamera(camera->getView(), camera->getProjection());
+	frameUniforms->upload();
+
+	// Отрисовка Земли
+	earthTimer->begin();
+	earthStats = earth->render(*shaderProgram, *camera);
+	earthTimer->end();
+	// Спутники после Земли: закрытые ей отсекаются тестом глубины
+	uploadSatellites();
+	satellites->render();
 
 	ImGuiIO& io = ImGui::GetIO();
 	io.DisplaySize.x = static_cast<float>(width);
@@ -213,6 +318,52 @@ void Application::render(double alpha)
 	ImGui::DragFloat("Night Intensity", &inputParams.nightTextureIntensity, 0.01f, 0.0f, 2.0f);
 	ImGui::End();
 
+	ImGui::Begin("GPU time", 0, ImGuiWindowFlags_AlwaysAutoResize);
+	ImGui::Text("Earth: %.3f ms", earthTimer->milliseconds());
+	ImGui::Text("LOD %d segments, %d patches, %d draws, %zu triangles",
+		earthStats.segments, earthStats.patches, earthStats.drawCalls, earthStats.triangles);
+	if (const VirtualTexture* tiles = earth->getDayTiles()) {
+		const VirtualTexture::Stats& tileStats = tiles->getStats();
+		ImGui::Text("Tiles: level %d, %d wanted, %d resident, %d loading, %d uploads",
+			tileStats.level, tileStats.wanted, tileStats.resident, tileStats.loading, tileStats.uploads);
+	}
+	ImGui::End();
+
+	ImGui::Begin("Satellites", 0, ImGuiWindowFlags_AlwaysAutoResize);
+	ImGui::Text("%zu objects (%zu near Earth, %zu deep space), %zu drawn",
+		satelliteBatch.size(), satelliteBatch.nearCount(), satelliteBatch.deepCount(), satellites->count());
+	if (ImGui::Checkbox("GPU propagation", &gpuPropagation))
+		gpuCheckPending = gpuPropagation;
+	if (gpuPropagation) {
+		if (ImGui::Button("Check against CPU"))
+			gpuCheckPending = true;
+		if (gpuCheck.compared > 0)
+			ImGui::Text("GPU vs CPU: %zu objects, max %.3f km, rms %.3f km",
+				gpuCheck.compared, gpuCheck.maxErrorKm, gpuCheck.rmsErrorKm);
+	}
+	ImGui::End();
+
+	ImGui::Begin("Simulation time", 0, ImGuiWindowFlags_AlwaysAutoResize);
+	int year, month, day, hour, minute;
+	double second;
+	clock.utc().toCalendar(year, month, day, hour, minute, second);
+	char utcText[64];
+	std::snprintf(utcText, sizeof(utcText), "%04d-%02d-%02d %02d:%02d:%06.3f UTC",
+		year, month, day, hour, minute, second);
+	ImGui::TextUnformatted(utcText);
+
+	float warp = static_cast<float>(clock.getWarp());
+	if (ImGui::DragFloat("Time warp", &warp, 1.0f, -3600.0f, 3600.0f))
+		clock.setWarp(warp);
+	bool paused = clock.isPaused();
+	if (ImGui::Checkbox("Pause", &paused))
+		clock.setPaused(paused);
+	if (ImGui::Button("Now")) {
+		clock.resetToNow();
+		clock.setWarp(1.0);
+	}
+	ImGui::End();
+
 	ImGui::Render();
 	ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 }
@@ -13,10 +13,22 @@
 
 #include <string>
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
+#include "data/DataManager.h"
+#include "orbit/PropagationScheduler.h"
+#include "orbit/Sgp4Batch.h"
 #include "render/Earth.h"
+#include "render/FrameUniforms.h"
+#include "render/GpuPropagator.h"
+#include "render/GpuTimer.h"
+#include "render/TextureLoader.h"
+#include "render/Satellites.h"
 #include "render/Shaders.h"
 #include "render/Sun.h"
+#include "time/SimulationClock.h"
 #include "Camera.h"
 
 static struct MouseState {
@@ -50,13 +62,42 @@ private:
 	void processInput();
 	void update(double dt);
 	void render(double alpha);
+	void dataLoop();
 
 	SDL_Window* window = nullptr;
 	SDL_GLContext context;
-	GLuint shaderProgram = 0;
+	ShaderProgram* shaderProgram = nullptr;
+	FrameUniforms* frameUniforms = nullptr;	// камера и освещение для всех программ
 	Camera* camera;
+	TextureLoader* textureLoader = nullptr;	// фоновая загрузка текстур
 	Earth* earth = nullptr;
+	GpuTimer* earthTimer = nullptr;	// время отрисовки Земли на GPU
+	Earth::RenderStats earthStats;
+	Satellites* satellites = nullptr;	// кадр положений загружается через upload()
 	Sun sun;
+	SimulationClock clock;	// общее время для орбит и освещения
+
+	// Каталог: загрузка и обновление в потоке dataThread, чтение под lockCatalog().
+	// Вместо URL подойдёт локальный файл или каталог с TLE
+	const char* const tleSourceUrl = "https://celestrak.org/NORAD/elements/gp.php?GROUP=active&FORMAT=tle";
+	const char* const databasePath = "satellites.db";
+	DataManager* dataManager = nullptr;
+	std::thread dataThread;
+	std::mutex dataMutex;
+	std::condition_variable dataWake;
+	bool dataStopping = false;	// под dataMutex
+
+	// Каталог -> пакет SGP4 -> положения на clock.utc() -> Satellites
+	Sgp4Batch satelliteBatch;	// пересобирается после изменения каталога
+	PropagationScheduler* propagation = nullptr;
+	// Режим GPU: положения считает вершинный шейдер прямо в буферы Satellites.
+	// При включении и после смены каталога результат сверяется с CPU
+	GpuPropagator* gpuPropagator = nullptr;
+	bool gpuPropagation = false;
+	bool gpuCheckPending = false;
+	GpuPropagator::CrossCheck gpuCheck;
+	uint64_t gpuCheckedVersion = 0;
+	void uploadSatellites();
 
 	const float mouseSensitivity = 0.01f;
 
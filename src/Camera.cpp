@@ -3,18 +3,19 @@
 #include <iostream>
 
 Camera::Camera(int width, int height)
+	: fov(glm::radians(45.0f)), viewportHeight(height)
 {
 	view = glm::lookAt(
-		position.current,	//  
-		glm::vec3(0.0f, 0.0f, 0.0f),	//   (,    )
-		glm::vec3(0.0f, 1.0f, 0.0f)		//  "" ( (0, 1, 0))
+		position.current,	// позиция камеры
+		glm::vec3(0.0f, 0.0f, 0.0f),	// направление взгляда (точка, в которую смотрит камера)
+		glm::vec3(0.0f, 1.0f, 0.0f)		// вектор "вверх" (обычно (0, 1, 0))
 	);
 
 	projection = glm::perspective(
-		glm::radians(45.0f),	//   (FOV) (45-90 )
-		float(width) / float(height),		//   ( / )
-		0.1f,					//    
-		100.0f					//   
+		fov,					// угол обзора (FOV) (45-90 град)
+		float(width) / float(height),		// соотношение сторон (ширина / высота)
+		0.01f,					// ближняя плоскость отсечения (камера подходит к поверхности)
+		100.0f					// дальняя плоскость отсечения
 	);
 }
 
@@ -26,14 +27,14 @@ void Camera::increasePhi(float deltaPhi)
 void Camera::increaseTheta(float deltaTheta)
 {
 	theta.target += deltaTheta;
-	//  theta,    
+	// ограничиваем theta, чтобы недопустить переворот камеры
 	theta.target = glm::clamp(theta.target, -1.4f, 1.4f);
 }
 
 void Camera::increaseRadius(float deltaR)
 {
 	radius.target -= deltaR * 0.5;
-	radius.target = glm::clamp(radius.target, 3.0f, 15.0f);
+	radius.target = glm::clamp(radius.target, 1.2f, 15.0f);
 }
 
 void Camera::reset()
@@ -62,11 +63,11 @@ void Camera::update(double dt)
 
 void Camera::render(double alpha)
 {
-	//     
+	// Интерполяция позиции камеры для плавности
 	position.render = position.previous +
 		(position.current - position.previous) * float(alpha);
 
-	//  view    
+	// Обновляем view матрицу с интерполированной позицией
 	view = glm::lookAt(
 		position.render,
 		glm::vec3(0.0f, 0.0f, 0.0f),
@@ -14,11 +14,14 @@ public:
 	void increaseRadius(float deltaR);
 
 	void reset();
-	void update(double dt); //        
-	void render(double alpha); //   
+	void update(double dt); // обновляем позицию камеры в соответствии с обработанным вводом
+	void render(double alpha); // обновляем матрицу вида
 
 	glm::mat4 getProjection() const { return projection; }
 	glm::mat4 getView() const { return view; }
+	glm::vec3 getPosition() const { return position.render; }
+	float getFov() const { return fov; }	// по вертикали, рад
+	int getViewportHeight() const { return viewportHeight; }
 
 private:
 	struct Position {
@@ -27,12 +30,14 @@ private:
 		glm::vec3 render = glm::vec3(5.0f, 0.0f, 5.0f);
 	} position;
 	
-	//  
+	// Матрица вида
 	glm::mat4 view;
-	//    (  )
+	// Задает перспективную проекию (имитирует человеческое зрение)
 	glm::mat4 projection;
+	float fov;
+	int viewportHeight;
 
-	//   
+	// параметры положения камеры
 	struct Phi {
 		float current = 0.0f;
 		float target = 0.0f;
@@ -46,6 +51,6 @@ private:
 		float target = 5.0f;
 	} radius;
 
-	const float rotationInterpolationSpeed = 0.1f; //  
+	const float rotationInterpolationSpeed = 0.1f; // в секунду
 	const float scaleInterpolationSpeed = 0.05f;
 };
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <cstddef>
+
+// Ограниченная lock-free очередь "один производитель - один потребитель".
+// При переполнении push() ждёт потребителя (обратное давление на
+// предыдущую стадию), close() завершает поток данных с любой стороны
+template <typename T>
+class BoundedQueue
+{
+public:
+	explicit BoundedQueue(size_t capacity) : slots(roundUpToPowerOfTwo(capacity)), mask(slots.size() - 1) {}
+	BoundedQueue(BoundedQueue&) = delete;
+
+	bool push(T&& value)
+	{
+		size_t tail = tailIndex.load(std::memory_order_relaxed);
+		while (tail - headIndex.load(std::memory_order_acquire) >= slots.size()) {
+			if (closed.load(std::memory_order_acquire))
+				return false;
+			std::this_thread::yield();
+		}
+		if (closed.load(std::memory_order_acquire))
+			return false;
+
+		slots[tail & mask] = std::move(value);
+		tailIndex.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// false - очередь закрыта и пуста
+	bool pop(T& value)
+	{
+		size_t head = headIndex.load(std::memory_order_relaxed);
+		while (head == tailIndex.load(std::memory_order_acquire)) {
+			if (closed.load(std::memory_order_acquire)) {
+				// Производитель мог успеть положить элемент перед закрытием
+				if (head == tailIndex.load(std::memory_order_acquire))
+					return false;
+				break;
+			}
+			std::this_thread::yield();
+		}
+
+		value = std::move(slots[head & mask]);
+		headIndex.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	void close() { closed.store(true, std::memory_order_release); }
+	bool isClosed() const { return closed.load(std::memory_order_acquire); }
+	size_t capacity() const { return slots.size(); }
+
+private:
+	static size_t roundUpToPowerOfTwo(size_t value)
+	{
+		size_t result = 1;
+		while (result < value)
+			result <<= 1;
+		return result;
+	}
+
+	std::vector<T> slots;
+	const size_t mask;
+
+	// Индексы на разных кэш-линиях, чтобы стадии не мешали друг другу
+	alignas(64) std::atomic<size_t> headIndex{ 0 };
+	alignas(64) std::atomic<size_t> tailIndex{ 0 };
+	alignas(64) std::atomic<bool> closed{ false };
+};
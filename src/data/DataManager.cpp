@@ -2,9 +2,16 @@
 
 #include <iostream>
 #include <thread>
+#include <algorithm>
 
 DataManager::DataManager(std::string urlStr, std::chrono::minutes updInterval, const std::string& dbPath) :
-	url(std::move(urlStr)), updateInterval(updInterval), curl(curl_easy_init()), retryCount(0)
+	DataManager(TleSource::fromUrl(urlStr), updInterval, dbPath)
+{
+}
+
+DataManager::DataManager(std::unique_ptr<TleSource> tleSource, std::chrono::minutes updInterval,
+	const std::string& dbPath) :
+	source(std::move(tleSource)), updateInterval(updInterval), retryCount(0)
 {
 	database = std::make_unique<Database>(dbPath);
 	parser = std::make_unique<TleParser>();
@@ -13,11 +20,7 @@ DataManager::DataManager(std::string urlStr, std::chrono::minutes updInterval, c
 	lastAttempt = std::chrono::system_clock::now();
 }
 
-DataManager::~DataManager()
-{
-	if (curl)
-		curl_easy_cleanup(curl);
-}
+DataManager::~DataManager() = default;
 
 bool DataManager::initialize()
 {
@@ -26,19 +29,44 @@ bool DataManager::initialize()
 		return false;
 	}
 
-	if (!curl) {
-		std::cerr << "Failed to initialize CURL" << std::endl;
+	if (!source && groupSources.empty()) {
+		std::cerr << "No data source configured!" << std::endl;
+		return false;
+	}
+
+	if (source && !source->isReady()) {
+		std::cerr << "Failed to initialize data source: " << source->describe() << std::endl;
 		return false;
 	}
 
+	for (const auto& [group, groupSource] : groupSources) {
+		if (!groupSource->isReady()) {
+			std::cerr << "Failed to initialize data source for group " << group << ": "
+				<< groupSource->describe() << std::endl;
+			return false;
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(catalogMutex);
+		catalog.loadFromDatabase(*database);
+	}
+	loadGroupsFromDatabase();
 	return true;
 }
 
 void DataManager::update()
 {
-	if (isUpdateNeeded()) {
+	// Группы обновляются по мере устаревания, самые устаревшие первыми
+	for (const auto& group : scheduler.dueGroups(std::chrono::system_clock::now())) {
+		bool success = refreshGroup(group);
+		if (callback)
+			callback(success);
+	}
+
+	if (source && isSourceUpdateNeeded()) {
 		std::cout << "Starting data update..." << std::endl;
-		bool success = downloadAndProcessData();
+		bool success = downloadAndProcessData(*source);
 		if (success) {
 			lastUpdate = std::chrono::system_clock::now();
 			retryCount = 0;
@@ -57,15 +85,29 @@ void DataManager::update()
 bool DataManager::forceUpdate()
 {
 	std::cout << "Forcing data update..." << std::endl;
-	bool success = downloadAndProcessData();
-	if (success) {
-		lastUpdate = std::chrono::system_clock::now();
-		retryCount = 0;
+	bool success = true;
+	if (source) {
+		success = downloadAndProcessData(*source);
+		if (success) {
+			lastUpdate = std::chrono::system_clock::now();
+			retryCount = 0;
+		}
 	}
+
+	for (const auto& [group, groupSource] : groupSources)
+		success = refreshGroup(group) && success;
+
 	return success;
 }
 
 bool DataManager::isUpdateNeeded() const
+{
+	if (scheduler.hasGroups() && std::chrono::system_clock::now() >= scheduler.nextDue())
+		return true;
+	return source && isSourceUpdateNeeded();
+}
+
+bool DataManager::isSourceUpdateNeeded() const
 {
 	auto now = std::chrono::system_clock::now();
 	auto timeSinceLastUpdate = std::chrono::duration_cast<std::chrono::minutes>(now - lastUpdate);
@@ -75,8 +117,20 @@ bool DataManager::isUpdateNeeded() const
 std::chrono::minutes DataManager::timeUntilUpdate() const
 {
 	auto now = std::chrono::system_clock::now();
-	auto timeSinceLastUpdate = std::chrono::duration_cast<std::chrono::minutes>(now - lastUpdate);
-	return max(std::chrono::minutes(0), updateInterval - timeSinceLastUpdate);
+	auto until = std::chrono::minutes::max();
+
+	if (source) {
+		auto timeSinceLastUpdate = std::chrono::duration_cast<std::chrono::minutes>(now - lastUpdate);
+		until = updateInterval - timeSinceLastUpdate;
+	}
+	if (scheduler.hasGroups()) {
+		auto nextDue = scheduler.nextDue();
+		if (nextDue <= now)
+			return std::chrono::minutes(0);
+		until = std::min(until, std::chrono::duration_cast<std::chrono::minutes>(nextDue - now));
+	}
+
+	return std::max(std::chrono::minutes(0), until);
 }
 
 void DataManager::setUpdateCallback(std::function<void(bool success)> callback)
@@ -84,57 +138,103 @@ void DataManager::setUpdateCallback(std::function<void(bool success)> callback)
 	this->callback = callback;
 }
 
-bool DataManager::downloadAndProcessData()
+void DataManager::setSource(std::unique_ptr<TleSource> tleSource)
 {
-	std::string data;
-	CURLcode res;
+	source = std::move(tleSource);
+}
 
-	curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-	curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
-	curl_easy_setopt(curl, CURLOPT_WRITEDATA, &data);
-	curl_easy_setopt(curl, CURLOPT_USERAGENT, "SatelliteTracker/1.0");
-	curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
-	curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+void DataManager::addGroup(const std::string& group, std::unique_ptr<TleSource> groupSource,
+	RefreshPolicy policy)
+{
+	groupSources[group] = std::move(groupSource);
+	scheduler.addGroup(group, policy);
+}
 
-	res = curl_easy_perform(curl);
+void DataManager::setMetricsFile(const std::string& path)
+{
+	metricsPath = path;
+}
 
-	if (res != CURLE_OK) {
-		std::cerr << "CURL error: " << curl_easy_strerror(res) << std::endl;
+bool DataManager::refreshGroup(const std::string& group)
+{
+	auto it = groupSources.find(group);
+	if (it == groupSources.end())
 		return false;
-	}
 
-	long httpCode = 0;
-	curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
+	std::cout << "Updating group " << group << " (staleness "
+		<< scheduler.staleness(group, std::chrono::system_clock::now()) << ")..." << std::endl;
 
-	if (httpCode != 200) {
-		std::cerr << "HTTP error: " << httpCode << std::endl;
-		return false;
-	}
+	scheduler.beginRefresh(group);
+	bool success = downloadAndProcessData(*it->second, group);
+	scheduler.markRefreshed(group, std::chrono::system_clock::now(), success);
 
-	return processDownloadedData(data);
+	if (!success)
+		std::cerr << "Group " << group << " update failed!" << std::endl;
+	return success;
 }
 
-bool DataManager::processDownloadedData(const std::string& data)
+void DataManager::loadGroupsFromDatabase()
 {
-	if (data.empty()) {
-		std::cerr << "Download data is empty!" << std::endl;
-		return false;
+	// Свежие данные из прошлого запуска не скачиваются повторно
+	auto now = std::chrono::system_clock::now();
+	for (const auto& [group, groupSource] : groupSources) {
+		scheduler.beginRefresh(group);
+		scheduler.observe(group, database->getSatellitesByGroups(group));
+		scheduler.markLoadedFromDatabase(group, now);
 	}
+}
 
-	auto satellites = parser->parseTleData(data);
-	if (satellites.empty()) {
+bool DataManager::downloadAndProcessData(TleSource& from, const std::string& group)
+{
+	IngestPipeline::Settings settings;
+	settings.group = group;
+
+	uint64_t groupBits = 0;
+	if (!group.empty()) {
+		int bit = catalog.groupBit(group);
+		if (bit >= 0)
+			groupBits = uint64_t(1) << bit;
+	}
+
+	// Пакеты попадают в каталог после фиксации всей загрузки. Неизменённые записи
+	// уже в нём (каталог читается из той же БД) - им нужна только группа,
+	// иначе каждое обновление меняло бы version() и сбрасывало кэши
+	IngestPipeline pipeline(from, *parser, *database, settings);
+	pipeline.setBatchObserver([this, &group, groupBits](const std::vector<SatelliteTle>& batch,
+		const std::vector<uint8_t>& changed) {
+		std::lock_guard<std::mutex> lock(catalogMutex);
+		for (size_t i = 0; i < batch.size(); ++i) {
+			SatelliteCatalog::Slot slot = changed[i] ? SatelliteCatalog::invalidSlot
+				: catalog.findSlot(batch[i].noradId);
+			if (slot == SatelliteCatalog::invalidSlot)
+				catalog.upsert(batch[i], groupBits);
+			else if (!group.empty())
+				catalog.addToGroup(slot, group);
+		}
+		if (!group.empty())
+			scheduler.observe(group, batch);
+	});
+	IngestPipeline::Result result = pipeline.run();
+
+	// Сбой записи закрывает очереди, и загрузка тоже обрывается - поэтому
+	// сначала проверяется запись: иначе виноватой выглядела бы загрузка
+	bool success = true;
+	if (!result.stored) {
+		std::cerr << "Failed to store TLE data from " << from.describe() << std::endl;
+		success = false;
+	}
+	else if (!result.fetched) {
+		std::cerr << "Failed to fetch TLE data from " << from.describe() << std::endl;
+		success = false;
+	}
+	else if (result.parsed == 0) {
 		std::cerr << "No satellites parsed from downloaded data!" << std::endl;
-		return false;
+		success = false;
 	}
 
-	//     
-	//if (!database->beginTransaction)
-	return true;
-}
+	metrics.record(result, success);
+	if (!metricsPath.empty())
+		metrics.writePrometheusFile(metricsPath);
 
-size_t DataManager::writeCallback(void* contents, size_t size, size_t nmemb, std::string* data)
-{
-	size_t totalSize = size * nmemb;
-	data->append(static_cast<char*>(contents), totalSize);
-	return totalSize;
+	return success;
 }
@@ -4,17 +4,24 @@
 #include <chrono>
 #include <functional>
 #include <memory>
-
-#include <curl/curl.h>
+#include <mutex>
+#include <unordered_map>
 
 #include "Database.h"
 #include "TleParser.h"
+#include "TleSource.h"
+#include "IngestPipeline.h"
+#include "IngestMetrics.h"
+#include "RefreshScheduler.h"
+#include "SatelliteCatalog.h"
 
 class DataManager
 {
 public:
 	DataManager(std::string urlStr, std::chrono::minutes updInterval,
 		const std::string& dbPath);
+	DataManager(std::unique_ptr<TleSource> tleSource, std::chrono::minutes updInterval,
+		const std::string& dbPath);
 	~DataManager();
 
 	bool initialize();
@@ -25,12 +32,31 @@ public:
 	std::chrono::minutes timeUntilUpdate() const;
 
 	void setUpdateCallback(std::function<void(bool success)> callback);
+	void setSource(std::unique_ptr<TleSource> tleSource);
+	// Группа со своим источником (например, отдельная выборка CelesTrak).
+	// Частота обновления группы определяется устареванием её объектов
+	void addGroup(const std::string& group, std::unique_ptr<TleSource> groupSource,
+		RefreshPolicy policy = RefreshPolicy());
+
+	// Каталог в памяти - основной источник данных во время работы,
+	// БД служит для хранения между запусками. Каталог меняется в потоке,
+	// вызывающем initialize()/update(); другие потоки читают его под lockCatalog()
+	const SatelliteCatalog& getCatalog() const { return catalog; }
+	std::unique_lock<std::mutex> lockCatalog() const { return std::unique_lock<std::mutex>(catalogMutex); }
+
+	const IngestMetrics& getMetrics() const { return metrics; }
+	// Путь для выгрузки метрик в формате Prometheus после каждого обновления
+	void setMetricsFile(const std::string& path);
 
 private:
-	bool downloadAndProcessData();
-	bool processDownloadedData(const std::string& data);
+	bool downloadAndProcessData(TleSource& from, const std::string& group = "");
+	bool refreshGroup(const std::string& group);
+	bool isSourceUpdateNeeded() const;
+	void loadGroupsFromDatabase();
 
-	std::string url;
+	std::unique_ptr<TleSource> source;
+	std::unordered_map<std::string, std::unique_ptr<TleSource>> groupSources;
+	RefreshScheduler scheduler;
 	std::chrono::minutes updateInterval;
 	std::chrono::system_clock::time_point lastUpdate;
 	std::chrono::system_clock::time_point lastAttempt;
@@ -39,8 +65,10 @@ private:
 	std::unique_ptr<Database> database;
 	std::unique_ptr<TleParser> parser;
 
-	CURL* curl;
 	int retryCount;
 
-	static size_t writeCallback(void* contents, size_t size, size_t nmemb, std::string* data);
+	SatelliteCatalog catalog;
+	mutable std::mutex catalogMutex;	// только на время изменений: загрузка идёт без неё
+	IngestMetrics metrics;
+	std::string metricsPath;
 };
\ No newline at end of file
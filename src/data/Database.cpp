@@ -34,7 +34,7 @@ bool Database::createTables()
 			id INTEGER PRIMARY KEY AUTOINCREMENT,
 			norad_id INTEGER NOT NULL,
 			group_name TEXT NOT NULL,
-			FOREIGN KEY (norad_id) REFERENCES satellite (norad_id) ON DELETE CASCADE,
+			FOREIGN KEY (norad_id) REFERENCES satellites (norad_id) ON DELETE CASCADE,
 			UNIQUE(norad_id, group_name)
 		);
 
@@ -115,6 +115,105 @@ bool Database::deleteSatellite(int noradId)
 	return rc == SQLITE_DONE;
 }
 
+int Database::storeSatellites(const std::vector<SatelliteTle>& satellites, const std::string& group,
+	std::vector<uint8_t>* changedFlags)
+{
+	const char* selectSql = "SELECT tle_line1, tle_line2, name FROM satellites WHERE norad_id = ?";
+	const char* upsertSql = R"(
+		INSERT INTO satellites (name, norad_id, tle_line1, tle_line2, epoch)
+		VALUES (?, ?, ?, ?, ?)
+		ON CONFLICT(norad_id) DO UPDATE SET name = excluded.name,
+			tle_line1 = excluded.tle_line1, tle_line2 = excluded.tle_line2,
+			epoch = excluded.epoch, last_update = CURRENT_TIMESTAMP
+	)";
+	const char* groupSql = "INSERT OR IGNORE INTO satellite_groups (norad_id, group_name) VALUES (?, ?)";
+
+	bool ownTransaction = !isTransactionActive;
+	if (!beginTransaction())
+		return -1;
+
+	// Запросы готовятся один раз на весь пакет
+	sqlite3_stmt* selectStmt = nullptr;
+	sqlite3_stmt* upsertStmt = nullptr;
+	sqlite3_stmt* groupStmt = nullptr;
+	if (sqlite3_prepare_v2(db, selectSql, -1, &selectStmt, nullptr) != SQLITE_OK ||
+		sqlite3_prepare_v2(db, upsertSql, -1, &upsertStmt, nullptr) != SQLITE_OK ||
+		(!group.empty() && sqlite3_prepare_v2(db, groupSql, -1, &groupStmt, nullptr) != SQLITE_OK)) {
+		std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << std::endl;
+		sqlite3_finalize(selectStmt);
+		sqlite3_finalize(upsertStmt);
+		sqlite3_finalize(groupStmt);
+		if (ownTransaction)
+			rollbackTransaction();
+		return -1;
+	}
+
+	if (changedFlags)
+		changedFlags->assign(satellites.size(), 0);
+
+	int changed = 0;
+	bool ok = true;
+	for (size_t i = 0; i < satellites.size(); ++i) {
+		const SatelliteTle& satellite = satellites[i];
+		// Дельта: пропускаем спутники, TLE которых не изменились
+		sqlite3_bind_int(selectStmt, 1, satellite.noradId);
+		bool unchanged = false;
+		if (sqlite3_step(selectStmt) == SQLITE_ROW) {
+			unchanged =
+				satellite.tleLine1 == reinterpret_cast<const char*>(sqlite3_column_text(selectStmt, 0)) &&
+				satellite.tleLine2 == reinterpret_cast<const char*>(sqlite3_column_text(selectStmt, 1)) &&
+				satellite.name == reinterpret_cast<const char*>(sqlite3_column_text(selectStmt, 2));
+		}
+		sqlite3_reset(selectStmt);
+
+		if (!unchanged) {
+			sqlite3_bind_text(upsertStmt, 1, satellite.name.c_str(), -1, SQLITE_STATIC);
+			sqlite3_bind_int(upsertStmt, 2, satellite.noradId);
+			sqlite3_bind_text(upsertStmt, 3, satellite.tleLine1.c_str(), -1, SQLITE_STATIC);
+			sqlite3_bind_text(upsertStmt, 4, satellite.tleLine2.c_str(), -1, SQLITE_STATIC);
+			sqlite3_bind_text(upsertStmt, 5, satellite.epoch.c_str(), -1, SQLITE_STATIC);
+
+			int rc = sqlite3_step(upsertStmt);
+			sqlite3_reset(upsertStmt);
+			if (rc != SQLITE_DONE) {
+				std::cerr << "Failed to store satellite " << satellite.noradId << ": "
+					<< sqlite3_errmsg(db) << std::endl;
+				ok = false;
+				break;
+			}
+			changed++;
+			if (changedFlags)
+				(*changedFlags)[i] = 1;
+		}
+
+		if (groupStmt) {
+			sqlite3_bind_int(groupStmt, 1, satellite.noradId);
+			sqlite3_bind_text(groupStmt, 2, group.c_str(), -1, SQLITE_STATIC);
+			int rc = sqlite3_step(groupStmt);
+			sqlite3_reset(groupStmt);
+			if (rc != SQLITE_DONE) {
+				std::cerr << "Failed to add satellite " << satellite.noradId << " to group "
+					<< group << ": " << sqlite3_errmsg(db) << std::endl;
+				ok = false;
+				break;
+			}
+		}
+	}
+
+	sqlite3_finalize(selectStmt);
+	sqlite3_finalize(upsertStmt);
+	sqlite3_finalize(groupStmt);
+
+	if (!ok) {
+		if (ownTransaction)
+			rollbackTransaction();
+		return -1;
+	}
+	if (!ownTransaction)
+		return changed;
+	return commitTransaction() ? changed : -1;
+}
+
 std::optional<SatelliteTle> Database::getSatelliteByNoradId(int noradId)
 {
 	const char* sql = R"(SELECT id, name, norad_id, tle_line1, tle_line2, epoch
@@ -300,6 +399,27 @@ std::vector<std::string> Database::getSatelliteGroups(int noradId)
 	return groups;
 }
 
+std::vector<std::pair<int, std::string>> Database::getAllGroupMemberships()
+{
+	std::vector<std::pair<int, std::string>> memberships;
+	const char* sql = "SELECT norad_id, group_name FROM satellite_groups";
+
+	sqlite3_stmt* stmt;
+	int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
+	if (rc != SQLITE_OK) {
+		std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << std::endl;
+		return memberships;
+	}
+
+	while (sqlite3_step(stmt) == SQLITE_ROW) {
+		memberships.emplace_back(sqlite3_column_int(stmt, 0),
+			reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)));
+	}
+
+	sqlite3_finalize(stmt);
+	return memberships;
+}
+
 bool Database::open()
 {
 	if (db)
@@ -311,7 +431,7 @@ bool Database::open()
 		return false;
 	}
 
-	//  foreign keys   
+	// Включаем foreign keys и улучшаем производительность
 	executeSQL("PRAGMA foreign_keys = ON;");
 	executeSQL("PRAGMA journal_mode = WAL;");
 	executeSQL("PRAGMA synchronous = NORMAL;");
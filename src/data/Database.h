@@ -4,6 +4,8 @@
 #include <string>
 #include <vector>
 #include <optional>
+#include <utility>
+#include <cstdint>
 
 struct SatelliteTle {
 	int id;
@@ -27,6 +29,15 @@ public:
 	bool updateSatellite(const SatelliteTle& satellite);
 	bool deleteSatellite(int noradId);
 
+	// Пакетная запись в одной транзакции: неизменённые TLE пропускаются.
+	// Если транзакция уже открыта вызывающим, пакет пишется в неё, а фиксация
+	// и откат (в том числе после ошибки) остаются за вызывающим.
+	// Если задана группа, все записи пакета добавляются в неё.
+	// Возвращает число добавленных/обновлённых записей, -1 при ошибке.
+	// changed (если задан) получает флаг на запись: 1 - запись добавлена или обновлена
+	int storeSatellites(const std::vector<SatelliteTle>& satellites, const std::string& group = "",
+		std::vector<uint8_t>* changed = nullptr);
+
 	std::optional<SatelliteTle> getSatelliteByNoradId(int noradId);
 	std::vector<SatelliteTle> getAllSatellites();
 	std::vector<SatelliteTle> getSatellitesByGroups(const std::string& group);
@@ -37,6 +48,12 @@ public:
 	bool addSatelliteToGroup(int noradId, const std::string& group);
 	bool removeSatelliteFromGroup(int noradId, const std::string& group);
 	std::vector<std::string> getSatelliteGroups(int noradId);
+	// Все пары (NORAD ID, группа) одним запросом
+	std::vector<std::pair<int, std::string>> getAllGroupMemberships();
+
+	bool beginTransaction();
+	bool commitTransaction();
+	bool rollbackTransaction();
 
 protected:
 	bool open();
@@ -44,9 +61,6 @@ protected:
 
 private:
 	bool executeSQL(const std::string& sql);
-	bool beginTransaction();
-	bool commitTransaction();
-	bool rollbackTransaction();
 
 	std::string dbPath;
 	sqlite3* db = nullptr;
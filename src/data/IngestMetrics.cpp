@@ -0,0 +1,113 @@
+#include "IngestMetrics.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+
+void IngestMetrics::record(const IngestPipeline::Result& result, bool success)
+{
+	last.bytesDownloaded = result.bytes;
+	last.recordsParsed = result.parsed;
+	last.recordsRejected = result.rejected;
+	last.recordsChanged = result.changed;
+	last.downloadSeconds = result.downloadTime.count();
+	last.parseSeconds = result.parseTime.count();
+	last.storeSeconds = result.storeTime.count();
+	last.totalSeconds = result.totalTime.count();
+
+	total.bytesDownloaded += last.bytesDownloaded;
+	total.recordsParsed += last.recordsParsed;
+	total.recordsRejected += last.recordsRejected;
+	total.recordsChanged += last.recordsChanged;
+	total.downloadSeconds += last.downloadSeconds;
+	total.parseSeconds += last.parseSeconds;
+	total.storeSeconds += last.storeSeconds;
+	total.totalSeconds += last.totalSeconds;
+
+	refreshAttempts++;
+	if (success) {
+		refreshSuccesses++;
+		lastSuccessTime = std::chrono::system_clock::now();
+	}
+	else {
+		refreshFailures++;
+	}
+}
+
+double IngestMetrics::successRate() const
+{
+	if (refreshAttempts == 0)
+		return 0.0;
+	return static_cast<double>(refreshSuccesses) / static_cast<double>(refreshAttempts);
+}
+
+std::string IngestMetrics::toPrometheus() const
+{
+	std::ostringstream out;
+
+	auto metric = [&out](const char* name, const char* type, const char* help, auto value) {
+		out << "# HELP satellite_tracker_" << name << " " << help << "\n"
+			<< "# TYPE satellite_tracker_" << name << " " << type << "\n"
+			<< "satellite_tracker_" << name << " " << value << "\n";
+	};
+
+	metric("ingest_bytes_total", "counter", "Bytes of TLE data downloaded.", total.bytesDownloaded);
+	metric("ingest_records_parsed_total", "counter", "TLE records parsed.", total.recordsParsed);
+	metric("ingest_records_rejected_total", "counter", "TLE blocks rejected by the parser.", total.recordsRejected);
+	metric("ingest_records_changed_total", "counter", "Records inserted or updated in the database.", total.recordsChanged);
+	metric("ingest_download_seconds_total", "counter", "Time spent downloading.", total.downloadSeconds);
+	metric("ingest_parse_seconds_total", "counter", "Time spent parsing.", total.parseSeconds);
+	metric("ingest_store_seconds_total", "counter", "Time spent writing to the database.", total.storeSeconds);
+	metric("ingest_refresh_seconds_total", "counter", "Wall time of all refreshes.", total.totalSeconds);
+
+	metric("ingest_last_bytes", "gauge", "Bytes downloaded by the last refresh.", last.bytesDownloaded);
+	metric("ingest_last_records_parsed", "gauge", "Records parsed by the last refresh.", last.recordsParsed);
+	metric("ingest_last_records_rejected", "gauge", "Blocks rejected by the last refresh.", last.recordsRejected);
+	metric("ingest_last_records_changed", "gauge", "Records changed by the last refresh.", last.recordsChanged);
+	metric("ingest_last_download_seconds", "gauge", "Download stage duration of the last refresh.", last.downloadSeconds);
+	metric("ingest_last_parse_seconds", "gauge", "Parse stage duration of the last refresh.", last.parseSeconds);
+	metric("ingest_last_store_seconds", "gauge", "Store stage duration of the last refresh.", last.storeSeconds);
+	metric("ingest_last_refresh_seconds", "gauge", "Wall time of the last refresh.", last.totalSeconds);
+
+	metric("refresh_attempts_total", "counter", "Refresh attempts.", refreshAttempts);
+	metric("refresh_successes_total", "counter", "Successful refreshes.", refreshSuccesses);
+	metric("refresh_failures_total", "counter", "Failed refreshes.", refreshFailures);
+	metric("refresh_success_ratio", "gauge", "Share of successful refreshes.", successRate());
+
+	auto lastSuccess = std::chrono::duration_cast<std::chrono::seconds>(
+		lastSuccessTime.time_since_epoch()).count();
+	metric("last_success_timestamp_seconds", "gauge", "Unix time of the last successful refresh.",
+		static_cast<long long>(lastSuccess));
+
+	return out.str();
+}
+
+bool IngestMetrics::writePrometheusFile(const std::string& path) const
+{
+	// Пишем во временный файл и переименовываем, чтобы сборщик
+	// никогда не прочитал файл наполовину
+	std::string tmpPath = path + ".tmp";
+	{
+		std::ofstream file(tmpPath, std::ios::trunc);
+		if (!file.is_open()) {
+			std::cerr << "Failed to open metrics file: " << tmpPath << std::endl;
+			return false;
+		}
+		file << toPrometheus();
+		if (!file) {
+			std::cerr << "Failed to write metrics file: " << tmpPath << std::endl;
+			return false;
+		}
+	}
+
+	// Замена за один шаг: rename(2) в POSIX, MoveFileEx с заменой в Windows.
+	// Между удалением и std::rename сборщик не нашёл бы файла вовсе
+	std::error_code ec;
+	std::filesystem::rename(tmpPath, path, ec);
+	if (ec) {
+		std::cerr << "Failed to replace metrics file: " << path << " (" << ec.message() << ")" << std::endl;
+		return false;
+	}
+	return true;
+}
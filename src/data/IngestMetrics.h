@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <chrono>
+#include <cstdint>
+
+#include "IngestPipeline.h"
+
+// Показатели загрузки каталога: последнее обновление и накопленные счётчики
+struct IngestMetrics {
+	struct Refresh {
+		uint64_t bytesDownloaded = 0;
+		uint64_t recordsParsed = 0;
+		uint64_t recordsRejected = 0;
+		uint64_t recordsChanged = 0;
+		double downloadSeconds = 0.0;
+		double parseSeconds = 0.0;
+		double storeSeconds = 0.0;
+		double totalSeconds = 0.0;
+	};
+
+	Refresh last;		// последнее обновление
+	Refresh total;		// сумма по всем обновлениям
+
+	uint64_t refreshAttempts = 0;
+	uint64_t refreshSuccesses = 0;
+	uint64_t refreshFailures = 0;
+	std::chrono::system_clock::time_point lastSuccessTime{};
+
+	void record(const IngestPipeline::Result& result, bool success);
+	double successRate() const;
+
+	// Текстовый формат Prometheus (для node_exporter textfile collector)
+	std::string toPrometheus() const;
+	bool writePrometheusFile(const std::string& path) const;
+};
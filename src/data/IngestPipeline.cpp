@@ -0,0 +1,169 @@
+#include "IngestPipeline.h"
+
+#include <iostream>
+#include <thread>
+
+namespace {
+
+	// Останавливает стадии и дожидается их потоков при любом выходе из run(),
+	// в том числе по исключению: оставшийся joinable std::thread в деструкторе
+	// вызывает std::terminate, а стадия, упёршаяся в полную очередь, без
+	// закрытия очередей не завершится
+	class StageJoiner
+	{
+	public:
+		StageJoiner(BoundedQueue<std::string>& chunks, BoundedQueue<std::vector<SatelliteTle>>& batches) :
+			chunks(chunks), batches(batches)
+		{
+		}
+		StageJoiner(const StageJoiner&) = delete;
+		~StageJoiner() { join(); }
+
+		void add(std::thread thread) { threads.push_back(std::move(thread)); }
+
+		void join()
+		{
+			chunks.close();
+			batches.close();
+			for (std::thread& thread : threads) {
+				if (thread.joinable())
+					thread.join();
+			}
+		}
+
+	private:
+		BoundedQueue<std::string>& chunks;
+		BoundedQueue<std::vector<SatelliteTle>>& batches;
+		std::vector<std::thread> threads;
+	};
+
+}
+
+IngestPipeline::IngestPipeline(TleSource& source, TleParser& parser, Database& database) :
+	IngestPipeline(source, parser, database, Settings())
+{
+}
+
+IngestPipeline::IngestPipeline(TleSource& source, TleParser& parser, Database& database,
+	Settings settings) :
+	source(source), parser(parser), database(database), settings(settings)
+{
+}
+
+IngestPipeline::Result IngestPipeline::run()
+{
+	using Clock = std::chrono::steady_clock;
+	Result result;
+	auto startTime = Clock::now();
+
+	BoundedQueue<std::string> chunks(settings.chunkQueueSize);
+	BoundedQueue<std::vector<SatelliteTle>> batches(settings.batchQueueSize);
+
+	// Каждая стадия пишет только свои поля result
+	StageJoiner stages(chunks, batches);
+	stages.add(std::thread(&IngestPipeline::downloadStage, this,
+		std::ref(chunks), std::ref(result)));
+	stages.add(std::thread(&IngestPipeline::parseStage, this,
+		std::ref(chunks), std::ref(batches), std::ref(result)));
+
+	// Запись идёт в вызывающем потоке: соединение SQLite принадлежит ему.
+	// Пакеты ждут фиксации, чтобы наблюдатель не увидел откатываемые записи
+	result.stored = database.beginTransaction();
+	if (!result.stored) {
+		std::cerr << "Failed to begin ingest transaction" << std::endl;
+		batches.close();
+		chunks.close();
+	}
+	std::vector<std::pair<std::vector<SatelliteTle>, std::vector<uint8_t>>> written;
+	std::vector<SatelliteTle> batch;
+	std::vector<uint8_t> changedFlags;
+	while (result.stored && batches.pop(batch)) {
+		auto storeStart = Clock::now();
+		int changed = database.storeSatellites(batch, settings.group, &changedFlags);
+		result.storeTime += Clock::now() - storeStart;
+		if (changed < 0) {
+			std::cerr << "Failed to store batch of " << batch.size() << " satellites" << std::endl;
+			result.stored = false;
+			// Останавливаем предыдущие стадии
+			batches.close();
+			chunks.close();
+			break;
+		}
+		result.changed += static_cast<size_t>(changed);
+		if (batchObserver)
+			written.emplace_back(std::move(batch), std::move(changedFlags));
+	}
+
+	stages.join();
+
+	// Загрузка могла оборваться уже после последнего пакета - решение
+	// о фиксации принимается, когда все стадии завершены
+	bool commit = result.stored && result.fetched;
+	if (commit && !database.commitTransaction()) {
+		std::cerr << "Failed to commit ingest transaction" << std::endl;
+		result.stored = false;
+		commit = false;
+	}
+	if (!commit) {
+		database.rollbackTransaction();
+		if (result.changed > 0)
+			std::cerr << "Ingest rolled back, " << result.changed << " changed records discarded" << std::endl;
+		result.changed = 0;
+		written.clear();
+	}
+	for (const auto& [records, flags] : written)
+		batchObserver(records, flags);
+
+	result.totalTime = Clock::now() - startTime;
+
+	std::cout << "Ingest: " << result.bytes << " bytes, parsed " << result.parsed
+		<< ", rejected " << result.rejected << ", changed " << result.changed
+		<< " in " << result.totalTime.count() << " s" << std::endl;
+	return result;
+}
+
+void IngestPipeline::downloadStage(BoundedQueue<std::string>& chunks, Result& result)
+{
+	auto startTime = std::chrono::steady_clock::now();
+	result.fetched = source.fetchChunks([&](const char* data, size_t size) {
+		result.bytes += size;
+		return chunks.push(std::string(data, size));
+	});
+	result.downloadTime = std::chrono::steady_clock::now() - startTime;
+	chunks.close();
+}
+
+void IngestPipeline::parseStage(BoundedQueue<std::string>& chunks,
+	BoundedQueue<std::vector<SatelliteTle>>& batches, Result& result)
+{
+	using Clock = std::chrono::steady_clock;
+
+	std::vector<SatelliteTle> batch;
+	batch.reserve(settings.batchSize);
+
+	auto flush = [&]() {
+		if (batch.empty())
+			return true;
+		bool pushed = batches.push(std::move(batch));
+		batch = std::vector<SatelliteTle>();
+		batch.reserve(settings.batchSize);
+		return pushed;
+	};
+
+	parser.beginStream();
+	std::string chunk;
+	while (chunks.pop(chunk)) {
+		auto parseStart = Clock::now();
+		result.parsed += parser.feed(chunk.data(), chunk.size(), batch);
+		result.parseTime += Clock::now() - parseStart;
+		if (batch.size() >= settings.batchSize && !flush()) {
+			chunks.close();
+			break;
+		}
+	}
+	result.parsed += parser.endStream(batch);
+	result.rejected = parser.rejectedInStream();
+	flush();
+
+	batches.close();
+}
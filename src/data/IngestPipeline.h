@@ -0,0 +1,68 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <chrono>
+#include <functional>
+
+#include "BoundedQueue.h"
+#include "Database.h"
+#include "TleParser.h"
+#include "TleSource.h"
+
+// Конвейер обновления каталога из трёх стадий:
+// загрузка (поток) -> разбор (поток) -> запись в БД (вызывающий поток).
+// Стадии связаны ограниченными очередями, поэтому сеть, разбор и диск
+// работают одновременно, а время обновления близко к самой медленной стадии.
+// Все пакеты пишутся в одну транзакцию, и она фиксируется, только если
+// источник отдал данные полностью: оборванная загрузка откатывается целиком
+// и не оставляет в БД и каталоге половину обновления
+class IngestPipeline
+{
+public:
+	struct Settings {
+		size_t chunkQueueSize = 64;		// куски сырых данных между загрузкой и разбором
+		size_t batchQueueSize = 8;		// пакеты записей между разбором и записью
+		size_t batchSize = 2000;		// записей в пакете записи
+		std::string group;				// группа, в которую попадают все записи
+	};
+
+	// Вызывается в потоке записи для каждого пакета после фиксации транзакции
+	// (при откате - ни разу); changed[i] != 0 - запись batch[i] добавлена
+	// или обновлена в БД
+	using BatchObserver = std::function<void(const std::vector<SatelliteTle>& batch,
+		const std::vector<uint8_t>& changed)>;
+
+	struct Result {
+		bool fetched = false;	// источник отдал данные полностью
+		bool stored = false;	// все пакеты записаны и транзакция зафиксирована
+		size_t bytes = 0;
+		size_t parsed = 0;
+		size_t rejected = 0;
+		size_t changed = 0;		// 0 после отката
+
+		// Стадии перекрываются, поэтому их сумма больше total
+		std::chrono::duration<double> downloadTime{ 0 };	// от начала до последнего куска
+		std::chrono::duration<double> parseTime{ 0 };		// чистое время разбора
+		std::chrono::duration<double> storeTime{ 0 };		// чистое время записи
+		std::chrono::duration<double> totalTime{ 0 };
+	};
+
+	IngestPipeline(TleSource& source, TleParser& parser, Database& database);
+	IngestPipeline(TleSource& source, TleParser& parser, Database& database, Settings settings);
+
+	Result run();
+	void setBatchObserver(BatchObserver observer) { batchObserver = std::move(observer); }
+
+private:
+	void downloadStage(BoundedQueue<std::string>& chunks, Result& result);
+	void parseStage(BoundedQueue<std::string>& chunks,
+		BoundedQueue<std::vector<SatelliteTle>>& batches, Result& result);
+
+	TleSource& source;
+	TleParser& parser;
+	Database& database;
+	Settings settings;
+	BatchObserver batchObserver;
+};
@@ -0,0 +1,208 @@
+#include "RefreshScheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "../time/JulianDate.h"
+
+RefreshScheduler::OrbitRegime RefreshScheduler::classify(const SatelliteTle& satellite)
+{
+	TleElements elements;
+	if (!TleParser::decodeElements(satellite.tleLine1, satellite.tleLine2, elements))
+		return OrbitRegime::LeoHighDrag; // неразобранные TLE считаем самыми срочными
+
+	double meanMotion = elements.meanMotion; // оборотов в сутки
+	double eccentricity = elements.eccentricity;
+	double bstar = std::fabs(elements.bstar);
+
+	if (eccentricity > 0.25)
+		return OrbitRegime::Heo;
+	if (meanMotion >= 11.25) {
+		// Перигей ниже ~350 км или большой баллистический коэффициент
+		if (meanMotion >= 15.5 || bstar > 5e-4)
+			return OrbitRegime::LeoHighDrag;
+		return OrbitRegime::Leo;
+	}
+	if (meanMotion > 0.9 && meanMotion < 1.1)
+		return OrbitRegime::Geo;
+	return OrbitRegime::Meo;
+}
+
+std::chrono::hours RefreshScheduler::maxAge(OrbitRegime regime)
+{
+	// Возраст, при котором ошибка SGP4 обычно достигает единиц километров
+	switch (regime) {
+	case OrbitRegime::LeoHighDrag:	return std::chrono::hours(12);
+	case OrbitRegime::Leo:			return std::chrono::hours(36);
+	case OrbitRegime::Heo:			return std::chrono::hours(48);
+	case OrbitRegime::Meo:			return std::chrono::hours(96);
+	case OrbitRegime::Geo:			return std::chrono::hours(168);
+	}
+	return std::chrono::hours(24);
+}
+
+std::optional<RefreshScheduler::Clock::time_point> RefreshScheduler::decodeEpoch(const std::string& epoch)
+{
+	JulianDate jd;
+	if (!JulianDate::fromTleEpoch(epoch.data(), epoch.size(), jd))
+		return std::nullopt;
+	return jd.toSystemTime();
+}
+
+void RefreshScheduler::addGroup(const std::string& group, RefreshPolicy policy)
+{
+	groups[group].policy = policy;
+}
+
+void RefreshScheduler::observe(const std::string& group, const std::vector<SatelliteTle>& satellites)
+{
+	auto it = groups.find(group);
+	if (it == groups.end())
+		return;
+	GroupState& state = it->second;
+	Clock::time_point now = Clock::now();
+
+	for (const auto& satellite : satellites) {
+		auto epoch = decodeEpoch(satellite.epoch);
+		if (!epoch)
+			continue;
+
+		std::chrono::hours age = maxAge(classify(satellite));
+		Clock::time_point deadline = *epoch + age;
+		// Устаревшие уже в источнике объекты (сошедшие с орбиты, редко
+		// обновляемые) не должны заставлять обновлять группу постоянно
+		if (deadline < now) {
+			state.pendingStale = true;
+			continue;
+		}
+		if (!state.pendingDeadline || deadline < *state.pendingDeadline) {
+			state.pendingDeadline = deadline;
+			state.pendingMaxAge = age;
+		}
+	}
+}
+
+void RefreshScheduler::beginRefresh(const std::string& group)
+{
+	auto it = groups.find(group);
+	if (it == groups.end())
+		return;
+	it->second.pendingDeadline.reset();
+	it->second.pendingStale = false;
+}
+
+void RefreshScheduler::markRefreshed(const std::string& group, Clock::time_point now, bool success)
+{
+	auto it = groups.find(group);
+	if (it == groups.end())
+		return;
+	GroupState& state = it->second;
+
+	state.lastAttempt = now;
+	if (!success) {
+		state.failures++;
+		return;
+	}
+
+	state.failures = 0;
+	state.lastRefresh = now;
+	// Срок назначается всегда: иначе остаётся срок прошлого обновления, уже
+	// прошедший, и группа становится обязательной сразу после minInterval
+	if (state.pendingDeadline) {
+		state.deadline = state.pendingDeadline;
+		state.deadlineMaxAge = state.pendingMaxAge;
+	} else {
+		// Ни одного свежего объекта (пустой ответ, все устарели в источнике)
+		state.deadline = now + state.policy.maxInterval;
+		state.deadlineMaxAge = std::chrono::duration_cast<std::chrono::hours>(state.policy.maxInterval);
+	}
+}
+
+void RefreshScheduler::markLoadedFromDatabase(const std::string& group, Clock::time_point now)
+{
+	auto it = groups.find(group);
+	if (it == groups.end())
+		return;
+	GroupState& state = it->second;
+	if (!state.pendingDeadline && !state.pendingStale)
+		return; // группы нет в БД
+
+	// Разрешаем обновить сразу, но обязательным оно станет только по сроку
+	state.lastRefresh = now - state.policy.minInterval;
+	state.deadline = state.pendingStale ? now : *state.pendingDeadline;
+	state.deadlineMaxAge = state.pendingStale ? std::chrono::hours(1) : state.pendingMaxAge;
+}
+
+bool RefreshScheduler::isDue(const GroupState& state, Clock::time_point now) const
+{
+	return now >= nextDue(state);
+}
+
+RefreshScheduler::Clock::time_point RefreshScheduler::nextDue(const GroupState& state) const
+{
+	Clock::time_point due = Clock::time_point::min();
+
+	if (state.lastRefresh) {
+		Clock::time_point earliest = *state.lastRefresh + state.policy.minInterval;
+		Clock::time_point latest = *state.lastRefresh + state.policy.maxInterval;
+		due = latest;
+		if (state.deadline)
+			due = std::min(latest, std::max(earliest, *state.deadline));
+	}
+
+	// После неудачи повторяем с экспоненциальной задержкой
+	if (state.failures > 0 && state.lastAttempt) {
+		auto backoff = state.policy.minInterval * (1 << std::min(state.failures - 1, 10));
+		backoff = std::min(backoff, state.policy.maxInterval);
+		due = std::max(due, *state.lastAttempt + backoff);
+	}
+
+	return due;
+}
+
+std::vector<std::string> RefreshScheduler::dueGroups(Clock::time_point now) const
+{
+	std::vector<std::string> due;
+	for (const auto& [name, state] : groups) {
+		if (isDue(state, now))
+			due.push_back(name);
+	}
+
+	std::sort(due.begin(), due.end(), [&](const std::string& a, const std::string& b) {
+		return staleness(a, now) > staleness(b, now);
+	});
+	return due;
+}
+
+RefreshScheduler::Clock::time_point RefreshScheduler::nextDue(const std::string& group) const
+{
+	auto it = groups.find(group);
+	if (it == groups.end())
+		return Clock::time_point::max();
+	return nextDue(it->second);
+}
+
+RefreshScheduler::Clock::time_point RefreshScheduler::nextDue() const
+{
+	Clock::time_point earliest = Clock::time_point::max();
+	for (const auto& [name, state] : groups)
+		earliest = std::min(earliest, nextDue(state));
+	return earliest;
+}
+
+double RefreshScheduler::staleness(const std::string& group, Clock::time_point now) const
+{
+	auto it = groups.find(group);
+	if (it == groups.end())
+		return 0.0;
+	const GroupState& state = it->second;
+
+	// О группе ещё ничего не известно - обновляем первой
+	if (!state.lastRefresh)
+		return 1e9;
+	if (!state.deadline || state.deadlineMaxAge.count() == 0)
+		return 0.0;
+
+	std::chrono::duration<double, std::ratio<3600>> overdue = now - *state.deadline;
+	return 1.0 + overdue.count() / static_cast<double>(state.deadlineMaxAge.count());
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <optional>
+#include <unordered_map>
+
+#include "Database.h"
+#include "TleParser.h"
+
+// Границы интервала обновления группы
+struct RefreshPolicy {
+	std::chrono::minutes minInterval{ 30 };			// не чаще
+	std::chrono::minutes maxInterval{ 24 * 60 };	// не реже
+};
+
+// Планировщик обновлений по устареванию TLE.
+// Для каждого объекта допустимый возраст элементов зависит от орбиты:
+// низкие орбиты с сильным торможением устаревают за часы, геостационар - за дни.
+// Группа обновляется, когда устарел хотя бы один её объект
+class RefreshScheduler
+{
+public:
+	using Clock = std::chrono::system_clock;
+
+	enum class OrbitRegime {
+		LeoHighDrag, Leo, Meo, Heo, Geo
+	};
+
+	static OrbitRegime classify(const SatelliteTle& satellite);
+	static std::chrono::hours maxAge(OrbitRegime regime);
+	// Эпоха TLE в формате YYDDD.DDDDDDDD
+	static std::optional<Clock::time_point> decodeEpoch(const std::string& epoch);
+
+	void addGroup(const std::string& group, RefreshPolicy policy);
+	bool hasGroups() const { return !groups.empty(); }
+
+	// Учитывает записи группы, полученные при обновлении или прочитанные из БД
+	void observe(const std::string& group, const std::vector<SatelliteTle>& satellites);
+	void beginRefresh(const std::string& group);
+	void markRefreshed(const std::string& group, Clock::time_point now, bool success);
+	// Данные из БД: обновление нужно, только если они уже устарели
+	void markLoadedFromDatabase(const std::string& group, Clock::time_point now);
+
+	// Группы, которым пора обновиться, от самой устаревшей
+	std::vector<std::string> dueGroups(Clock::time_point now) const;
+	Clock::time_point nextDue(const std::string& group) const;
+	Clock::time_point nextDue() const;
+	// >= 1 - в группе есть объекты старше допустимого возраста
+	double staleness(const std::string& group, Clock::time_point now) const;
+
+private:
+	struct GroupState {
+		RefreshPolicy policy;
+		std::optional<Clock::time_point> lastRefresh;
+		std::optional<Clock::time_point> lastAttempt;
+		int failures = 0;
+
+		// Момент, когда первый объект группы выйдет за допустимый возраст,
+		// и этот допустимый возраст (для нормировки приоритета)
+		std::optional<Clock::time_point> deadline;
+		std::chrono::hours deadlineMaxAge{ 0 };
+
+		// Накопление во время текущего обновления
+		std::optional<Clock::time_point> pendingDeadline;
+		std::chrono::hours pendingMaxAge{ 0 };
+		bool pendingStale = false;
+	};
+
+	bool isDue(const GroupState& state, Clock::time_point now) const;
+	Clock::time_point nextDue(const GroupState& state) const;
+
+	std::unordered_map<std::string, GroupState> groups;
+};
@@ -0,0 +1,362 @@
+#include "SatelliteCatalog.h"
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <type_traits>
+
+namespace {
+
+	const char snapshotMagic[8] = { 'S', 'T', 'C', 'A', 'T', '0', '0', '2' };
+
+	template <typename T>
+	void writeValue(std::ofstream& file, const T& value)
+	{
+		file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	template <typename T>
+	bool readValue(std::ifstream& file, T& value)
+	{
+		return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+	}
+
+	template <typename Vector>
+	void writeColumn(std::ofstream& file, const Vector& column)
+	{
+		file.write(reinterpret_cast<const char*>(column.data()),
+			column.size() * sizeof(typename Vector::value_type));
+	}
+
+	template <typename Vector>
+	bool readColumn(std::ifstream& file, Vector& column, size_t count)
+	{
+		column.resize(count);
+		return static_cast<bool>(file.read(reinterpret_cast<char*>(column.data()),
+			count * sizeof(typename Vector::value_type)));
+	}
+
+	// Перечисление всех колонок для сериализации и изменения размера
+	template <typename Columns, typename Func>
+	void forEachColumn(Columns& cols, Func&& func)
+	{
+		func(cols.noradId);
+		func(cols.epochDay);
+		func(cols.epochFraction);
+		func(cols.ndot);
+		func(cols.nddot);
+		func(cols.bstar);
+		func(cols.inclination);
+		func(cols.raan);
+		func(cols.eccentricity);
+		func(cols.argPerigee);
+		func(cols.meanAnomaly);
+		func(cols.meanMotion);
+		func(cols.groupMask);
+		func(cols.nameOffset);
+		func(cols.nameLength);
+		func(cols.revision);
+		func(cols.alive);
+	}
+
+}
+
+bool SatelliteCatalog::loadFromDatabase(Database& database)
+{
+	if (!database.isOpen())
+		return false;
+
+	clear();
+
+	for (const auto& satellite : database.getAllSatellites()) {
+		if (upsert(satellite) == invalidSlot)
+			std::cerr << "Skipping satellite with invalid TLE: " << satellite.noradId << std::endl;
+	}
+
+	for (const auto& [noradId, group] : database.getAllGroupMemberships()) {
+		Slot slot = findSlot(noradId);
+		if (slot != invalidSlot)
+			addToGroup(slot, group);
+	}
+
+	std::cout << "Catalog loaded: " << aliveCount << " satellites, "
+		<< groups.size() << " groups" << std::endl;
+	return true;
+}
+
+bool SatelliteCatalog::saveSnapshot(const std::string& path) const
+{
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		std::cerr << "Failed to open catalog snapshot: " << path << std::endl;
+		return false;
+	}
+
+	file.write(snapshotMagic, sizeof(snapshotMagic));
+	writeValue(file, static_cast<uint64_t>(slotCount()));
+	writeValue(file, static_cast<uint64_t>(nameArena.size()));
+	writeValue(file, static_cast<uint32_t>(groups.size()));
+	for (const auto& group : groups) {
+		writeValue(file, static_cast<uint32_t>(group.size()));
+		file.write(group.data(), group.size());
+	}
+
+	forEachColumn(cols, [&file](const auto& column) { writeColumn(file, column); });
+	file.write(nameArena.data(), nameArena.size());
+
+	if (!file) {
+		std::cerr << "Failed to write catalog snapshot: " << path << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool SatelliteCatalog::loadSnapshot(const std::string& path)
+{
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file.is_open()) {
+		std::cerr << "Failed to open catalog snapshot: " << path << std::endl;
+		return false;
+	}
+	std::streamoff fileSize = file.tellg();
+	file.seekg(0);
+
+	// Счётчики из файла не должны обещать больше данных, чем в нём осталось:
+	// иначе повреждённый снимок заставил бы выделить гигабайты
+	auto remaining = [&file, fileSize]() -> uint64_t {
+		std::streamoff position = file.tellg();
+		return position < 0 || position > fileSize ? 0 : static_cast<uint64_t>(fileSize - position);
+	};
+
+	char magic[sizeof(snapshotMagic)];
+	uint64_t count = 0, arenaSize = 0;
+	uint32_t groupCount = 0;
+	if (fileSize < 0 ||
+		!file.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), snapshotMagic) ||
+		!readValue(file, count) || !readValue(file, arenaSize) || !readValue(file, groupCount) ||
+		groupCount > maxGroups || count >= invalidSlot || arenaSize > remaining()) {
+		std::cerr << "Invalid catalog snapshot: " << path << std::endl;
+		return false;
+	}
+
+	clear();
+
+	for (uint32_t i = 0; i < groupCount; i++) {
+		uint32_t length = 0;
+		if (!readValue(file, length) || length > remaining()) {
+			std::cerr << "Invalid catalog snapshot: " << path << std::endl;
+			clear();
+			return false;
+		}
+		std::string group(length, '\0');
+		if (!file.read(group.data(), length)) {
+			std::cerr << "Truncated catalog snapshot: " << path << std::endl;
+			clear();
+			return false;
+		}
+		groups.push_back(std::move(group));
+	}
+
+	uint64_t rowSize = 0;
+	forEachColumn(cols, [&rowSize](const auto& column) {
+		rowSize += sizeof(typename std::decay_t<decltype(column)>::value_type);
+	});
+	if (count > remaining() / rowSize || count * rowSize + arenaSize > remaining()) {
+		std::cerr << "Truncated catalog snapshot: " << path << std::endl;
+		clear();
+		return false;
+	}
+
+	bool ok = true;
+	forEachColumn(cols, [&](auto& column) { ok = ok && readColumn(file, column, count); });
+	nameArena.resize(arenaSize);
+	ok = ok && file.read(nameArena.data(), arenaSize);
+
+	if (!ok) {
+		std::cerr << "Truncated catalog snapshot: " << path << std::endl;
+		clear();
+		return false;
+	}
+
+	// name() читает арену без проверок
+	for (Slot slot = 0; slot < count; slot++) {
+		if (uint64_t(cols.nameOffset[slot]) + cols.nameLength[slot] > nameArena.size()) {
+			std::cerr << "Invalid catalog snapshot: " << path << " (name of slot " << slot
+				<< " outside the name arena)" << std::endl;
+			clear();
+			return false;
+		}
+	}
+
+	// Индексы восстанавливаются по флагам занятости
+	for (Slot slot = 0; slot < count; slot++) {
+		if (cols.alive[slot]) {
+			slotByNorad[cols.noradId[slot]] = slot;
+			aliveCount++;
+		}
+		else {
+			freeSlots.push_back(slot);
+		}
+	}
+	catalogVersion++;
+	return true;
+}
+
+void SatelliteCatalog::clear()
+{
+	forEachColumn(cols, [](auto& column) { column.clear(); });
+	nameArena.clear();
+	slotByNorad.clear();
+	freeSlots.clear();
+	groups.clear();
+	aliveCount = 0;
+	catalogVersion++;
+}
+
+SatelliteCatalog::Slot SatelliteCatalog::upsert(const SatelliteTle& satellite, uint64_t groupBits)
+{
+	TleElements elements;
+	if (!TleParser::decodeElements(satellite.tleLine1, satellite.tleLine2, elements))
+		return invalidSlot;
+
+	Slot slot = findSlot(satellite.noradId);
+	if (slot == invalidSlot) {
+		slot = allocateSlot();
+		cols.noradId[slot] = satellite.noradId;
+		cols.groupMask[slot] = 0;
+		cols.alive[slot] = 1;
+		slotByNorad[satellite.noradId] = slot;
+		aliveCount++;
+		storeName(slot, satellite.name);
+	}
+	else if (name(slot) != satellite.name) {
+		storeName(slot, satellite.name);
+	}
+
+	storeElements(slot, elements);
+	cols.groupMask[slot] |= groupBits;
+	cols.revision[slot]++;
+	catalogVersion++;
+	return slot;
+}
+
+bool SatelliteCatalog::remove(int noradId)
+{
+	auto it = slotByNorad.find(noradId);
+	if (it == slotByNorad.end())
+		return false;
+
+	Slot slot = it->second;
+	slotByNorad.erase(it);
+	cols.alive[slot] = 0;
+	cols.groupMask[slot] = 0;
+	cols.revision[slot]++;
+	freeSlots.push_back(slot);
+	aliveCount--;
+	catalogVersion++;
+	return true;
+}
+
+void SatelliteCatalog::addToGroup(Slot slot, const std::string& group)
+{
+	int bit = groupBit(group);
+	if (bit < 0 || !isAlive(slot))
+		return;
+	uint64_t mask = cols.groupMask[slot] | (uint64_t(1) << bit);
+	if (mask == cols.groupMask[slot])
+		return;
+	cols.groupMask[slot] = mask;
+	catalogVersion++;
+}
+
+SatelliteCatalog::Slot SatelliteCatalog::findSlot(int noradId) const
+{
+	auto it = slotByNorad.find(noradId);
+	return it == slotByNorad.end() ? invalidSlot : it->second;
+}
+
+std::string_view SatelliteCatalog::name(Slot slot) const
+{
+	if (slot >= slotCount())
+		return {};
+	return std::string_view(nameArena.data() + cols.nameOffset[slot], cols.nameLength[slot]);
+}
+
+TleElements SatelliteCatalog::elements(Slot slot) const
+{
+	TleElements elements;
+	if (slot >= slotCount())
+		return elements;
+
+	elements.noradId = cols.noradId[slot];
+	elements.epoch = JulianDate(cols.epochDay[slot], cols.epochFraction[slot]);
+	elements.ndot = cols.ndot[slot];
+	elements.nddot = cols.nddot[slot];
+	elements.bstar = cols.bstar[slot];
+	elements.inclination = cols.inclination[slot];
+	elements.raan = cols.raan[slot];
+	elements.eccentricity = cols.eccentricity[slot];
+	elements.argPerigee = cols.argPerigee[slot];
+	elements.meanAnomaly = cols.meanAnomaly[slot];
+	elements.meanMotion = cols.meanMotion[slot];
+	return elements;
+}
+
+int SatelliteCatalog::groupBit(const std::string& group)
+{
+	auto it = std::find(groups.begin(), groups.end(), group);
+	if (it != groups.end())
+		return static_cast<int>(it - groups.begin());
+
+	if (groups.size() >= maxGroups) {
+		std::cerr << "Too many satellite groups, ignoring: " << group << std::endl;
+		return -1;
+	}
+	groups.push_back(group);
+	return static_cast<int>(groups.size() - 1);
+}
+
+uint64_t SatelliteCatalog::groupMask(const std::string& group) const
+{
+	auto it = std::find(groups.begin(), groups.end(), group);
+	if (it == groups.end())
+		return 0;
+	return uint64_t(1) << (it - groups.begin());
+}
+
+SatelliteCatalog::Slot SatelliteCatalog::allocateSlot()
+{
+	if (!freeSlots.empty()) {
+		Slot slot = freeSlots.back();
+		freeSlots.pop_back();
+		return slot;
+	}
+
+	Slot slot = static_cast<Slot>(slotCount());
+	forEachColumn(cols, [](auto& column) { column.emplace_back(); });
+	return slot;
+}
+
+void SatelliteCatalog::storeElements(Slot slot, const TleElements& elements)
+{
+	cols.epochDay[slot] = elements.epoch.day;
+	cols.epochFraction[slot] = elements.epoch.fraction;
+	cols.ndot[slot] = elements.ndot;
+	cols.nddot[slot] = elements.nddot;
+	cols.bstar[slot] = elements.bstar;
+	cols.inclination[slot] = elements.inclination;
+	cols.raan[slot] = elements.raan;
+	cols.eccentricity[slot] = elements.eccentricity;
+	cols.argPerigee[slot] = elements.argPerigee;
+	cols.meanAnomaly[slot] = elements.meanAnomaly;
+	cols.meanMotion[slot] = elements.meanMotion;
+}
+
+void SatelliteCatalog::storeName(Slot slot, const std::string& name)
+{
+	// Старое имя остаётся в арене до следующей перезагрузки каталога
+	size_t length = std::min<size_t>(name.size(), 0xFFFF);
+	cols.nameOffset[slot] = static_cast<uint32_t>(nameArena.size());
+	cols.nameLength[slot] = static_cast<uint16_t>(length);
+	nameArena.append(name, 0, length);
+}
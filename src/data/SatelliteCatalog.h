@@ -0,0 +1,86 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+#include "AlignedAllocator.h"
+#include "Database.h"
+#include "TleParser.h"
+
+// Каталог спутников в памяти в виде структуры массивов.
+// Каждый объект занимает постоянный слот: индекс не меняется при обновлении
+// TLE, а освобождённые слоты используются повторно. Распространение орбит и
+// отрисовка проходят по плотным колонкам, а не по строкам SatelliteTle
+class SatelliteCatalog
+{
+public:
+	using Slot = uint32_t;
+	static constexpr Slot invalidSlot = 0xFFFFFFFFu;
+	static constexpr int maxGroups = 64;
+
+	// Колонки каталога, индекс - номер слота
+	struct Columns {
+		AlignedVector<int32_t> noradId;
+		AlignedVector<double> epochDay;		// эпоха TLE: полночь JD
+		AlignedVector<double> epochFraction;	// и доля суток, см. JulianDate
+		AlignedVector<double> ndot;
+		AlignedVector<double> nddot;
+		AlignedVector<double> bstar;
+		AlignedVector<double> inclination;
+		AlignedVector<double> raan;
+		AlignedVector<double> eccentricity;
+		AlignedVector<double> argPerigee;
+		AlignedVector<double> meanAnomaly;
+		AlignedVector<double> meanMotion;
+		AlignedVector<uint64_t> groupMask;	// бит на группу, см. groupBit()
+		AlignedVector<uint32_t> nameOffset;	// смещение имени в nameArena
+		AlignedVector<uint16_t> nameLength;
+		AlignedVector<uint32_t> revision;	// меняется при каждом обновлении слота
+		AlignedVector<uint8_t> alive;
+	};
+
+	SatelliteCatalog() = default;
+	SatelliteCatalog(SatelliteCatalog&) = delete;
+
+	bool loadFromDatabase(Database& database);
+	bool saveSnapshot(const std::string& path) const;
+	bool loadSnapshot(const std::string& path);
+	void clear();
+
+	// Добавляет или обновляет объект; invalidSlot - TLE не разобраны
+	Slot upsert(const SatelliteTle& satellite, uint64_t groups = 0);
+	bool remove(int noradId);
+	void addToGroup(Slot slot, const std::string& group);
+
+	Slot findSlot(int noradId) const;
+	bool isAlive(Slot slot) const { return slot < slotCount() && cols.alive[slot] != 0; }
+	std::string_view name(Slot slot) const;
+	TleElements elements(Slot slot) const;
+
+	// -1 - лимит групп исчерпан
+	int groupBit(const std::string& group);
+	uint64_t groupMask(const std::string& group) const;
+	const std::vector<std::string>& groupNames() const { return groups; }
+
+	const Columns& columns() const { return cols; }
+	size_t slotCount() const { return cols.noradId.size(); }
+	size_t size() const { return aliveCount; }
+	// Растёт при любом изменении каталога
+	uint64_t version() const { return catalogVersion; }
+
+private:
+	Slot allocateSlot();
+	void storeElements(Slot slot, const TleElements& elements);
+	void storeName(Slot slot, const std::string& name);
+
+	Columns cols;
+	std::string nameArena;
+	std::unordered_map<int, Slot> slotByNorad;
+	std::vector<Slot> freeSlots;
+	std::vector<std::string> groups;
+	size_t aliveCount = 0;
+	uint64_t catalogVersion = 0;
+};
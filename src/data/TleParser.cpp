@@ -6,6 +6,41 @@
 #include <algorithm>
 #include <cctype>
 #include <regex>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+
+#include "../time/JulianDate.h"
+
+namespace {
+
+    const double DEG2RAD = M_PI / 180.0;
+
+    // Поле фиксированной ширины; false - поле пустое или не число
+    bool parseFixed(const std::string& line, size_t pos, size_t len, double& value)
+    {
+        if (line.length() < pos + len)
+            return false;
+        std::string field = line.substr(pos, len);
+        char* end = nullptr;
+        value = std::strtod(field.c_str(), &end);
+        return end != field.c_str();
+    }
+
+    // Поле с подразумеваемой точкой и порядком: " 12345-3" = 0.12345e-3
+    bool parseExponential(const std::string& line, size_t pos, double& value)
+    {
+        if (line.length() < pos + 8)
+            return false;
+        double mantissa = 0.0;
+        if (!parseFixed("0." + line.substr(pos + 1, 5), 0, 7, mantissa))
+            return false;
+        int exponent = std::atoi(line.substr(pos + 6, 2).c_str());
+        value = (line[pos] == '-' ? -mantissa : mantissa) * std::pow(10.0, exponent);
+        return true;
+    }
+
+}
 
 std::vector<SatelliteTle> TleParser::parseTleData(const std::string& data)
 {
@@ -25,35 +60,18 @@ std::vector<SatelliteTle> TleParser::parseTleData(const std::string& data)
         if (line0.empty() || line0[0] == '#')
             continue;
 
-        //      
+        // Читаем следующие две строки после названия
         if (!std::getline(stream, line1) || !std::getline(stream, line2))
             break;
 
         lineCount += 2;
 
-        line0 = cleanTleLine(line0);
-        line1 = cleanTleLine(line1);
-        line2 = cleanTleLine(line2);
-
-        //  TLE 
-        if (!validateTleBlock(line0, line1, line2)) {
+        SatelliteTle satellite;
+        if (!parseTleBlock(line0, line1, line2, satellite)) {
             std::cerr << "Invalid TLE block at line " << (lineCount - 2) << std::endl;
             continue;
         }
 
-        int noradId = extractNoradIdFromLine2(line2);
-        if (noradId == -1) {
-            std::cerr << "Failed to extract NORAD ID for: " << line0 << std::endl;
-            continue;
-        }
-
-        SatelliteTle satellite;
-        satellite.name = extractNameFromLine0(line0);
-        satellite.noradId = noradId;
-        satellite.tleLine1 = line1;
-        satellite.tleLine2 = line2;
-        satellite.epoch = extractEpochFromLine1(line1);
-
         satellites.push_back(satellite);
     }
 
@@ -70,17 +88,117 @@ std::vector<SatelliteTle> TleParser::parseTleFile(const std::string& fileName)
     }
 
     std::string content;
-    file.seekg(0, std::ios::end); //     
-    content.reserve(file.tellg()); //   tellg    (.. )
-                                   //    
-    file.seekg(0, std::ios::beg); //    
+    file.seekg(0, std::ios::end); // переводим указатель в конец файла
+    content.reserve(file.tellg()); // с помощью tellg получаем текущую позицию (т.е. размер)
+                                   // и резервируем у строки
+    file.seekg(0, std::ios::beg); // возвращем указатель в начало
     content.assign(std::istreambuf_iterator<char>(file),
-        std::istreambuf_iterator<char>());  //    
+        std::istreambuf_iterator<char>());  // заменяем данные в строке
 
     file.close();
     return parseTleData(content);
 }
 
+void TleParser::beginStream()
+{
+    pendingLine.clear();
+    blockSize = 0;
+    streamLineCount = 0;
+    streamRejected = 0;
+}
+
+size_t TleParser::feed(const char* data, size_t size, std::vector<SatelliteTle>& out)
+{
+    size_t parsed = 0;
+    const char* end = data + size;
+
+    while (data < end) {
+        const char* newline = static_cast<const char*>(std::memchr(data, '\n', end - data));
+        if (!newline) {
+            // Строка продолжится в следующем куске
+            pendingLine.append(data, end);
+            break;
+        }
+
+        pendingLine.append(data, newline);
+        if (feedLine(std::move(pendingLine), out))
+            parsed++;
+        pendingLine.clear();
+        data = newline + 1;
+    }
+
+    return parsed;
+}
+
+size_t TleParser::endStream(std::vector<SatelliteTle>& out)
+{
+    size_t parsed = 0;
+    if (!pendingLine.empty() && feedLine(std::move(pendingLine), out))
+        parsed++;
+
+    if (blockSize != 0) {
+        std::cerr << "Incomplete TLE block at end of stream (line " << streamLineCount << ")" << std::endl;
+        streamRejected++;
+    }
+
+    // Счётчик отклонённых блоков остаётся доступным до следующего beginStream()
+    pendingLine.clear();
+    blockSize = 0;
+    return parsed;
+}
+
+bool TleParser::feedLine(std::string line, std::vector<SatelliteTle>& out)
+{
+    streamLineCount++;
+
+    // Пустые строки и комментарии допустимы только перед названием
+    if (blockSize == 0 && (line.empty() || line[0] == '#' || line[0] == '\r'))
+        return false;
+
+    blockLines[blockSize++] = std::move(line);
+    if (blockSize < 3)
+        return false;
+
+    blockSize = 0;
+    SatelliteTle satellite;
+    if (!parseTleBlock(std::move(blockLines[0]), std::move(blockLines[1]),
+        std::move(blockLines[2]), satellite)) {
+        std::cerr << "Invalid TLE block at line " << (streamLineCount - 2) << std::endl;
+        streamRejected++;
+        return false;
+    }
+
+    out.push_back(std::move(satellite));
+    return true;
+}
+
+bool TleParser::parseTleBlock(std::string line0, std::string line1, std::string line2,
+    SatelliteTle& satellite)
+{
+    line0 = cleanTleLine(line0);
+    line1 = cleanTleLine(line1);
+    line2 = cleanTleLine(line2);
+
+    // Валидация TLE блока
+    if (!validateTleBlock(line0, line1, line2))
+        return false;
+
+    int noradId = extractNoradIdFromLine2(line2);
+    if (noradId == -1) {
+        std::cerr << "Failed to extract NORAD ID for: " << line0 << std::endl;
+        return false;
+    }
+
+    satellite.id = 0;
+    satellite.name = extractNameFromLine0(line0);
+    satellite.noradId = noradId;
+    satellite.epoch = extractEpochFromLine1(line1);
+    satellite.tleLine1 = std::move(line1);
+    satellite.tleLine2 = std::move(line2);
+
+    return true;
+}
+
 bool TleParser::validateTleLine(const std::string& line, int lineNumber)
 {
     if (line.empty()) {
@@ -88,7 +206,7 @@ bool TleParser::validateTleLine(const std::string& line, int lineNumber)
         return false;
     }
 
-    //    (  - 69 )
+    // Проверяем длину строки (стандартная длина - 69 символов)
     if (line.length() < 68) {
         std::cerr << "Line " << lineNumber << " is too short: " << line.length() 
             << " characters" << std::endl;
@@ -120,8 +238,8 @@ bool TleParser::validateTleBlock(const std::string& line0, const std::string& li
 int TleParser::extractNoradIdFromLine2(const std::string& line2)
 {
     try {
-        // NORAD ID    2-6   
-        // : "2 25544   ..."
+        // NORAD ID находится в позициях 2-6 во второй строке
+        // Формат: "2 25544   ..."
         if (line2.length() < 7) {
             std::cerr << "Line 2 too short for NORAD ID extraction" << std::endl;
             return -1;
@@ -157,6 +275,43 @@ std::string TleParser::extractEpochFromLine1(const std::string& line1)
     return line1.substr(18, 14);
 }
 
+bool TleParser::decodeElements(const std::string& line1, const std::string& line2, TleElements& elements)
+{
+    if (line1.length() < 68 || line2.length() < 68)
+        return false;
+
+    double noradId = 0.0, eccentricity = 0.0;
+    bool ok = parseFixed(line2, 2, 5, noradId) &&
+        parseFixed(line1, 33, 10, elements.ndot) &&
+        parseExponential(line1, 44, elements.nddot) &&
+        parseExponential(line1, 53, elements.bstar) &&
+        parseFixed(line2, 8, 8, elements.inclination) &&
+        parseFixed(line2, 17, 8, elements.raan) &&
+        parseFixed("0." + line2.substr(26, 7), 0, 9, eccentricity) &&
+        parseFixed(line2, 34, 8, elements.argPerigee) &&
+        parseFixed(line2, 43, 8, elements.meanAnomaly) &&
+        parseFixed(line2, 52, 11, elements.meanMotion);
+    if (!ok)
+        return false;
+
+    if (!JulianDate::fromTleEpoch(line1.data() + 18, 14, elements.epoch))
+        return false;
+
+    elements.noradId = static_cast<int>(noradId);
+    elements.eccentricity = eccentricity;
+    elements.inclination *= DEG2RAD;
+    elements.raan *= DEG2RAD;
+    elements.argPerigee *= DEG2RAD;
+    elements.meanAnomaly *= DEG2RAD;
+    return true;
+}
+
+double TleParser::epochToJulianDate(const std::string& epoch)
+{
+    JulianDate jd;
+    return JulianDate::fromTleEpoch(epoch.data(), epoch.size(), jd) ? jd.value() : 0.0;
+}
+
 std::string TleParser::extractNameFromLine0(const std::string& line0)
 {
     return cleanTleLine(line0);
@@ -166,11 +321,11 @@ std::string TleParser::cleanTleLine(const std::string& line)
 {
     std::string cleaned = line;
 
-    //       
+    // убираем символы возврата коретки и переноса строки
     cleaned.erase(std::remove(cleaned.begin(), cleaned.end(), '\r'), cleaned.end());
     cleaned.erase(std::remove(cleaned.begin(), cleaned.end(), '\n'), cleaned.end());
 
-    //        
+    // убираем лишние пробелы в начале и в конце
     size_t start = cleaned.find_first_not_of(" \t");
     size_t end = cleaned.find_last_not_of(" \t");
 
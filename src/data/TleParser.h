@@ -5,6 +5,22 @@
 #include <optional>
 
 #include "Database.h"
+#include "../time/JulianDate.h"
+
+// Числовые элементы орбиты из строк TLE (единицы как в TLE, углы - в радианах)
+struct TleElements {
+	int noradId = 0;
+	JulianDate epoch;			// эпоха (UTC), по частям: без округления до ~40 мкс
+	double ndot = 0.0;			// первая производная среднего движения / 2, об/сут^2
+	double nddot = 0.0;			// вторая производная / 6, об/сут^3
+	double bstar = 0.0;			// баллистический коэффициент B*, 1/радиус Земли
+	double inclination = 0.0;
+	double raan = 0.0;			// долгота восходящего узла
+	double eccentricity = 0.0;
+	double argPerigee = 0.0;
+	double meanAnomaly = 0.0;
+	double meanMotion = 0.0;	// об/сут
+};
 
 class TleParser
 {
@@ -15,6 +31,13 @@ public:
 	std::vector<SatelliteTle> parseTleData(const std::string& data);
 	std::vector<SatelliteTle> parseTleFile(const std::string& fileName);
 
+	// Потоковый разбор: данные приходят кусками произвольной длины,
+	// незаконченная строка переносится до следующего куска
+	void beginStream();
+	size_t feed(const char* data, size_t size, std::vector<SatelliteTle>& out);
+	size_t endStream(std::vector<SatelliteTle>& out);
+	size_t rejectedInStream() const { return streamRejected; }
+
 	bool validateTleLine(const std::string& line, int lineNumber);
 	bool validateTleBlock(const std::string& line0, const std::string& line1, const std::string& line2);
 
@@ -22,9 +45,22 @@ public:
 	std::string extractEpochFromLine1(const std::string& line1);
 	std::string extractNameFromLine0(const std::string& line0);
 
+	static bool decodeElements(const std::string& line1, const std::string& line2, TleElements& elements);
+	static double epochToJulianDate(const std::string& epoch);
+
 private:
 	std::string cleanTleLine(const std::string& line);
 	bool isTleLineValid(int lineNumber, const std::string& line);
+	bool parseTleBlock(std::string line0, std::string line1, std::string line2,
+		SatelliteTle& satellite);
+	bool feedLine(std::string line, std::vector<SatelliteTle>& out);
+
+	// Состояние потокового разбора
+	std::string pendingLine;
+	std::string blockLines[3];
+	int blockSize = 0;
+	int streamLineCount = 0;
+	size_t streamRejected = 0;
 
 	//bool validateChecksum(const std::string& line);
 	//int calculateChecksum(const std::string& line);
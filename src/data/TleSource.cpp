@@ -0,0 +1,226 @@
+#include "TleSource.h"
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cctype>
+
+namespace fs = std::filesystem;
+
+std::unique_ptr<TleSource> TleSource::fromUrl(const std::string& url)
+{
+	if (url.rfind("http://", 0) == 0 || url.rfind("https://", 0) == 0)
+		return std::make_unique<HttpTleSource>(url);
+
+	// file:///data/tle/active.txt -> /data/tle/active.txt
+	std::string pathStr = url;
+	const std::string fileScheme = "file://";
+	if (pathStr.rfind(fileScheme, 0) == 0)
+		pathStr = pathStr.substr(fileScheme.size());
+
+	std::error_code ec;
+	if (fs::is_directory(pathStr, ec))
+		return std::make_unique<DirectoryTleSource>(pathStr);
+
+	return std::make_unique<FileTleSource>(pathStr);
+}
+
+bool TleSource::fetchChunks(const ChunkSink& sink)
+{
+	std::string data;
+	if (!fetch(data))
+		return false;
+	return sink(data.data(), data.size());
+}
+
+HttpTleSource::HttpTleSource(std::string urlStr) :
+	url(std::move(urlStr)), curl(curl_easy_init())
+{
+}
+
+HttpTleSource::~HttpTleSource()
+{
+	if (curl)
+		curl_easy_cleanup(curl);
+}
+
+bool HttpTleSource::isReady() const
+{
+	return curl != nullptr;
+}
+
+bool HttpTleSource::fetch(std::string& data)
+{
+	return fetchChunks([&data](const char* chunk, size_t size) {
+		data.append(chunk, size);
+		return true;
+	});
+}
+
+bool HttpTleSource::fetchChunks(const ChunkSink& sink)
+{
+	CURLcode res;
+
+	curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+	curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
+	curl_easy_setopt(curl, CURLOPT_WRITEDATA, &sink);
+	curl_easy_setopt(curl, CURLOPT_USERAGENT, "SatelliteTracker/1.0");
+	curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
+	curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+	// Тело ответа с ошибкой не должно попасть в разбор
+	curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+
+	res = curl_easy_perform(curl);
+
+	if (res != CURLE_OK) {
+		std::cerr << "CURL error: " << curl_easy_strerror(res) << std::endl;
+		return false;
+	}
+
+	long httpCode = 0;
+	curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
+
+	if (httpCode != 200) {
+		std::cerr << "HTTP error: " << httpCode << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+size_t HttpTleSource::writeCallback(void* contents, size_t size, size_t nmemb, const ChunkSink* sink)
+{
+	size_t totalSize = size * nmemb;
+	if (!(*sink)(static_cast<const char*>(contents), totalSize))
+		return 0; // curl прервёт загрузку с CURLE_WRITE_ERROR
+	return totalSize;
+}
+
+FileTleSource::FileTleSource(fs::path filePath) : path(std::move(filePath))
+{
+}
+
+bool FileTleSource::isReady() const
+{
+	std::error_code ec;
+	return fs::is_regular_file(path, ec);
+}
+
+bool FileTleSource::fetch(std::string& data)
+{
+	return readFile(path, data);
+}
+
+bool FileTleSource::fetchChunks(const ChunkSink& sink)
+{
+	return streamFile(path, sink);
+}
+
+bool FileTleSource::readFile(const fs::path& filePath, std::string& data)
+{
+	std::ifstream file(filePath, std::ios::binary);
+	if (!file.is_open()) {
+		std::cerr << "Failed to open file: " << filePath.string() << std::endl;
+		return false;
+	}
+
+	file.seekg(0, std::ios::end);
+	std::streamoff size = file.tellg();
+	if (size < 0) {
+		std::cerr << "Failed to get file size: " << filePath.string() << std::endl;
+		return false;
+	}
+	data.resize(static_cast<size_t>(size));
+	file.seekg(0, std::ios::beg);
+	file.read(data.data(), data.size());
+
+	return static_cast<bool>(file);
+}
+
+bool FileTleSource::streamFile(const fs::path& filePath, const ChunkSink& sink)
+{
+	std::ifstream file(filePath, std::ios::binary);
+	if (!file.is_open()) {
+		std::cerr << "Failed to open file: " << filePath.string() << std::endl;
+		return false;
+	}
+
+	const size_t chunkSize = 64 * 1024;
+	std::vector<char> buffer(chunkSize);
+	while (file) {
+		file.read(buffer.data(), buffer.size());
+		std::streamsize count = file.gcount();
+		if (count > 0 && !sink(buffer.data(), static_cast<size_t>(count)))
+			return false;
+	}
+
+	return file.eof();
+}
+
+DirectoryTleSource::DirectoryTleSource(fs::path dirPath) : directory(std::move(dirPath))
+{
+	scanDirectory();
+}
+
+bool DirectoryTleSource::isReady() const
+{
+	return !files.empty();
+}
+
+bool DirectoryTleSource::fetch(std::string& data)
+{
+	const fs::path* file = nextReplayFile();
+	return file && FileTleSource::readFile(*file, data);
+}
+
+bool DirectoryTleSource::fetchChunks(const ChunkSink& sink)
+{
+	const fs::path* file = nextReplayFile();
+	return file && FileTleSource::streamFile(*file, sink);
+}
+
+const fs::path* DirectoryTleSource::nextReplayFile()
+{
+	// Новые файлы могли появиться в каталоге с прошлого обновления
+	scanDirectory();
+	if (files.empty()) {
+		std::cerr << "No TLE files in directory: " << directory.string() << std::endl;
+		return nullptr;
+	}
+
+	size_t index = std::min(nextFile, files.size() - 1);
+	if (nextFile < files.size())
+		nextFile++;
+
+	std::cout << "Replaying TLE file: " << files[index].filename().string() << std::endl;
+	return &files[index];
+}
+
+std::string DirectoryTleSource::describe() const
+{
+	return directory.string() + " (" + std::to_string(files.size()) + " files)";
+}
+
+void DirectoryTleSource::scanDirectory()
+{
+	std::error_code ec;
+	std::vector<fs::path> found;
+
+	for (const auto& entry : fs::directory_iterator(directory, ec)) {
+		if (!entry.is_regular_file(ec))
+			continue;
+
+		std::string ext = entry.path().extension().string();
+		std::transform(ext.begin(), ext.end(), ext.begin(),
+			[](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		if (ext == ".tle" || ext == ".txt" || ext == ".3le")
+			found.push_back(entry.path());
+	}
+
+	if (ec)
+		std::cerr << "Failed to read directory " << directory.string() << ": " << ec.message() << std::endl;
+
+	// Имена вида YYYY-MM-DD сортируются хронологически
+	std::sort(found.begin(), found.end());
+	files = std::move(found);
+}
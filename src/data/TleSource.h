@@ -0,0 +1,92 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <filesystem>
+#include <functional>
+
+#include <curl/curl.h>
+
+// Источник сырых TLE-данных для DataManager.
+// Один вызов fetch() = одно обновление каталога
+class TleSource
+{
+public:
+	// Получатель очередного куска данных; false - прервать загрузку
+	using ChunkSink = std::function<bool(const char* data, size_t size)>;
+
+	virtual ~TleSource() = default;
+
+	virtual bool isReady() const = 0;
+	virtual bool fetch(std::string& data) = 0;
+	virtual std::string describe() const = 0;
+
+	// Потоковая выдача данных по мере поступления (для конвейера загрузки).
+	// По умолчанию - весь ответ одним куском
+	virtual bool fetchChunks(const ChunkSink& sink);
+
+	// http(s):// -> HttpTleSource, file:// или локальный путь -> файл или каталог
+	static std::unique_ptr<TleSource> fromUrl(const std::string& url);
+};
+
+class HttpTleSource : public TleSource
+{
+public:
+	HttpTleSource(std::string urlStr);
+	HttpTleSource(const HttpTleSource&) = delete;
+	~HttpTleSource() override;
+
+	bool isReady() const override;
+	bool fetch(std::string& data) override;
+	bool fetchChunks(const ChunkSink& sink) override;
+	std::string describe() const override { return url; }
+
+private:
+	std::string url;
+	CURL* curl;
+
+	static size_t writeCallback(void* contents, size_t size, size_t nmemb, const ChunkSink* sink);
+};
+
+class FileTleSource : public TleSource
+{
+public:
+	FileTleSource(std::filesystem::path filePath);
+
+	bool isReady() const override;
+	bool fetch(std::string& data) override;
+	bool fetchChunks(const ChunkSink& sink) override;
+	std::string describe() const override { return path.string(); }
+
+	static bool readFile(const std::filesystem::path& filePath, std::string& data);
+	static bool streamFile(const std::filesystem::path& filePath, const ChunkSink& sink);
+
+private:
+	std::filesystem::path path;
+};
+
+// Воспроизведение архива: каталог с датированными файлами (например, 2024-03-01.tle).
+// Файлы отдаются по одному за обновление в порядке имён, после последнего
+// источник остаётся на нём
+class DirectoryTleSource : public TleSource
+{
+public:
+	DirectoryTleSource(std::filesystem::path dirPath);
+
+	bool isReady() const override;
+	bool fetch(std::string& data) override;
+	bool fetchChunks(const ChunkSink& sink) override;
+	std::string describe() const override;
+
+	void rewind() { nextFile = 0; }
+	size_t fileCount() const { return files.size(); }
+
+private:
+	void scanDirectory();
+	const std::filesystem::path* nextReplayFile();
+
+	std::filesystem::path directory;
+	std::vector<std::filesystem::path> files;
+	size_t nextFile = 0;
+};
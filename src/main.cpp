@@ -1,23 +1,52 @@
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <vector>
+#include <cstdlib>
 
 #include "Application.h"
 
 const int WINDOW_WIDTH = 1024, WINDOW_HEIGHT = 780;
 std::string WINDOW_TITLE = "Satellite Tracker";
 
-int main()
+int main(int argc, char* argv[])
 {
+	// Нарезка снимка на тайлы для Earth:
+	// --build-tiles <снимок>[,<часть>...] [<каталог>] [--columns <N>] [--rgb]
+	// Снимок больше 2 ГБ в RGB подаётся частями через запятую: по строкам
+	// с севера, по N частей в строке (по умолчанию все части - одна строка)
+	if (argc >= 3 && std::string(argv[1]) == "--build-tiles") {
+		std::vector<std::string> parts;
+		std::istringstream list(argv[2]);
+		for (std::string part; std::getline(list, part, ',');)
+			parts.push_back(part);
+		std::string directory = Earth::dayTilesPath;
+		int columns = static_cast<int>(parts.size());
+		bool rgb = false;
+		for (int i = 3; i < argc; i++) {
+			std::string arg = argv[i];
+			if (arg == "--rgb")
+				rgb = true;
+			else if (arg == "--columns" && i + 1 < argc)
+				columns = std::atoi(argv[++i]);
+			else
+				directory = arg;
+		}
+		bool ok = VirtualTexture::build(parts, columns, directory,
+			rgb ? TextureCache::Format::Rgb8 : TextureCache::Format::Bc1);
+		return ok ? 0 : -1;
+	}
+
 	Application app(WINDOW_TITLE.c_str(), WINDOW_WIDTH, WINDOW_HEIGHT);
 	
-	if (!app.init()) { //   : SDL, Glad, ImGui
+	if (!app.init()) { // Инициализация систем : SDL, Glad, ImGui
 		std::cout << "App initialization failed!" << std::endl;
 		return -1;
 	}
 	
-	app.start(); //  
+	app.start(); // Основной цикл
 	
-	app.shutdown(); //  
+	app.shutdown(); // Очистка ресурсов
 	
 	return 0;
 }
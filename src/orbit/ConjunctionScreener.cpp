@@ -0,0 +1,284 @@
+#include "ConjunctionScreener.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+namespace {
+
+	// Наибольшее относительное ускорение пары на НОО, км/с^2: запас на кривизну
+	// траекторий между отсчётами
+	const double maxRelativeAcceleration = 0.02;
+
+	const int64_t cellBias = int64_t(1) << 20;
+
+	uint64_t cellKey(int64_t ix, int64_t iy, int64_t iz)
+	{
+		return (uint64_t(ix + cellBias) << 42) | (uint64_t(iy + cellBias) << 21) | uint64_t(iz + cellBias);
+	}
+
+	// Соседние ячейки "вперёд": каждая пара соседей просматривается один раз
+	struct CellOffset {
+		int dx, dy, dz;
+	};
+
+	std::vector<CellOffset> forwardOffsets()
+	{
+		std::vector<CellOffset> offsets;
+		for (int dx = -1; dx <= 1; dx++)
+			for (int dy = -1; dy <= 1; dy++)
+				for (int dz = -1; dz <= 1; dz++) {
+					if (dx > 0 || (dx == 0 && dy > 0) || (dx == 0 && dy == 0 && dz > 0))
+						offsets.push_back({ dx, dy, dz });
+				}
+		return offsets;
+	}
+
+	// Минимум унимодальной f на [a, b] золотым сечением
+	template <typename Func>
+	double goldenMinimum(Func&& f, double a, double b, double tolerance, double& best)
+	{
+		const double ratio = 0.5 * (std::sqrt(5.0) - 1.0);
+		double x1 = b - ratio * (b - a), x2 = a + ratio * (b - a);
+		double f1 = f(x1), f2 = f(x2);
+		while (b - a > tolerance) {
+			if (f1 > f2) {
+				a = x1;
+				x1 = x2; f1 = f2;
+				x2 = a + ratio * (b - a);
+				f2 = f(x2);
+			}
+			else {
+				b = x2;
+				x2 = x1; f2 = f1;
+				x1 = b - ratio * (b - a);
+				f1 = f(x1);
+			}
+		}
+		best = std::min(f1, f2);
+		return f1 < f2 ? x1 : x2;
+	}
+
+}
+
+// Рабочие буферы одного потока, переиспользуются между шагами
+struct ConjunctionScreener::StepScratch {
+	Sgp4Batch::States states;
+	std::vector<std::pair<uint64_t, uint32_t>> cells;	// ключ ячейки, индекс в пакете
+	std::unordered_map<uint64_t, uint32_t> cellStart;	// ключ -> начало в cells
+};
+
+ConjunctionScreener::ConjunctionScreener(const SatelliteCatalog& catalog, const Sgp4Batch& batch,
+	WorkStealingPool& pool, const ConjunctionSettings& settings)
+	: catalog(catalog), batch(batch), pool(pool), settings(settings)
+{
+	this->settings.stepSeconds = std::max(this->settings.stepSeconds, 1.0);
+	this->settings.thresholdKm = std::max(this->settings.thresholdKm, 0.001);
+}
+
+std::vector<ConjunctionEvent> ConjunctionScreener::screen(double startJd, double hours)
+{
+	stats = Stats();
+	const size_t count = batch.size();
+	const auto& slots = batch.slots();
+
+	// Записи для уточнения и границы орбит по средним элементам
+	records.assign(count, Sgp4Record());
+	perigee.assign(count, 0.0);
+	apogee.assign(count, -1.0);
+	pool.parallelFor(count, 256, [&](size_t begin, size_t end, unsigned) {
+		for (size_t i = begin; i < end; i++) {
+			if (!catalog.isAlive(slots[i]))
+				continue;
+			TleElements elements = catalog.elements(slots[i]);
+			if (Sgp4::initialize(elements, records[i]) != Sgp4Error::None)
+				continue;
+			double meanMotion = elements.meanMotion * 2.0 * M_PI / 86400.0;	// рад/с
+			double semiMajor = std::cbrt(Sgp4::mu / (meanMotion * meanMotion));
+			perigee[i] = semiMajor * (1.0 - elements.eccentricity) - settings.radialMarginKm;
+			apogee[i] = semiMajor * (1.0 + elements.eccentricity) + settings.radialMarginKm;
+		}
+	});
+
+	const uint32_t steps = static_cast<uint32_t>(std::floor(hours * 3600.0 / settings.stepSeconds)) + 1;
+	stats.steps = steps;
+
+	std::vector<StepScratch> scratch(pool.threadCount());
+	std::vector<std::vector<Candidate>> perWorker(pool.threadCount());
+	std::vector<size_t> candidatePairs(pool.threadCount(), 0);
+	pool.parallelFor(steps, 1, [&](size_t begin, size_t end, unsigned worker) {
+		for (size_t step = begin; step < end; step++) {
+			double jd = startJd + step * settings.stepSeconds / 86400.0;
+			screenStep(jd, static_cast<uint32_t>(step), scratch[worker], perWorker[worker],
+				candidatePairs[worker]);
+		}
+	});
+
+	std::vector<Candidate> candidates;
+	for (size_t worker = 0; worker < perWorker.size(); worker++) {
+		stats.candidatePairs += candidatePairs[worker];
+		candidates.insert(candidates.end(), perWorker[worker].begin(), perWorker[worker].end());
+	}
+	stats.refinedPairs = candidates.size();
+
+	// Уточнение TCA: кандидаты независимы
+	std::vector<std::vector<ConjunctionEvent>> refined(pool.threadCount());
+	pool.parallelFor(candidates.size(), 16, [&](size_t begin, size_t end, unsigned worker) {
+		for (size_t i = begin; i < end; i++) {
+			ConjunctionEvent event;
+			if (refine(candidates[i], startJd, event))
+				refined[worker].push_back(event);
+		}
+	});
+
+	std::vector<ConjunctionEvent> found;
+	for (auto& part : refined)
+		found.insert(found.end(), part.begin(), part.end());
+
+	// Соседние отсчёты одной пары находят одно и то же сближение
+	std::sort(found.begin(), found.end(), [](const ConjunctionEvent& a, const ConjunctionEvent& b) {
+		if (a.slotA != b.slotA)
+			return a.slotA < b.slotA;
+		if (a.slotB != b.slotB)
+			return a.slotB < b.slotB;
+		return a.tcaJd < b.tcaJd;
+	});
+	const double mergeDays = settings.stepSeconds / 86400.0;
+	std::vector<ConjunctionEvent> events;
+	for (const auto& event : found) {
+		if (!events.empty()) {
+			ConjunctionEvent& last = events.back();
+			if (last.slotA == event.slotA && last.slotB == event.slotB && event.tcaJd - last.tcaJd < mergeDays) {
+				if (event.missDistanceKm < last.missDistanceKm)
+					last = event;
+				continue;
+			}
+		}
+		events.push_back(event);
+	}
+
+	std::sort(events.begin(), events.end(), [](const ConjunctionEvent& a, const ConjunctionEvent& b) {
+		return a.tcaJd < b.tcaJd;
+	});
+	stats.events = events.size();
+	return events;
+}
+
+void ConjunctionScreener::screenStep(double jd, uint32_t step, StepScratch& scratch,
+	std::vector<Candidate>& out, size_t& candidatePairs) const
+{
+	static const std::vector<CellOffset> offsets = forwardOffsets();
+	Sgp4Batch::States& states = scratch.states;
+	auto& cells = scratch.cells;
+	auto& cellStart = scratch.cellStart;
+
+	const size_t count = batch.size();
+	if (states.size() != count)
+		states.resize(count);
+	batch.propagateRange(JulianDate(jd), 0, count, states);
+
+	// Отсчёт не дальше полшага от TCA: на отсчёте пара ближе порога плюс
+	// относительный путь за полшага и запас на кривизну - это размер ячейки
+	const double halfStep = 0.5 * settings.stepSeconds;
+	const double curvature = 0.5 * maxRelativeAcceleration * halfStep * halfStep;
+	const double cellSize = settings.thresholdKm + settings.maxRelativeSpeed * halfStep + curvature;
+
+	cells.clear();
+	for (size_t i = 0; i < count; i++) {
+		if (states.error[i] != 0 || apogee[i] < 0.0)
+			continue;
+		cells.push_back({ cellKey(static_cast<int64_t>(std::floor(states.x[i] / cellSize)),
+			static_cast<int64_t>(std::floor(states.y[i] / cellSize)),
+			static_cast<int64_t>(std::floor(states.z[i] / cellSize))), static_cast<uint32_t>(i) });
+	}
+	std::sort(cells.begin(), cells.end());
+
+	cellStart.clear();
+	cellStart.reserve(cells.size());
+	for (uint32_t k = 0; k < cells.size(); k++) {
+		if (k == 0 || cells[k].first != cells[k - 1].first)
+			cellStart.emplace(cells[k].first, k);
+	}
+
+	auto testPair = [&](uint32_t a, uint32_t b) {
+		if (std::max(perigee[a], perigee[b]) > std::min(apogee[a], apogee[b]) + settings.thresholdKm)
+			return;
+		candidatePairs++;
+
+		// Сближение по прямой в пределах полушага; отклонение от прямой не больше curvature
+		glm::dvec3 dr(states.x[a] - states.x[b], states.y[a] - states.y[b], states.z[a] - states.z[b]);
+		glm::dvec3 dv(states.vx[a] - states.vx[b], states.vy[a] - states.vy[b], states.vz[a] - states.vz[b]);
+		double speed2 = glm::dot(dv, dv);
+		double tau = speed2 > 0.0 ? glm::clamp(-glm::dot(dr, dv) / speed2, -halfStep, halfStep) : 0.0;
+		glm::dvec3 closest = dr + dv * tau;
+		double reach = settings.thresholdKm + curvature;
+		if (glm::dot(closest, closest) > reach * reach)
+			return;
+		out.push_back({ std::min(a, b), std::max(a, b), step });
+	};
+
+	const int64_t mask = (int64_t(1) << 21) - 1;
+	for (size_t begin = 0; begin < cells.size();) {
+		size_t end = begin + 1;
+		while (end < cells.size() && cells[end].first == cells[begin].first)
+			end++;
+
+		// Внутри ячейки
+		for (size_t i = begin; i < end; i++)
+			for (size_t j = i + 1; j < end; j++)
+				testPair(cells[i].second, cells[j].second);
+
+		// Соседние ячейки
+		uint64_t key = cells[begin].first;
+		int64_t ix = int64_t(key >> 42) - cellBias;
+		int64_t iy = int64_t((key >> 21) & mask) - cellBias;
+		int64_t iz = int64_t(key & mask) - cellBias;
+		for (const auto& offset : offsets) {
+			auto it = cellStart.find(cellKey(ix + offset.dx, iy + offset.dy, iz + offset.dz));
+			if (it == cellStart.end())
+				continue;
+			uint64_t neighbour = it->first;
+			for (size_t j = it->second; j < cells.size() && cells[j].first == neighbour; j++)
+				for (size_t i = begin; i < end; i++)
+					testPair(cells[i].second, cells[j].second);
+		}
+		begin = end;
+	}
+}
+
+bool ConjunctionScreener::refine(const Candidate& candidate, double startJd, ConjunctionEvent& event) const
+{
+	const Sgp4Record& recordA = records[candidate.a];
+	const Sgp4Record& recordB = records[candidate.b];
+	const double stepDays = settings.stepSeconds / 86400.0;
+	const double centerJd = startJd + candidate.step * stepDays;
+
+	auto distance = [&](double jd) {
+		glm::dvec3 posA, velA, posB, velB;
+		if (Sgp4::propagate(recordA, Sgp4::minutesSinceEpoch(recordA, jd), posA, velA) != Sgp4Error::None ||
+			Sgp4::propagate(recordB, Sgp4::minutesSinceEpoch(recordB, jd), posB, velB) != Sgp4Error::None)
+			return HUGE_VAL;
+		return glm::length(posA - posB);
+	};
+
+	// Точность TCA ~1 мс: при 15 км/с это 15 м по промаху в худшем случае
+	double miss;
+	double tcaJd = goldenMinimum(distance, centerJd - stepDays, centerJd + stepDays, 1e-3 / 86400.0, miss);
+	if (miss > settings.thresholdKm)
+		return false;
+
+	glm::dvec3 posA, velA, posB, velB;
+	Sgp4::propagate(recordA, Sgp4::minutesSinceEpoch(recordA, tcaJd), posA, velA);
+	Sgp4::propagate(recordB, Sgp4::minutesSinceEpoch(recordB, tcaJd), posB, velB);
+
+	SatelliteCatalog::Slot slotA = batch.slots()[candidate.a];
+	SatelliteCatalog::Slot slotB = batch.slots()[candidate.b];
+	event.slotA = std::min(slotA, slotB);
+	event.slotB = std::max(slotA, slotB);
+	event.noradA = catalog.columns().noradId[event.slotA];
+	event.noradB = catalog.columns().noradId[event.slotB];
+	event.tcaJd = tcaJd;
+	event.missDistanceKm = miss;
+	event.relativeSpeedKmS = glm::length(velA - velB);
+	return true;
+}
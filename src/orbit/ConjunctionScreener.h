@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vector>
+
+#include "Sgp4Batch.h"
+#include "WorkStealingPool.h"
+
+// Сближение двух объектов: время наибольшего сближения (TCA) и промах
+struct ConjunctionEvent {
+	SatelliteCatalog::Slot slotA = SatelliteCatalog::invalidSlot;
+	SatelliteCatalog::Slot slotB = SatelliteCatalog::invalidSlot;
+	int noradA = 0;
+	int noradB = 0;
+	double tcaJd = 0.0;
+	double missDistanceKm = 0.0;
+	double relativeSpeedKmS = 0.0;
+};
+
+struct ConjunctionSettings {
+	double thresholdKm = 5.0;		// порог промаха для отчёта
+	double stepSeconds = 20.0;		// шаг временной сетки
+	double maxRelativeSpeed = 16.0;	// км/с, встречное движение на НОО
+	double radialMarginKm = 25.0;	// запас фильтра перигей/апогей на короткопериодические члены
+};
+
+// Скрининг сближений "все со всеми" без перебора пар.
+// Каталог распространяется на временной сетке; на каждом шаге положения
+// раскладываются по равномерной пространственной сетке с ячейкой не меньше
+// порога плюс путь, который пара может пройти навстречу за полшага, и
+// сравниваются только объекты из соседних ячеек. Пары, у которых диапазоны
+// радиусов [перигей, апогей] не пересекаются, отбрасываются сразу; для
+// остальных по положению и скорости на отсчёте считается сближение по прямой
+// в пределах полушага. Кандидаты уточняются золотым сечением по расстоянию на интервале
+// в два шага вокруг отсчёта. Шаги сетки распределяются по WorkStealingPool
+class ConjunctionScreener
+{
+public:
+	struct Stats {
+		size_t steps = 0;
+		size_t candidatePairs = 0;	// прошли сетку и фильтр радиусов
+		size_t refinedPairs = 0;	// сближение по прямой около отсчёта ближе порога
+		size_t events = 0;
+	};
+
+	ConjunctionScreener(const SatelliteCatalog& catalog, const Sgp4Batch& batch, WorkStealingPool& pool,
+		const ConjunctionSettings& settings = ConjunctionSettings());
+
+	// Пакет должен быть собран из того же каталога (Sgp4Batch::isStale() == false)
+	std::vector<ConjunctionEvent> screen(double startJd, double hours);
+
+	const Stats& lastStats() const { return stats; }
+
+private:
+	struct Candidate {
+		uint32_t a, b;		// индексы в пакете, a < b
+		uint32_t step;
+	};
+
+	struct StepScratch;
+
+	void screenStep(double jd, uint32_t step, StepScratch& scratch, std::vector<Candidate>& out,
+		size_t& candidatePairs) const;
+	bool refine(const Candidate& candidate, double startJd, ConjunctionEvent& event) const;
+
+	const SatelliteCatalog& catalog;
+	const Sgp4Batch& batch;
+	WorkStealingPool& pool;
+	ConjunctionSettings settings;
+
+	std::vector<Sgp4Record> records;	// для уточнения, индекс - как в пакете
+	std::vector<double> perigee, apogee;
+	Stats stats;
+};
@@ -0,0 +1,315 @@
+#include "EphemerisCache.h"
+
+#include <algorithm>
+#include <cmath>
+
+EphemerisCache::EphemerisCache(const EphemerisSettings& settings)
+	: settings(settings)
+{
+	this->settings.degree = std::max(this->settings.degree, 2);
+	this->settings.segmentsPerRevolution = std::max(this->settings.segmentsPerRevolution, 1);
+	this->settings.maxSplits = std::clamp(this->settings.maxSplits, 0, 16);
+}
+
+EphemerisCache::EphemerisCache(const SatelliteCatalog& catalog, const EphemerisSettings& settings)
+	: EphemerisCache(settings)
+{
+	sync(catalog);
+}
+
+void EphemerisCache::sync(const SatelliteCatalog& catalog)
+{
+	if (synced && catalog.version() == syncedVersion)
+		return;
+
+	// Инициализация SGP4 - вне блокировки, запросы в это время идут по старой копии
+	const auto& revisions = catalog.columns().revision;
+	std::vector<std::pair<SatelliteCatalog::Slot, SlotState>> changed;
+	{
+		std::shared_lock<std::shared_mutex> lock(slotsMutex);
+		for (SatelliteCatalog::Slot slot = 0; slot < catalog.slotCount(); slot++) {
+			bool alive = catalog.isAlive(slot);
+			if (slot < slots.size() && slots[slot].alive == alive &&
+				(!alive || slots[slot].revision == revisions[slot]))
+				continue;
+
+			SlotState state;
+			state.alive = alive;
+			if (alive) {
+				TleElements elements = catalog.elements(slot);
+				state.revision = revisions[slot];
+				state.meanMotion = elements.meanMotion;
+				state.initError = Sgp4::initialize(elements, state.record);
+			}
+			changed.emplace_back(slot, state);
+		}
+	}
+
+	std::unique_lock<std::shared_mutex> lock(slotsMutex);
+	slots.resize(catalog.slotCount());
+	for (auto& [slot, state] : changed)
+		slots[slot] = std::move(state);
+	syncedVersion = catalog.version();
+	synced = true;
+}
+
+bool EphemerisCache::position(SatelliteCatalog::Slot slot, double jd, glm::dvec3& position, glm::dvec3* velocity)
+{
+	// Запись копируется: sync() может заменить её во время построения отрезка
+	SlotState state;
+	{
+		std::shared_lock<std::shared_mutex> lock(slotsMutex);
+		if (slot >= slots.size() || !slots[slot].alive)
+			return false;
+		if (slots[slot].initError != Sgp4Error::None)
+			return false;
+		state = slots[slot];
+	}
+
+	double spanDays = segmentSpanDays(state.meanMotion);
+	SegmentKey key{ slot, static_cast<int64_t>(std::floor(jd / spanDays)) };
+	Shard& shard = shards[slot % shardCount];
+
+	// Отрезок, не уложившийся в допуск, считается SGP4 вне блокировки
+	bool direct = false;
+	{
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		auto it = shard.index.find(key);
+		if (it != shard.index.end() && it->second->revision == state.revision) {
+			shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+			shard.hits++;
+			if (it->second->failed)
+				return false;
+			direct = it->second->direct;
+			if (!direct) {
+				evaluate(*it->second, jd, position, velocity);
+				return true;
+			}
+		}
+	}
+	if (direct)
+		return propagateDirect(state.record, jd, position, velocity);
+
+	// Построение отрезка - вне блокировки, SGP4 считается десятки раз.
+	// Неудача тоже кладётся в кэш, чтобы сошедший с орбиты объект не
+	// пересчитывался при каждом запросе
+	Segment segment;
+	segment.key = key;
+	double fitError = 0.0;
+	uint64_t splits = 0;
+	segment.failed = !fit(state.record, spanDays, segment, fitError, splits);
+	segment.revision = state.revision;
+	bool ok = false;
+	if (segment.failed || segment.direct) {
+		segment.pieces.clear();
+		segment.coefficients.clear();
+		ok = !segment.failed && propagateDirect(state.record, jd, position, velocity);
+	}
+	else {
+		evaluate(segment, jd, position, velocity);
+		ok = true;
+	}
+	size_t bytes = segmentBytes(segment);
+
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	shard.misses++;
+	shard.splits += splits;
+	if (segment.direct)
+		shard.directSegments++;
+	else
+		shard.maxFitError = std::max(shard.maxFitError, fitError);
+
+	// Другой поток мог успеть построить тот же отрезок, или TLE обновились
+	auto it = shard.index.find(key);
+	if (it != shard.index.end()) {
+		shard.bytes = shard.bytes - segmentBytes(*it->second) + bytes;
+		*it->second = std::move(segment);
+		shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+	}
+	else {
+		shard.lru.push_front(std::move(segment));
+		shard.index[key] = shard.lru.begin();
+		shard.bytes += bytes;
+	}
+
+	size_t shardBudget = settings.memoryBudget / shardCount;
+	while (shard.bytes > shardBudget && shard.lru.size() > 1) {
+		shard.bytes -= segmentBytes(shard.lru.back());
+		shard.index.erase(shard.lru.back().key);
+		shard.lru.pop_back();
+		shard.evictions++;
+	}
+	return ok;
+}
+
+void EphemerisCache::clear()
+{
+	for (auto& shard : shards) {
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		shard.lru.clear();
+		shard.index.clear();
+		shard.bytes = 0;
+	}
+}
+
+EphemerisCache::Stats EphemerisCache::stats() const
+{
+	Stats total;
+	for (auto& shard : shards) {
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		total.hits += shard.hits;
+		total.misses += shard.misses;
+		total.evictions += shard.evictions;
+		total.segments += shard.lru.size();
+		total.bytes += shard.bytes;
+		total.splits += shard.splits;
+		total.directSegments += shard.directSegments;
+		total.maxFitError = std::max(total.maxFitError, shard.maxFitError);
+	}
+	return total;
+}
+
+double EphemerisCache::segmentSpanDays(double meanMotion) const
+{
+	if (meanMotion <= 0.0)
+		return 1.0;
+	return 1.0 / (meanMotion * settings.segmentsPerRevolution);
+}
+
+bool EphemerisCache::fit(const Sgp4Record& record, double spanDays, Segment& segment, double& fitError,
+	uint64_t& splits) const
+{
+	segment.pieces.clear();
+	segment.coefficients.clear();
+	segment.direct = false;
+	fitError = 0.0;
+	return fitPiece(record, Piece{ segment.key.index * spanDays, spanDays }, 0, segment, fitError, splits);
+}
+
+bool EphemerisCache::fitPiece(const Sgp4Record& record, const Piece& piece, int depth, Segment& segment,
+	double& fitError, uint64_t& splits) const
+{
+	// Отрезок уже отдан SGP4 - остальные части не нужны
+	if (segment.direct)
+		return true;
+
+	const int count = settings.degree + 1;
+	auto sample = [&](double x, glm::dvec3& position) {
+		double jd = piece.startJd + 0.5 * (x + 1.0) * piece.spanDays;
+		glm::dvec3 velocity;
+		Sgp4Error error = Sgp4::propagate(record, Sgp4::minutesSinceEpoch(record, jd), position, velocity);
+		return error == Sgp4Error::None;
+	};
+
+	// Значения в узлах Чебышёва и дискретное косинус-преобразование
+	std::vector<glm::dvec3> values(count);
+	for (int k = 0; k < count; k++) {
+		double x = std::cos(M_PI * (k + 0.5) / count);
+		if (!sample(x, values[k]))
+			return false;
+	}
+
+	std::vector<double> coefficients(3 * count);
+	for (int j = 0; j < count; j++) {
+		glm::dvec3 sum(0.0);
+		for (int k = 0; k < count; k++)
+			sum += values[k] * std::cos(M_PI * j * (k + 0.5) / count);
+		double scale = (j == 0 ? 1.0 : 2.0) / count;
+		coefficients[j] = sum.x * scale;
+		coefficients[count + j] = sum.y * scale;
+		coefficients[2 * count + j] = sum.z * scale;
+	}
+
+	// Проверка между узлами, где ошибка интерполяции наибольшая
+	double error = 0.0;
+	if (settings.validateFit) {
+		for (int k = 0; k + 1 < count; k++) {
+			double x = std::cos(M_PI * (k + 1.0) / count);
+			glm::dvec3 exact, approx;
+			if (!sample(x, exact))
+				return false;
+			evaluatePiece(coefficients.data(), piece, piece.startJd + 0.5 * (x + 1.0) * piece.spanDays, approx, nullptr);
+			error = std::max(error, glm::length(exact - approx));
+		}
+	}
+
+	// Сверх допуска - две половины со своими многочленами: у перигея вытянутых
+	// орбит это и нужно, а остальная часть отрезка остаётся одним куском
+	if (error > settings.maxErrorKm) {
+		if (depth >= settings.maxSplits) {
+			segment.direct = true;
+			return true;
+		}
+		splits++;
+		Piece first{ piece.startJd, 0.5 * piece.spanDays };
+		Piece second{ piece.startJd + first.spanDays, first.spanDays };
+		return fitPiece(record, first, depth + 1, segment, fitError, splits)
+			&& fitPiece(record, second, depth + 1, segment, fitError, splits);
+	}
+
+	fitError = std::max(fitError, error);
+	segment.pieces.push_back(piece);
+	segment.coefficients.insert(segment.coefficients.end(), coefficients.begin(), coefficients.end());
+	return true;
+}
+
+void EphemerisCache::evaluate(const Segment& segment, double jd, glm::dvec3& position, glm::dvec3* velocity) const
+{
+	// Последняя часть, начавшаяся не позже jd; части идут по возрастанию
+	auto it = std::upper_bound(segment.pieces.begin(), segment.pieces.end(), jd,
+		[](double value, const Piece& piece) { return value < piece.startJd; });
+	size_t index = it == segment.pieces.begin() ? 0 : static_cast<size_t>(it - segment.pieces.begin()) - 1;
+	const double* coefficients = segment.coefficients.data() + index * 3 * (settings.degree + 1);
+	evaluatePiece(coefficients, segment.pieces[index], jd, position, velocity);
+}
+
+void EphemerisCache::evaluatePiece(const double* coefficients, const Piece& piece, double jd,
+	glm::dvec3& position, glm::dvec3* velocity) const
+{
+	const int count = settings.degree + 1;
+	const double* cx = coefficients;
+	const double* cy = cx + count;
+	const double* cz = cy + count;
+
+	double x = 2.0 * (jd - piece.startJd) / piece.spanDays - 1.0;
+
+	// Многочлены Чебышёва первого (T) и второго (U) рода: T'_j = j * U_(j-1)
+	double tPrev = 1.0, t = x;
+	double uPrev = 1.0, u = 2.0 * x;
+	position = glm::dvec3(cx[0], cy[0], cz[0]) + glm::dvec3(cx[1], cy[1], cz[1]) * x;
+	glm::dvec3 derivative = glm::dvec3(cx[1], cy[1], cz[1]);
+
+	for (int j = 2; j < count; j++) {
+		double tNext = 2.0 * x * t - tPrev;
+		tPrev = t;
+		t = tNext;
+		position += glm::dvec3(cx[j], cy[j], cz[j]) * t;
+
+		// u сейчас U_(j-1)
+		derivative += glm::dvec3(cx[j], cy[j], cz[j]) * (j * u);
+		double uNext = 2.0 * x * u - uPrev;
+		uPrev = u;
+		u = uNext;
+	}
+
+	// d/dx -> км/с: x проходит часть длины 2 за spanDays
+	if (velocity)
+		*velocity = derivative * (2.0 / (piece.spanDays * 86400.0));
+}
+
+bool EphemerisCache::propagateDirect(const Sgp4Record& record, double jd, glm::dvec3& position, glm::dvec3* velocity)
+{
+	glm::dvec3 v;
+	if (Sgp4::propagate(record, Sgp4::minutesSinceEpoch(record, jd), position, v) != Sgp4Error::None)
+		return false;
+	if (velocity)
+		*velocity = v;
+	return true;
+}
+
+size_t EphemerisCache::segmentBytes(const Segment& segment) const
+{
+	// Коэффициенты и части плюс узлы списка и хэш-таблицы
+	return segment.coefficients.size() * sizeof(double) + segment.pieces.size() * sizeof(Piece)
+		+ sizeof(Segment) + 64;
+}
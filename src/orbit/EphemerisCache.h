@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Sgp4.h"
+#include "../data/SatelliteCatalog.h"
+
+struct EphemerisSettings {
+	int degree = 12;					// степень многочлена на отрезке
+	int segmentsPerRevolution = 4;		// длина отрезка - доля периода обращения
+	size_t memoryBudget = 64u << 20;	// байт на весь кэш
+	// Сверка аппроксимации с SGP4 в серединах между узлами. Без неё ошибка
+	// ничем не ограничена: у вытянутых орбит у перигея это километры
+	bool validateFit = true;
+	double maxErrorKm = 0.01;			// допуск сверки: часть отрезка сверх него делится пополам
+	int maxSplits = 4;					// не больше 2^maxSplits частей; дальше отрезок считается SGP4 напрямую
+};
+
+// Кэш эфемерид: положение спутника на отрезке времени приближается
+// многочленами Чебышёва по выходу SGP4. Отрезки строятся лениво при первом
+// запросе, повторные запросы внутри отрезка - несколько умножений-сложений.
+// Отрезки привязаны к сетке по времени, поэтому соседние запросы попадают в
+// один и тот же отрезок. Вытеснение - LRU в пределах бюджета памяти.
+// Кэш разбит на независимые части по слоту, запросы из разных потоков допустимы.
+// Каталог не читается во время запросов: sync() копирует элементы изменённых
+// слотов, и вызывать её нужно там же, где каталог меняется (он не защищён
+// блокировкой) - например, после DataManager::update(). Запросы могут идти
+// одновременно с sync(). Сбои SGP4 запоминаются до новой ревизии слота.
+// При validateFit ошибка ограничена maxErrorKm: часть отрезка, не прошедшая
+// сверку, делится пополам и приближается заново, а отрезок, не уложившийся
+// в допуск и после maxSplits делений, не кэшируется - запросы в нём идут в SGP4
+class EphemerisCache
+{
+public:
+	struct Stats {
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t evictions = 0;
+		size_t segments = 0;
+		size_t bytes = 0;
+		double maxFitError = 0.0;	// км, наибольшее отклонение принятых аппроксимаций
+		uint64_t splits = 0;		// делений частей отрезков пополам
+		uint64_t directSegments = 0;	// отрезков, отданных SGP4 напрямую
+	};
+
+	explicit EphemerisCache(const EphemerisSettings& settings = EphemerisSettings());
+	// Сразу вызывает sync(catalog)
+	explicit EphemerisCache(const SatelliteCatalog& catalog, const EphemerisSettings& settings = EphemerisSettings());
+	EphemerisCache(EphemerisCache&) = delete;
+
+	// Копирует элементы слотов, ревизия которых изменилась; без изменений
+	// каталога (version()) ничего не делает
+	void sync(const SatelliteCatalog& catalog);
+
+	// TEME, км и км/с; false - слот пуст или SGP4 не смог посчитать отрезок
+	bool position(SatelliteCatalog::Slot slot, double jd, glm::dvec3& position, glm::dvec3* velocity = nullptr);
+	void clear();
+
+	Stats stats() const;
+	const EphemerisSettings& getSettings() const { return settings; }
+
+private:
+	struct SegmentKey {
+		SatelliteCatalog::Slot slot;
+		int64_t index;
+		bool operator==(const SegmentKey& other) const { return slot == other.slot && index == other.index; }
+	};
+
+	struct SegmentKeyHash {
+		size_t operator()(const SegmentKey& key) const
+		{
+			return std::hash<uint64_t>()((uint64_t(key.slot) << 40) ^ uint64_t(key.index));
+		}
+	};
+
+	// Часть отрезка со своим многочленом
+	struct Piece {
+		double startJd = 0.0;
+		double spanDays = 0.0;
+	};
+
+	struct Segment {
+		SegmentKey key;
+		uint32_t revision = 0;		// ревизия слота каталога на момент построения
+		bool failed = false;		// SGP4 не посчитал отрезок - коэффициентов нет
+		bool direct = false;		// не уложился в допуск - запросы идут в SGP4
+		std::vector<Piece> pieces;	// по возрастанию startJd, вместе покрывают отрезок
+		std::vector<double> coefficients;	// на часть: x, y, z подряд по (degree + 1)
+	};
+
+	// Копия слота каталога на момент sync()
+	struct SlotState {
+		bool alive = false;
+		uint32_t revision = 0;
+		double meanMotion = 0.0;	// об/сут
+		Sgp4Error initError = Sgp4Error::None;
+		Sgp4Record record;
+	};
+
+	struct Shard {
+		mutable std::mutex mutex;
+		std::list<Segment> lru;		// начало - недавно использованные
+		std::unordered_map<SegmentKey, std::list<Segment>::iterator, SegmentKeyHash> index;
+		size_t bytes = 0;
+		uint64_t hits = 0, misses = 0, evictions = 0;
+		uint64_t splits = 0, directSegments = 0;
+		double maxFitError = 0.0;
+	};
+
+	static constexpr int shardCount = 16;
+
+	double segmentSpanDays(double meanMotion) const;
+	bool fit(const Sgp4Record& record, double spanDays, Segment& segment, double& fitError, uint64_t& splits) const;
+	bool fitPiece(const Sgp4Record& record, const Piece& piece, int depth, Segment& segment,
+		double& fitError, uint64_t& splits) const;
+	void evaluate(const Segment& segment, double jd, glm::dvec3& position, glm::dvec3* velocity) const;
+	void evaluatePiece(const double* coefficients, const Piece& piece, double jd,
+		glm::dvec3& position, glm::dvec3* velocity) const;
+	static bool propagateDirect(const Sgp4Record& record, double jd, glm::dvec3& position, glm::dvec3* velocity);
+	size_t segmentBytes(const Segment& segment) const;
+
+	EphemerisSettings settings;
+	Shard shards[shardCount];
+
+	mutable std::shared_mutex slotsMutex;
+	std::vector<SlotState> slots;	// под slotsMutex
+	uint64_t syncedVersion = 0;
+	bool synced = false;
+};
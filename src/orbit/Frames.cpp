@@ -0,0 +1,223 @@
+#include "Frames.h"
+
+#include <cmath>
+
+#include "Sgp4.h"
+
+namespace {
+
+	const double arcsecToRad = M_PI / (180.0 * 3600.0);
+	const double degToRad = M_PI / 180.0;
+
+	double centuriesSinceJ2000(double jd)
+	{
+		return (jd - 2451545.0) / 36525.0;
+	}
+
+	// Повороты системы координат (не вектора) вокруг осей на угол a
+	glm::dmat3 rotX(double a)
+	{
+		double c = std::cos(a), s = std::sin(a);
+		return glm::transpose(glm::dmat3(1.0, 0.0, 0.0, 0.0, c, s, 0.0, -s, c));
+	}
+
+	glm::dmat3 rotY(double a)
+	{
+		double c = std::cos(a), s = std::sin(a);
+		return glm::transpose(glm::dmat3(c, 0.0, -s, 0.0, 1.0, 0.0, s, 0.0, c));
+	}
+
+	glm::dmat3 rotZ(double a)
+	{
+		double c = std::cos(a), s = std::sin(a);
+		return glm::transpose(glm::dmat3(c, s, 0.0, -s, c, 0.0, 0.0, 0.0, 1.0));
+	}
+
+	// TEME -> TOD -> MOD -> J2000
+	glm::dmat3 temeToGcrsMatrix(double jd)
+	{
+		double t = centuriesSinceJ2000(jd);
+
+		// Прецессия IAU-76: J2000 -> MOD
+		double zeta = (2306.2181 * t + 0.30188 * t * t + 0.017998 * t * t * t) * arcsecToRad;
+		double z = (2306.2181 * t + 1.09468 * t * t + 0.018203 * t * t * t) * arcsecToRad;
+		double theta = (2004.3109 * t - 0.42665 * t * t - 0.041833 * t * t * t) * arcsecToRad;
+		glm::dmat3 precession = rotZ(-z) * rotY(theta) * rotZ(-zeta);
+
+		// Нутация IAU-80, четыре главных члена: MOD -> TOD
+		double node = (125.04452 - 1934.136261 * t) * degToRad;
+		double sunLongitude = (280.4665 + 36000.7698 * t) * degToRad;
+		double moonLongitude = (218.3165 + 481267.8813 * t) * degToRad;
+		double dPsi = (-17.20 * std::sin(node) - 1.32 * std::sin(2.0 * sunLongitude) -
+			0.23 * std::sin(2.0 * moonLongitude) + 0.21 * std::sin(2.0 * node)) * arcsecToRad;
+		double dEps = (9.20 * std::cos(node) + 0.57 * std::cos(2.0 * sunLongitude) +
+			0.10 * std::cos(2.0 * moonLongitude) - 0.09 * std::cos(2.0 * node)) * arcsecToRad;
+		double eps = Frames::meanObliquity(jd);
+		glm::dmat3 nutation = rotX(-(eps + dEps)) * rotZ(-dPsi) * rotX(eps);
+
+		// TEME отличается от TOD на уравнение равноденствий
+		glm::dmat3 equinox = rotZ(-dPsi * std::cos(eps));
+
+		return glm::transpose(precession) * glm::transpose(nutation) * equinox;
+	}
+
+}
+
+double Frames::gmst(double jdUt1)
+{
+	return Sgp4::gmst(jdUt1);
+}
+
+double Frames::meanObliquity(double jdTt)
+{
+	double t = centuriesSinceJ2000(jdTt);
+	return (84381.448 - 46.8150 * t - 0.00059 * t * t + 0.001813 * t * t * t) * arcsecToRad;
+}
+
+glm::dvec3 Frames::temeToEcef(const glm::dvec3& teme, double jd)
+{
+	double theta = gmst(jd);
+	double c = std::cos(theta), s = std::sin(theta);
+	return glm::dvec3(c * teme.x + s * teme.y, -s * teme.x + c * teme.y, teme.z);
+}
+
+glm::dvec3 Frames::ecefToTeme(const glm::dvec3& ecef, double jd)
+{
+	double theta = gmst(jd);
+	double c = std::cos(theta), s = std::sin(theta);
+	return glm::dvec3(c * ecef.x - s * ecef.y, s * ecef.x + c * ecef.y, ecef.z);
+}
+
+glm::dvec3 Frames::temeToEcefVelocity(const glm::dvec3& teme, const glm::dvec3& temeVelocity, double jd)
+{
+	glm::dvec3 position = temeToEcef(teme, jd);
+	glm::dvec3 velocity = temeToEcef(temeVelocity, jd);
+	return velocity - glm::cross(glm::dvec3(0.0, 0.0, earthRotation), position);
+}
+
+glm::dvec3 Frames::temeToGcrs(const glm::dvec3& teme, double jd)
+{
+	return temeToGcrsMatrix(jd) * teme;
+}
+
+glm::dvec3 Frames::gcrsToTeme(const glm::dvec3& gcrs, double jd)
+{
+	return glm::transpose(temeToGcrsMatrix(jd)) * gcrs;
+}
+
+Geodetic Frames::ecefToGeodetic(const glm::dvec3& ecef)
+{
+	Geodetic geodetic;
+	ecefToGeodetic(1, &ecef.x, &ecef.y, &ecef.z, &geodetic.latitude, &geodetic.longitude, &geodetic.altitudeKm);
+	return geodetic;
+}
+
+glm::dvec3 Frames::geodeticToEcef(const Geodetic& geodetic)
+{
+	double e2 = wgs84F * (2.0 - wgs84F);
+	double sinLat = std::sin(geodetic.latitude), cosLat = std::cos(geodetic.latitude);
+	double n = wgs84A / std::sqrt(1.0 - e2 * sinLat * sinLat);
+	return glm::dvec3((n + geodetic.altitudeKm) * cosLat * std::cos(geodetic.longitude),
+		(n + geodetic.altitudeKm) * cosLat * std::sin(geodetic.longitude),
+		(n * (1.0 - e2) + geodetic.altitudeKm) * sinLat);
+}
+
+TopocentricFrame Frames::topocentricFrame(const Geodetic& observer)
+{
+	double sinLat = std::sin(observer.latitude), cosLat = std::cos(observer.latitude);
+	double sinLon = std::sin(observer.longitude), cosLon = std::cos(observer.longitude);
+
+	TopocentricFrame frame;
+	frame.position = geodeticToEcef(observer);
+	frame.up = glm::dvec3(cosLat * cosLon, cosLat * sinLon, sinLat);
+	frame.east = glm::dvec3(-sinLon, cosLon, 0.0);
+	frame.north = glm::dvec3(-sinLat * cosLon, -sinLat * sinLon, cosLat);
+	return frame;
+}
+
+LookAngles Frames::lookAngles(const TopocentricFrame& frame, const glm::dvec3& ecef)
+{
+	LookAngles angles;
+	lookAngles(frame, 1, &ecef.x, &ecef.y, &ecef.z, &angles.azimuth, &angles.elevation, &angles.rangeKm);
+	return angles;
+}
+
+double Frames::elevation(const TopocentricFrame& frame, const glm::dvec3& ecef)
+{
+	glm::dvec3 range = ecef - frame.position;
+	return std::asin(glm::clamp(glm::dot(range, frame.up) / glm::length(range), -1.0, 1.0));
+}
+
+glm::vec3 Frames::ecefToScene(const glm::dvec3& ecef)
+{
+	return glm::vec3(glm::dvec3(ecef.y, ecef.z, ecef.x) / wgs84A);
+}
+
+void Frames::temeToEcef(double jd, size_t count, const double* x, const double* y, const double* z,
+	double* outX, double* outY, double* outZ)
+{
+	double theta = gmst(jd);
+	const double c = std::cos(theta), s = std::sin(theta);
+	for (size_t i = 0; i < count; i++) {
+		double tx = x[i], ty = y[i];
+		outX[i] = c * tx + s * ty;
+		outY[i] = -s * tx + c * ty;
+		outZ[i] = z[i];
+	}
+}
+
+void Frames::temeToScene(double jd, size_t count, const float* teme, float* scene)
+{
+	double theta = gmst(jd);
+	const float c = static_cast<float>(std::cos(theta) / wgs84A);
+	const float s = static_cast<float>(std::sin(theta) / wgs84A);
+	const float scale = static_cast<float>(1.0 / wgs84A);
+	for (size_t i = 0; i < count; i++) {
+		float tx = teme[3 * i], ty = teme[3 * i + 1], tz = teme[3 * i + 2];
+		scene[3 * i] = -s * tx + c * ty;
+		scene[3 * i + 1] = tz * scale;
+		scene[3 * i + 2] = c * tx + s * ty;
+	}
+}
+
+void Frames::ecefToGeodetic(size_t count, const double* x, const double* y, const double* z,
+	double* latitude, double* longitude, double* altitudeKm)
+{
+	const double e2 = wgs84F * (2.0 - wgs84F);
+	for (size_t i = 0; i < count; i++) {
+		double px = x[i], py = y[i], pz = z[i];
+		double p = std::sqrt(px * px + py * py);
+
+		// Неподвижная точка по широте, tg(lat) = (z + e2 * N * sin(lat)) / p; тангенс
+		// хранится числителем и знаменателем, так что тригонометрия не нужна и полюс
+		// не особая точка. Каждая итерация уменьшает ошибку в ~1/e2 раз, трёх хватает
+		// до долей миллиметра от поверхности до ГСО
+		double numerator = pz, denominator = p * (1.0 - e2);
+		for (int iteration = 0; iteration < 3; iteration++) {
+			double sinLat = numerator / std::sqrt(numerator * numerator + denominator * denominator);
+			double n = wgs84A / std::sqrt(1.0 - e2 * sinLat * sinLat);
+			numerator = pz + e2 * n * sinLat;
+			denominator = p;
+		}
+		double norm = 1.0 / std::sqrt(numerator * numerator + denominator * denominator);
+		double sinLat = numerator * norm, cosLat = denominator * norm;
+
+		// Высота без деления на cos(lat), устойчиво у полюсов
+		latitude[i] = std::atan2(numerator, denominator);
+		longitude[i] = std::atan2(py, px);
+		altitudeKm[i] = p * cosLat + pz * sinLat - wgs84A * std::sqrt(1.0 - e2 * sinLat * sinLat);
+	}
+}
+
+void Frames::lookAngles(const TopocentricFrame& frame, size_t count, const double* x, const double* y,
+	const double* z, double* azimuth, double* elevation, double* rangeKm)
+{
+	for (size_t i = 0; i < count; i++) {
+		glm::dvec3 range = glm::dvec3(x[i], y[i], z[i]) - frame.position;
+		double length = glm::length(range);
+		double az = std::atan2(glm::dot(range, frame.east), glm::dot(range, frame.north));
+		azimuth[i] = az < 0.0 ? az + 2.0 * M_PI : az;
+		elevation[i] = std::asin(glm::clamp(glm::dot(range, frame.up) / length, -1.0, 1.0));
+		rangeKm[i] = length;
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+
+#include <glm/glm.hpp>
+
+// Геодезические координаты WGS-84, радианы и км
+struct Geodetic {
+	double latitude = 0.0;
+	double longitude = 0.0;		// восточная долгота положительна, [-pi, pi]
+	double altitudeKm = 0.0;
+};
+
+// Топоцентрический базис наблюдателя в ECEF
+struct TopocentricFrame {
+	glm::dvec3 position = glm::dvec3(0.0);	// км
+	glm::dvec3 up = glm::dvec3(0.0);
+	glm::dvec3 east = glm::dvec3(0.0);
+	glm::dvec3 north = glm::dvec3(0.0);
+};
+
+// Азимут от севера по часовой стрелке [0, 2pi), угол места - радианы
+struct LookAngles {
+	double azimuth = 0.0;
+	double elevation = 0.0;
+	double rangeKm = 0.0;
+};
+
+// Системы координат.
+// TEME - выход SGP4; ECEF получается поворотом на гринвичское среднее звёздное
+// время (UT1 ~ UTC, движение полюса не учитывается); GCRS - приближённо, как
+// J2000: прецессия IAU-76 и главные члены нутации IAU-80, точность порядка
+// угловой секунды. Сцена рендера - ECEF в радиусах Земли с осью Y на северный
+// полюс и Гринвичем на +Z, как у сферы в Earth.
+// Пакетные варианты работают с массивами (SoA - как Sgp4Batch::States,
+// xyz подряд - как PositionFrame) и написаны без ветвлений, чтобы компилятор
+// векторизовал циклы; результат можно писать поверх входа
+class Frames
+{
+public:
+	// WGS-84
+	static constexpr double wgs84A = 6378.137;
+	static constexpr double wgs84F = 1.0 / 298.257223563;
+	// Угловая скорость вращения Земли, рад/с
+	static constexpr double earthRotation = 7.292115e-5;
+
+	static double gmst(double jdUt1);
+	// Средний наклон эклиптики к экватору, радианы
+	static double meanObliquity(double jdTt);
+
+	static glm::dvec3 temeToEcef(const glm::dvec3& teme, double jd);
+	static glm::dvec3 ecefToTeme(const glm::dvec3& ecef, double jd);
+	// Скорость в ECEF с учётом вращения Земли, км/с
+	static glm::dvec3 temeToEcefVelocity(const glm::dvec3& teme, const glm::dvec3& temeVelocity, double jd);
+	static glm::dvec3 temeToGcrs(const glm::dvec3& teme, double jd);
+	static glm::dvec3 gcrsToTeme(const glm::dvec3& gcrs, double jd);
+
+	static Geodetic ecefToGeodetic(const glm::dvec3& ecef);
+	static glm::dvec3 geodeticToEcef(const Geodetic& geodetic);
+
+	static TopocentricFrame topocentricFrame(const Geodetic& observer);
+	static LookAngles lookAngles(const TopocentricFrame& frame, const glm::dvec3& ecef);
+	// Только угол места - для поиска восхода/захода, без atan2 азимута
+	static double elevation(const TopocentricFrame& frame, const glm::dvec3& ecef);
+
+	static glm::vec3 ecefToScene(const glm::dvec3& ecef);
+
+	// Пакетные варианты
+	static void temeToEcef(double jd, size_t count, const double* x, const double* y, const double* z,
+		double* outX, double* outY, double* outZ);
+	static void temeToScene(double jd, size_t count, const float* teme, float* scene);
+	static void ecefToGeodetic(size_t count, const double* x, const double* y, const double* z,
+		double* latitude, double* longitude, double* altitudeKm);
+	static void lookAngles(const TopocentricFrame& frame, size_t count, const double* x, const double* y,
+		const double* z, double* azimuth, double* elevation, double* rangeKm);
+};
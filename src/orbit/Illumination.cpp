@@ -0,0 +1,123 @@
+#include "Illumination.h"
+
+#include <cmath>
+
+namespace {
+
+	const double degToRad = M_PI / 180.0;
+
+	// Доля диска Солнца, видимая из точки p. sinB = R/|p| - синус углового
+	// радиуса Земли, sinA = Rs/|s - p| - Солнца; c - угол между центрами дисков.
+	// Солнце открыто целиком при c >= a + b и закрыто при c <= b - a;
+	// граничные косинусы cos(a +- b) получаются из синусов без обратных функций
+	template <typename T>
+	inline T fractionKernel(T px, T py, T pz, T sx, T sy, T sz, T earthRadius, T sunRadius)
+	{
+		T dx = sx - px, dy = sy - py, dz = sz - pz;
+		T r = std::sqrt(px * px + py * py + pz * pz);
+		T d = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+		T sinB = earthRadius / r;
+		sinB = sinB < T(1) ? sinB : T(1);	// под поверхностью - умбра
+		T sinA = sunRadius / d;
+		T cosB = std::sqrt(T(1) - sinB * sinB);
+		T cosA = std::sqrt(T(1) - sinA * sinA);
+		T cosC = -(px * dx + py * dy + pz * dz) / (r * d);
+
+		T inner = cosA * cosB + sinA * sinB;	// cos(b - a)
+		T width = T(2) * sinA * sinB;			// cos(b - a) - cos(b + a)
+		T fraction = (inner - cosC) / width;
+		fraction = fraction > T(0) ? fraction : T(0);
+		return fraction < T(1) ? fraction : T(1);
+	}
+
+	template <typename T>
+	inline ShadowState stateOf(T fraction)
+	{
+		return static_cast<ShadowState>((fraction < T(1)) + (fraction <= T(0)));
+	}
+
+}
+
+glm::dvec3 Illumination::sunPosition(const JulianDate& utc)
+{
+	// Теория движения Солнца - в земном времени TT
+	double jdTt = TimeScales::utcToTt(utc).value();
+	double t = (jdTt - 2451545.0) / 36525.0;
+
+	double meanLongitude = std::fmod(280.460 + 36000.771 * t, 360.0);
+	double meanAnomaly = std::fmod(357.5291092 + 35999.05034 * t, 360.0) * degToRad;
+	double longitude = (meanLongitude + 1.914666471 * std::sin(meanAnomaly) +
+		0.019994643 * std::sin(2.0 * meanAnomaly)) * degToRad;
+	double distance = (1.000140612 - 0.016708617 * std::cos(meanAnomaly) -
+		0.000139589 * std::cos(2.0 * meanAnomaly)) * astronomicalUnitKm;
+
+	// Эклиптика даты -> средний экватор даты; от TEME он отличается на нутацию,
+	// меньше 20", что для тени и освещения несущественно
+	double epsilon = Frames::meanObliquity(jdTt);
+	return distance * glm::dvec3(
+		std::cos(longitude),
+		std::cos(epsilon) * std::sin(longitude),
+		std::sin(epsilon) * std::sin(longitude));
+}
+
+float Illumination::sunlitFraction(const glm::dvec3& sun, const glm::dvec3& position, ShadowState* state)
+{
+	double fraction = fractionKernel(position.x, position.y, position.z, sun.x, sun.y, sun.z,
+		Frames::wgs84A, sunRadiusKm);
+	if (state)
+		*state = stateOf(fraction);
+	return static_cast<float>(fraction);
+}
+
+void Illumination::shadow(const glm::dvec3& sun, size_t count, const double* x, const double* y, const double* z,
+	float* fraction, ShadowState* state)
+{
+	for (size_t i = 0; i < count; i++) {
+		double f = fractionKernel(x[i], y[i], z[i], sun.x, sun.y, sun.z, Frames::wgs84A, sunRadiusKm);
+		fraction[i] = static_cast<float>(f);
+		state[i] = stateOf(f);
+	}
+}
+
+void Illumination::shadow(const glm::dvec3& sun, size_t count, const float* positions,
+	float* fraction, ShadowState* state)
+{
+	// Вектор на Солнце в float округляется до ~10 км - это 1e-7 рад по направлению
+	const float sx = static_cast<float>(sun.x), sy = static_cast<float>(sun.y), sz = static_cast<float>(sun.z);
+	const float earthRadius = static_cast<float>(Frames::wgs84A);
+	const float sunRadius = static_cast<float>(sunRadiusKm);
+	for (size_t i = 0; i < count; i++) {
+		const float* p = positions + 3 * i;
+		float f = fractionKernel(p[0], p[1], p[2], sx, sy, sz, earthRadius, sunRadius);
+		fraction[i] = f;
+		state[i] = stateOf(f);
+	}
+}
+
+void Illumination::visibility(const Observer& observer, double jd, const glm::dvec3& sun, size_t count,
+	const float* positions, uint8_t* flags)
+{
+	// Наблюдатель поворачивается в TEME один раз, спутники остаются как есть
+	glm::dvec3 station = Frames::ecefToTeme(observer.frame.position, jd);
+	glm::dvec3 up = Frames::ecefToTeme(observer.frame.up, jd);
+	bool dark = Frames::elevation(observer.frame, Frames::temeToEcef(sun, jd)) < observer.twilightElevation;
+
+	const float ox = static_cast<float>(station.x), oy = static_cast<float>(station.y), oz = static_cast<float>(station.z);
+	const float ux = static_cast<float>(up.x), uy = static_cast<float>(up.y), uz = static_cast<float>(up.z);
+	const float sinMask = static_cast<float>(std::sin(observer.minElevation));
+	const float sx = static_cast<float>(sun.x), sy = static_cast<float>(sun.y), sz = static_cast<float>(sun.z);
+	const float earthRadius = static_cast<float>(Frames::wgs84A);
+	const float sunRadius = static_cast<float>(sunRadiusKm);
+	const uint8_t darkFlag = dark ? ObserverDark : 0;
+
+	for (size_t i = 0; i < count; i++) {
+		const float* p = positions + 3 * i;
+		float rx = p[0] - ox, ry = p[1] - oy, rz = p[2] - oz;
+		float range = std::sqrt(rx * rx + ry * ry + rz * rz);
+		// sin(угла места) >= sin(маски) без деления и asin
+		bool above = rx * ux + ry * uy + rz * uz >= sinMask * range;
+		bool lit = fractionKernel(p[0], p[1], p[2], sx, sy, sz, earthRadius, sunRadius) > 0.5f;
+		flags[i] = static_cast<uint8_t>((above ? AboveHorizon : 0) | (lit ? Sunlit : 0) | darkFlag);
+	}
+}
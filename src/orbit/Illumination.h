@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#include "Frames.h"
+#include "../time/JulianDate.h"
+
+enum class ShadowState : uint8_t {
+	Sunlit = 0,
+	Penumbra = 1,
+	Umbra = 2,
+};
+
+// Наблюдатель для расчёта видимости: топоцентрический базис и маска горизонта
+struct Observer {
+	TopocentricFrame frame;
+	double minElevation = 0.0;		// радианы
+	double twilightElevation = -0.10471975511965977;	// -6°: Солнце ниже - у наблюдателя темно
+};
+
+// Освещённость спутников и видимость с наблюдателя.
+// Тень Земли - конус (умбра и полутень) по видимым с спутника радиусам дисков
+// Земли и Солнца; сравнения идут через косинусы углов, так что на объект нужно
+// несколько корней и ни одной тригонометрической функции. Доля диска Солнца в
+// полутени - линейно по косинусу углового расстояния между центрами дисков.
+// Пакетные варианты принимают положения в TEME (SoA или xyz подряд) и
+// написаны без ветвлений; всё, что зависит только от момента времени
+// (Солнце, наблюдатель в TEME), считается один раз на вызов
+class Illumination
+{
+public:
+	enum VisibilityFlag : uint8_t {
+		AboveHorizon = 1,	// выше маски горизонта наблюдателя
+		Sunlit = 2,			// освещён больше чем наполовину
+		ObserverDark = 4,	// Солнце у наблюдателя ниже twilightElevation
+		Visible = 7,		// все три условия: виден глазом или в телескоп
+	};
+
+	static constexpr double sunRadiusKm = 696000.0;
+	static constexpr double astronomicalUnitKm = 149597870.7;
+
+	// Положение Солнца в TEME, км (формула Астрономического ежегодника, ~0.01°)
+	static glm::dvec3 sunPosition(const JulianDate& utc);
+
+	// Доля видимого диска Солнца [0, 1] для одного положения
+	static float sunlitFraction(const glm::dvec3& sun, const glm::dvec3& position, ShadowState* state = nullptr);
+
+	static void shadow(const glm::dvec3& sun, size_t count, const double* x, const double* y, const double* z,
+		float* fraction, ShadowState* state);
+	static void shadow(const glm::dvec3& sun, size_t count, const float* positions,
+		float* fraction, ShadowState* state);
+
+	// Флаги VisibilityFlag для каждого объекта; jd - момент положений (UTC)
+	static void visibility(const Observer& observer, double jd, const glm::dvec3& sun, size_t count,
+		const float* positions, uint8_t* flags);
+};
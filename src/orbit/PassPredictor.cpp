@@ -0,0 +1,313 @@
+#include "PassPredictor.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Frames.h"
+#include "Illumination.h"
+
+namespace {
+
+	const double degToRad = M_PI / 180.0;
+	const double radToDeg = 180.0 / M_PI;
+
+	// Топоцентрический базис станции и маска горизонта
+	struct StationFrame {
+		TopocentricFrame topocentric;
+		glm::dvec3 radial;		// геоцентрическое направление на станцию
+		double minElevation;	// радианы
+	};
+
+	StationFrame makeStationFrame(const GroundStation& station)
+	{
+		StationFrame frame;
+		frame.topocentric = Frames::topocentricFrame({ station.latitude * degToRad, station.longitude * degToRad,
+			station.altitudeKm });
+		frame.radial = glm::normalize(frame.topocentric.position);
+		frame.minElevation = station.minElevation * degToRad;
+		return frame;
+	}
+
+	// Корень f на [a, b] при fa, fb разных знаков (Брент, zeroin)
+	template <typename Func>
+	double brentRoot(Func&& f, double a, double b, double fa, double fb, double tolerance)
+	{
+		double c = a, fc = fa, d = b - a, e = d;
+		for (int iteration = 0; iteration < 64; iteration++) {
+			if ((fb > 0.0) == (fc > 0.0)) {
+				c = a;
+				fc = fa;
+				d = e = b - a;
+			}
+			if (std::fabs(fc) < std::fabs(fb)) {
+				a = b; b = c; c = a;
+				fa = fb; fb = fc; fc = fa;
+			}
+
+			double tol = 2.0 * 1e-15 * std::fabs(b) + 0.5 * tolerance;
+			double m = 0.5 * (c - b);
+			if (std::fabs(m) <= tol || fb == 0.0)
+				return b;
+
+			if (std::fabs(e) >= tol && std::fabs(fa) > std::fabs(fb)) {
+				// Секущая или обратная квадратичная интерполяция
+				double s = fb / fa, p, q;
+				if (a == c) {
+					p = 2.0 * m * s;
+					q = 1.0 - s;
+				}
+				else {
+					double r = fb / fc;
+					q = fa / fc;
+					p = s * (2.0 * m * q * (q - r) - (b - a) * (r - 1.0));
+					q = (q - 1.0) * (r - 1.0) * (s - 1.0);
+				}
+				if (p > 0.0)
+					q = -q;
+				else
+					p = -p;
+				if (2.0 * p < std::min(3.0 * m * q - std::fabs(tol * q), std::fabs(e * q))) {
+					e = d;
+					d = p / q;
+				}
+				else {
+					d = m;
+					e = m;
+				}
+			}
+			else {
+				d = m;
+				e = m;
+			}
+
+			a = b;
+			fa = fb;
+			b += std::fabs(d) > tol ? d : (m > 0.0 ? tol : -tol);
+			fb = f(b);
+		}
+		return b;
+	}
+
+	// Максимум унимодальной f на [a, b] золотым сечением
+	template <typename Func>
+	double goldenMaximum(Func&& f, double a, double b, double tolerance, double& best)
+	{
+		const double ratio = 0.5 * (std::sqrt(5.0) - 1.0);
+		double x1 = b - ratio * (b - a), x2 = a + ratio * (b - a);
+		double f1 = f(x1), f2 = f(x2);
+		while (b - a > tolerance) {
+			if (f1 < f2) {
+				a = x1;
+				x1 = x2; f1 = f2;
+				x2 = a + ratio * (b - a);
+				f2 = f(x2);
+			}
+			else {
+				b = x2;
+				x2 = x1; f2 = f1;
+				x1 = b - ratio * (b - a);
+				f1 = f(x1);
+			}
+		}
+		best = std::max(f1, f2);
+		return f1 > f2 ? x1 : x2;
+	}
+
+}
+
+PassPredictor::PassPredictor(const SatelliteCatalog& catalog, WorkStealingPool& pool, const PassSettings& settings)
+	: catalog(catalog), pool(pool), settings(settings)
+{
+}
+
+std::vector<SatellitePass> PassPredictor::predict(const GroundStation& station, double startJd, double days) const
+{
+	std::vector<SatelliteCatalog::Slot> slots;
+	slots.reserve(catalog.size());
+	for (SatelliteCatalog::Slot slot = 0; slot < catalog.slotCount(); slot++) {
+		if (catalog.isAlive(slot))
+			slots.push_back(slot);
+	}
+
+	std::vector<std::vector<SatellitePass>> perWorker(pool.threadCount());
+	pool.parallelFor(slots.size(), settings.satellitesPerTask, [&](size_t begin, size_t end, unsigned worker) {
+		for (size_t i = begin; i < end; i++)
+			predictSlot(station, slots[i], startJd, startJd + days, perWorker[worker]);
+	});
+
+	std::vector<SatellitePass> passes;
+	for (auto& part : perWorker)
+		passes.insert(passes.end(), part.begin(), part.end());
+	std::sort(passes.begin(), passes.end(), [](const SatellitePass& a, const SatellitePass& b) {
+		return a.aosJd < b.aosJd;
+	});
+	return passes;
+}
+
+std::vector<SatellitePass> PassPredictor::predict(const GroundStation& station, SatelliteCatalog::Slot slot,
+	double startJd, double days) const
+{
+	std::vector<SatellitePass> passes;
+	if (catalog.isAlive(slot))
+		predictSlot(station, slot, startJd, startJd + days, passes);
+	return passes;
+}
+
+void PassPredictor::lookAngles(const GroundStation& station, const glm::dvec3& temePosition, double jd,
+	double& elevation, double& azimuth)
+{
+	LookAngles angles = Frames::lookAngles(makeStationFrame(station).topocentric,
+		Frames::temeToEcef(temePosition, jd));
+	elevation = angles.elevation * radToDeg;
+	azimuth = angles.azimuth * radToDeg;
+}
+
+void PassPredictor::predictSlot(const GroundStation& station, SatelliteCatalog::Slot slot,
+	double startJd, double endJd, std::vector<SatellitePass>& passes) const
+{
+	TleElements elements = catalog.elements(slot);
+	Sgp4Record record;
+	if (Sgp4::initialize(elements, record) != Sgp4Error::None)
+		return;
+
+	const StationFrame frame = makeStationFrame(station);
+	const double stepDays = settings.stepMinutes / 1440.0;
+	const double toleranceDays = settings.timeToleranceSeconds / 86400.0;
+
+	// Границы орбиты по среднему движению
+	double meanMotion = elements.meanMotion * 2.0 * M_PI / 1440.0;	// рад/мин
+	double ecc = std::min(elements.eccentricity, 0.99);
+	double semiMajor = std::cbrt(Sgp4::mu * 3600.0 / (meanMotion * meanMotion));
+	double apogee = semiMajor * (1.0 + ecc);
+	if (apogee <= Frames::wgs84A)
+		return;
+
+	// Угловой радиус зоны видимости на апогее и запас на сплюснутость и возмущения
+	double visibilityRadius = std::acos(std::min(1.0, Frames::wgs84A / apogee * std::cos(frame.minElevation))) -
+		frame.minElevation + 0.02;
+
+	// Наклонение ограничивает широту подспутниковой точки
+	double maxLatitude = std::min(elements.inclination, M_PI - elements.inclination);
+	double stationLatitude = std::asin(frame.radial.z);
+	if (std::fabs(stationLatitude) > maxLatitude + visibilityRadius)
+		return;
+
+	// Наибольшая скорость изменения геоцентрического угла станция-спутник, рад/мин
+	double angularRate = meanMotion * (1.0 + ecc) * (1.0 + ecc) / std::pow(1.0 - ecc * ecc, 1.5) +
+		Frames::earthRotation * 60.0;
+
+	struct Sample {
+		bool ok;
+		double elevation;	// радианы
+		double separation;	// геоцентрический угол станция-спутник
+		glm::dvec3 ecef;
+	};
+	auto sample = [&](double jd) {
+		Sample s{ false, 0.0, 0.0, glm::dvec3(0.0) };
+		glm::dvec3 position, velocity;
+		if (Sgp4::propagate(record, Sgp4::minutesSinceEpoch(record, jd), position, velocity) != Sgp4Error::None)
+			return s;
+		s.ok = true;
+		s.ecef = Frames::temeToEcef(position, jd);
+		s.elevation = Frames::elevation(frame.topocentric, s.ecef);
+		s.separation = std::acos(glm::clamp(glm::dot(glm::normalize(s.ecef), frame.radial), -1.0, 1.0));
+		return s;
+	};
+	auto aboveMask = [&](double jd) {
+		Sample s = sample(jd);
+		return s.ok ? s.elevation - frame.minElevation : -1.0;
+	};
+	auto elevationAt = [&](double jd) {
+		Sample s = sample(jd);
+		return s.ok ? s.elevation : -M_PI;
+	};
+
+	SatellitePass pass;
+	pass.slot = slot;
+	pass.noradId = elements.noradId;
+	double coarseMaxJd = 0.0, coarseMax = -M_PI;
+
+	auto finishPass = [&](double losJd) {
+		pass.losJd = losJd;
+		Sample los = sample(losJd);
+		pass.losAzimuth = los.ok ? Frames::lookAngles(frame.topocentric, los.ecef).azimuth * radToDeg : 0.0;
+
+		// Кульминация: уточнение около лучшего грубого отсчёта
+		double low = std::max(pass.aosJd, coarseMaxJd - stepDays);
+		double high = std::min(pass.losJd, coarseMaxJd + stepDays);
+		double best = coarseMax;
+		double bestJd = coarseMaxJd;
+		if (high > low) {
+			double refined;
+			double refinedJd = goldenMaximum(elevationAt, low, high, toleranceDays, refined);
+			if (refined > best) {
+				best = refined;
+				bestJd = refinedJd;
+			}
+		}
+		pass.maxElevationJd = bestJd;
+		pass.maxElevation = best * radToDeg;
+
+		// Видимость - на момент кульминации
+		Sample top = sample(bestJd);
+		glm::dvec3 sun = Illumination::sunPosition(JulianDate(bestJd));
+		pass.visible = top.ok &&
+			Illumination::sunlitFraction(sun, Frames::ecefToTeme(top.ecef, bestJd)) > 0.5f &&
+			Frames::elevation(frame.topocentric, Frames::temeToEcef(sun, bestJd)) < -6.0 * degToRad;
+		passes.push_back(pass);
+	};
+
+	Sample current = sample(startJd);
+	if (!current.ok)
+		return;
+
+	double t = startJd;
+	bool inPass = current.elevation >= frame.minElevation;
+	if (inPass) {
+		pass.aosJd = startJd;
+		pass.aosAzimuth = Frames::lookAngles(frame.topocentric, current.ecef).azimuth * radToDeg;
+		coarseMaxJd = startJd;
+		coarseMax = current.elevation;
+	}
+
+	while (t < endJd) {
+		double step = stepDays;
+		if (!inPass) {
+			// Раньше этого момента спутник не может войти в зону видимости
+			double skipMinutes = (current.separation - visibilityRadius) / angularRate;
+			step = std::max(step, skipMinutes / 1440.0);
+		}
+
+		double next = std::min(t + step, endJd);
+		Sample following = sample(next);
+		if (!following.ok)
+			break;
+
+		bool nextAbove = following.elevation >= frame.minElevation;
+		if (!inPass && nextAbove) {
+			pass.aosJd = brentRoot(aboveMask, t, next, current.elevation - frame.minElevation,
+				following.elevation - frame.minElevation, toleranceDays);
+			Sample aos = sample(pass.aosJd);
+			pass.aosAzimuth = aos.ok ? Frames::lookAngles(frame.topocentric, aos.ecef).azimuth * radToDeg : 0.0;
+			coarseMaxJd = next;
+			coarseMax = following.elevation;
+			inPass = true;
+		}
+		else if (inPass && !nextAbove) {
+			finishPass(brentRoot(aboveMask, t, next, current.elevation - frame.minElevation,
+				following.elevation - frame.minElevation, toleranceDays));
+			inPass = false;
+			coarseMax = -M_PI;
+		}
+		else if (inPass && following.elevation > coarseMax) {
+			coarseMaxJd = next;
+			coarseMax = following.elevation;
+		}
+
+		t = next;
+		current = following;
+	}
+
+	if (inPass)
+		finishPass(std::min(t, endJd));
+}
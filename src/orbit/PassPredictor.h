@@ -0,0 +1,72 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Sgp4.h"
+#include "WorkStealingPool.h"
+#include "../data/SatelliteCatalog.h"
+
+// Наземная станция: геодезические координаты WGS-84
+struct GroundStation {
+	std::string name;
+	double latitude = 0.0;		// градусы
+	double longitude = 0.0;		// градусы, восточная долгота положительна
+	double altitudeKm = 0.0;
+	double minElevation = 0.0;	// градусы, маска горизонта
+};
+
+// Пролёт над станцией; времена - юлианские даты UTC, углы - градусы.
+// Если пролёт уже идёт в начале окна или не закончился к концу, AOS/LOS
+// обрезаются границами окна
+struct SatellitePass {
+	SatelliteCatalog::Slot slot = SatelliteCatalog::invalidSlot;
+	int noradId = 0;
+	double aosJd = 0.0;
+	double losJd = 0.0;
+	double maxElevationJd = 0.0;
+	double maxElevation = 0.0;
+	double aosAzimuth = 0.0;
+	double losAzimuth = 0.0;
+	bool visible = false;		// в кульминации освещён, а у станции сумерки (Солнце ниже -6°)
+};
+
+struct PassSettings {
+	double stepMinutes = 1.0;			// грубый шаг; пролёты короче шага у самого горизонта могут быть пропущены
+	double timeToleranceSeconds = 1.0;	// точность AOS/LOS/кульминации
+	size_t satellitesPerTask = 16;		// объектов на кусок WorkStealingPool
+};
+
+// Прогноз пролётов для всего каталога.
+// Для каждого объекта время идёт грубыми шагами; пока спутник заведомо
+// далеко за горизонтом, шаг увеличивается до момента, раньше которого он
+// не может подняться над маской (по угловому радиусу зоны видимости на
+// апогее и наибольшей угловой скорости). Объекты, чьё наклонение не
+// позволяет подойти к широте станции, отбрасываются сразу.
+// Пересечения маски уточняются методом Брента, кульминация - золотым сечением
+class PassPredictor
+{
+public:
+	PassPredictor(const SatelliteCatalog& catalog, WorkStealingPool& pool,
+		const PassSettings& settings = PassSettings());
+
+	// Все объекты каталога, параллельно; результат отсортирован по AOS
+	std::vector<SatellitePass> predict(const GroundStation& station, double startJd, double days) const;
+	// Один объект
+	std::vector<SatellitePass> predict(const GroundStation& station, SatelliteCatalog::Slot slot,
+		double startJd, double days) const;
+
+	// Угол места и азимут (градусы) объекта в TEME на момент jd
+	static void lookAngles(const GroundStation& station, const glm::dvec3& temePosition, double jd,
+		double& elevation, double& azimuth);
+
+private:
+	void predictSlot(const GroundStation& station, SatelliteCatalog::Slot slot,
+		double startJd, double endJd, std::vector<SatellitePass>& passes) const;
+
+	const SatelliteCatalog& catalog;
+	WorkStealingPool& pool;
+	PassSettings settings;
+};
@@ -0,0 +1,100 @@
+#include "PropagationScheduler.h"
+
+#include <thread>
+#include <algorithm>
+
+const PositionFrame* PositionBuffer::acquire()
+{
+	if (published.load() == 0)
+		return nullptr;
+
+	// Если между чтением индекса и отметкой кадр успели сменить - повторяем
+	while (true) {
+		int index = front.load();
+		readers[index].fetch_add(1);
+		if (front.load() == index)
+			return &frames[index];
+		readers[index].fetch_sub(1);
+	}
+}
+
+void PositionBuffer::release(const PositionFrame* frame)
+{
+	if (frame)
+		readers[frame == &frames[0] ? 0 : 1].fetch_sub(1);
+}
+
+PositionFrame& PositionBuffer::beginWrite()
+{
+	int back = 1 - front.load();
+	// Читатель мог взять кадр до прошлой публикации - ждём, пока отпустит
+	while (readers[back].load() > 0)
+		std::this_thread::yield();
+	return frames[back];
+}
+
+void PositionBuffer::publish()
+{
+	front.store(1 - front.load());
+	published.fetch_add(1);
+}
+
+PropagationScheduler::PropagationScheduler(unsigned threadCount, size_t chunkSize)
+	: workers(threadCount), chunk(chunkSize)
+{
+}
+
+void PropagationScheduler::propagate(const Sgp4Batch& batch, const JulianDate& jd, uint64_t catalogVersion)
+{
+	auto startTime = std::chrono::steady_clock::now();
+
+	PositionFrame& frame = buffer.beginWrite();
+	size_t count = batch.size();
+	if (frame.catalogVersion != catalogVersion || frame.slots.size() != count) {
+		frame.slots = batch.slots();
+		frame.catalogVersion = catalogVersion;
+	}
+	frame.jd = jd;
+	frame.positions.resize(count * 3);
+	frame.error.resize(count);
+	scratch.resize(count);
+
+	workers.parallelFor(count, chunk, [&](size_t begin, size_t end, unsigned) {
+		batch.propagateRange(jd, begin, end, scratch);
+
+		// Перевод в float для отрисовки, пока кусок ещё в кэше
+		float* out = frame.positions.data() + begin * 3;
+		for (size_t i = begin; i < end; i++) {
+			*out++ = static_cast<float>(scratch.x[i]);
+			*out++ = static_cast<float>(scratch.y[i]);
+			*out++ = static_cast<float>(scratch.z[i]);
+			frame.error[i] = scratch.error[i];
+		}
+	});
+
+	buffer.publish();
+	lastRun = std::chrono::steady_clock::now() - startTime;
+}
+
+void PropagationScheduler::propagateSteps(const Sgp4Batch& batch, const std::vector<JulianDate>& jds,
+	std::vector<Sgp4Batch::States>& states)
+{
+	auto startTime = std::chrono::steady_clock::now();
+
+	size_t count = batch.size();
+	states.resize(jds.size());
+	for (auto& step : states)
+		step.resize(count);
+
+	// Общая нумерация кусков по всем шагам: кусок не пересекает границу шага
+	size_t chunksPerStep = (count + chunk - 1) / chunk;
+	workers.parallelFor(chunksPerStep * jds.size(), 1, [&](size_t begin, size_t end, unsigned) {
+		for (size_t id = begin; id < end; id++) {
+			size_t step = id / chunksPerStep;
+			size_t first = (id % chunksPerStep) * chunk;
+			batch.propagateRange(jds[step], first, std::min(count, first + chunk), states[step]);
+		}
+	});
+
+	lastRun = std::chrono::steady_clock::now() - startTime;
+}
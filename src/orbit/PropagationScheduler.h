@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+#include "Sgp4Batch.h"
+#include "WorkStealingPool.h"
+
+// Положения всего каталога на один момент времени
+struct PositionFrame {
+	JulianDate jd;
+	uint64_t catalogVersion = 0;
+	std::vector<SatelliteCatalog::Slot> slots;	// слот каталога для каждого объекта кадра
+	AlignedVector<float> positions;				// x, y, z подряд, км, TEME
+	AlignedVector<uint8_t> error;				// код Sgp4Error
+
+	size_t size() const { return slots.size(); }
+};
+
+// Двойной буфер кадров: поток распространения пишет задний кадр и
+// публикует его сменой индекса, поток отрисовки читает передний без блокировок.
+// Писатель не трогает кадр, пока его держит читатель
+class PositionBuffer
+{
+public:
+	// Поток отрисовки. nullptr - ещё ничего не опубликовано;
+	// полученный кадр нужно вернуть через release()
+	const PositionFrame* acquire();
+	void release(const PositionFrame* frame);
+
+	// Поток распространения
+	PositionFrame& beginWrite();
+	void publish();
+
+	uint64_t publishedCount() const { return published.load(); }
+
+private:
+	PositionFrame frames[2];
+	std::atomic<int> front{ 0 };
+	std::atomic<int> readers[2] = { {0}, {0} };
+	std::atomic<uint64_t> published{ 0 };
+};
+
+// Параллельное распространение пакета SGP4 по всем ядрам.
+// Пакет режется на куски, которые вместе с колонками коэффициентов и
+// результатами помещаются в L2, и раздаётся через WorkStealingPool
+class PropagationScheduler
+{
+public:
+	// 256 объектов - около 85 КБ коэффициентов и результатов на кусок
+	explicit PropagationScheduler(unsigned threadCount = 0, size_t chunkSize = 256);
+
+	// Считает положения на момент jd и публикует кадр в positions()
+	void propagate(const Sgp4Batch& batch, const JulianDate& jd, uint64_t catalogVersion);
+	// Несколько моментов за один проход пула (хвосты, прогнозы): states[k] - на jds[k]
+	void propagateSteps(const Sgp4Batch& batch, const std::vector<JulianDate>& jds,
+		std::vector<Sgp4Batch::States>& states);
+
+	PositionBuffer& positions() { return buffer; }
+	WorkStealingPool& pool() { return workers; }
+	size_t chunkSize() const { return chunk; }
+	std::chrono::duration<double> lastDuration() const { return lastRun; }
+
+private:
+	WorkStealingPool workers;
+	size_t chunk;
+	PositionBuffer buffer;
+	Sgp4Batch::States scratch;
+	std::chrono::duration<double> lastRun{ 0.0 };
+};
@@ -0,0 +1,822 @@
+#include "Sgp4.h"
+
+#include <cmath>
+
+// Имена переменных сохранены как в эталонной реализации Вальядо,
+// чтобы код можно было сверять построчно
+
+namespace {
+
+	const double pi = M_PI;
+	const double twopi = 2.0 * M_PI;
+	const double x2o3 = 2.0 / 3.0;
+	const double j3oj2 = Sgp4::j3 / Sgp4::j2;
+	// Минут в радиане суточного оборота: об/сут -> рад/мин
+	const double xpdotp = 1440.0 / (2.0 * M_PI);
+
+	// Лунно-солнечные периодические возмущения
+	void dpper(const Sgp4Record& rec, double t,
+		double& ep, double& inclp, double& nodep, double& argpp, double& mp)
+	{
+		const double zns = 1.19459e-5, zes = 0.01675, znl = 1.5835218e-4, zel = 0.05490;
+
+		// Солнечные члены
+		double zm = rec.zmos + zns * t;
+		double zf = zm + 2.0 * zes * std::sin(zm);
+		double sinzf = std::sin(zf);
+		double f2 = 0.5 * sinzf * sinzf - 0.25;
+		double f3 = -0.5 * sinzf * std::cos(zf);
+		double ses = rec.se2 * f2 + rec.se3 * f3;
+		double sis = rec.si2 * f2 + rec.si3 * f3;
+		double sls = rec.sl2 * f2 + rec.sl3 * f3 + rec.sl4 * sinzf;
+		double sghs = rec.sgh2 * f2 + rec.sgh3 * f3 + rec.sgh4 * sinzf;
+		double shs = rec.sh2 * f2 + rec.sh3 * f3;
+
+		// Лунные члены
+		zm = rec.zmol + znl * t;
+		zf = zm + 2.0 * zel * std::sin(zm);
+		sinzf = std::sin(zf);
+		f2 = 0.5 * sinzf * sinzf - 0.25;
+		f3 = -0.5 * sinzf * std::cos(zf);
+		double sel = rec.ee2 * f2 + rec.e3 * f3;
+		double sil = rec.xi2 * f2 + rec.xi3 * f3;
+		double sll = rec.xl2 * f2 + rec.xl3 * f3 + rec.xl4 * sinzf;
+		double sghl = rec.xgh2 * f2 + rec.xgh3 * f3 + rec.xgh4 * sinzf;
+		double shll = rec.xh2 * f2 + rec.xh3 * f3;
+
+		double pe = ses + sel - rec.peo;
+		double pinc = sis + sil - rec.pinco;
+		double pl = sls + sll - rec.plo;
+		double pgh = sghs + sghl - rec.pgho;
+		double ph = shs + shll - rec.pho;
+
+		inclp = inclp + pinc;
+		ep = ep + pe;
+		double sinip = std::sin(inclp);
+		double cosip = std::cos(inclp);
+
+		if (inclp >= 0.2) {
+			ph = ph / sinip;
+			pgh = pgh - cosip * ph;
+			argpp = argpp + pgh;
+			nodep = nodep + ph;
+			mp = mp + pl;
+		}
+		else {
+			// Малые наклонения - модификация Лиддейна
+			double sinop = std::sin(nodep);
+			double cosop = std::cos(nodep);
+			double alfdp = sinip * sinop;
+			double betdp = sinip * cosop;
+			double dalf = ph * cosop + pinc * cosip * sinop;
+			double dbet = -ph * sinop + pinc * cosip * cosop;
+			alfdp = alfdp + dalf;
+			betdp = betdp + dbet;
+			nodep = std::fmod(nodep, twopi);
+			double xls = mp + argpp + cosip * nodep;
+			double dls = pl + pgh - pinc * nodep * sinip;
+			xls = xls + dls;
+			xls = std::fmod(xls, twopi);
+			double xnoh = nodep;
+			nodep = std::atan2(alfdp, betdp);
+			if (std::fabs(xnoh - nodep) > pi) {
+				if (nodep < xnoh)
+					nodep = nodep + twopi;
+				else
+					nodep = nodep - twopi;
+			}
+			mp = mp + pl;
+			argpp = xls - mp - cosip * nodep;
+		}
+	}
+
+	// Промежуточные величины для лунно-солнечных членов (вызывается при инициализации)
+	struct DscomOut {
+		double snodm, cnodm, sinim, cosim, sinomm, cosomm, day, em, emsq, gam, rtemsq;
+		double s1, s2, s3, s4, s5, s6, s7, ss1, ss2, ss3, ss4, ss5, ss6, ss7;
+		double sz1, sz2, sz3, sz11, sz12, sz13, sz21, sz22, sz23, sz31, sz32, sz33;
+		double nm, z1, z2, z3, z11, z12, z13, z21, z22, z23, z31, z32, z33;
+	};
+
+	void dscom(double epoch, double ep, double argpp, double tc, double inclp, double nodep,
+		double np, Sgp4Record& rec, DscomOut& o)
+	{
+		const double zes = 0.01675, zel = 0.05490, c1ss = 2.9864797e-6, c1l = 4.7968065e-7,
+			zsinis = 0.39785416, zcosis = 0.91744867, zcosgs = 0.1945905, zsings = -0.98088458;
+
+		o.nm = np;
+		o.em = ep;
+		o.snodm = std::sin(nodep);
+		o.cnodm = std::cos(nodep);
+		o.sinomm = std::sin(argpp);
+		o.cosomm = std::cos(argpp);
+		o.sinim = std::sin(inclp);
+		o.cosim = std::cos(inclp);
+		o.emsq = o.em * o.em;
+		double betasq = 1.0 - o.emsq;
+		o.rtemsq = std::sqrt(betasq);
+
+		rec.peo = 0.0;
+		rec.pinco = 0.0;
+		rec.plo = 0.0;
+		rec.pgho = 0.0;
+		rec.pho = 0.0;
+		o.day = epoch + 18261.5 + tc / 1440.0;
+		double xnodce = std::fmod(4.5236020 - 9.2422029e-4 * o.day, twopi);
+		double stem = std::sin(xnodce);
+		double ctem = std::cos(xnodce);
+		double zcosil = 0.91375164 - 0.03568096 * ctem;
+		double zsinil = std::sqrt(1.0 - zcosil * zcosil);
+		double zsinhl = 0.089683511 * stem / zsinil;
+		double zcoshl = std::sqrt(1.0 - zsinhl * zsinhl);
+		o.gam = 5.8351514 + 0.0019443680 * o.day;
+		double zx = 0.39785416 * stem / zsinil;
+		double zy = zcoshl * ctem + 0.91744867 * zsinhl * stem;
+		zx = std::atan2(zx, zy);
+		zx = o.gam + zx - xnodce;
+		double zcosgl = std::cos(zx);
+		double zsingl = std::sin(zx);
+
+		// Первый проход - Солнце, второй - Луна
+		double zcosg = zcosgs;
+		double zsing = zsings;
+		double zcosi = zcosis;
+		double zsini = zsinis;
+		double zcosh = o.cnodm;
+		double zsinh = o.snodm;
+		double cc = c1ss;
+		double xnoi = 1.0 / o.nm;
+
+		for (int lsflg = 1; lsflg <= 2; lsflg++) {
+			double a1 = zcosg * zcosh + zsing * zcosi * zsinh;
+			double a3 = -zsing * zcosh + zcosg * zcosi * zsinh;
+			double a7 = -zcosg * zsinh + zsing * zcosi * zcosh;
+			double a8 = zsing * zsini;
+			double a9 = zsing * zsinh + zcosg * zcosi * zcosh;
+			double a10 = zcosg * zsini;
+			double a2 = o.cosim * a7 + o.sinim * a8;
+			double a4 = o.cosim * a9 + o.sinim * a10;
+			double a5 = -o.sinim * a7 + o.cosim * a8;
+			double a6 = -o.sinim * a9 + o.cosim * a10;
+
+			double x1 = a1 * o.cosomm + a2 * o.sinomm;
+			double x2 = a3 * o.cosomm + a4 * o.sinomm;
+			double x3 = -a1 * o.sinomm + a2 * o.cosomm;
+			double x4 = -a3 * o.sinomm + a4 * o.cosomm;
+			double x5 = a5 * o.sinomm;
+			double x6 = a6 * o.sinomm;
+			double x7 = a5 * o.cosomm;
+			double x8 = a6 * o.cosomm;
+
+			o.z31 = 12.0 * x1 * x1 - 3.0 * x3 * x3;
+			o.z32 = 24.0 * x1 * x2 - 6.0 * x3 * x4;
+			o.z33 = 12.0 * x2 * x2 - 3.0 * x4 * x4;
+			o.z1 = 3.0 * (a1 * a1 + a2 * a2) + o.z31 * o.emsq;
+			o.z2 = 6.0 * (a1 * a3 + a2 * a4) + o.z32 * o.emsq;
+			o.z3 = 3.0 * (a3 * a3 + a4 * a4) + o.z33 * o.emsq;
+			o.z11 = -6.0 * a1 * a5 + o.emsq * (-24.0 * x1 * x7 - 6.0 * x3 * x5);
+			o.z12 = -6.0 * (a1 * a6 + a3 * a5) + o.emsq *
+				(-24.0 * (x2 * x7 + x1 * x8) - 6.0 * (x3 * x6 + x4 * x5));
+			o.z13 = -6.0 * a3 * a6 + o.emsq * (-24.0 * x2 * x8 - 6.0 * x4 * x6);
+			o.z21 = 6.0 * a2 * a5 + o.emsq * (24.0 * x1 * x5 - 6.0 * x3 * x7);
+			o.z22 = 6.0 * (a4 * a5 + a2 * a6) + o.emsq *
+				(24.0 * (x2 * x5 + x1 * x6) - 6.0 * (x4 * x7 + x3 * x8));
+			o.z23 = 6.0 * a4 * a6 + o.emsq * (24.0 * x2 * x6 - 6.0 * x4 * x8);
+			o.z1 = o.z1 + o.z1 + betasq * o.z31;
+			o.z2 = o.z2 + o.z2 + betasq * o.z32;
+			o.z3 = o.z3 + o.z3 + betasq * o.z33;
+			o.s3 = cc * xnoi;
+			o.s2 = -0.5 * o.s3 / o.rtemsq;
+			o.s4 = o.s3 * o.rtemsq;
+			o.s1 = -15.0 * o.em * o.s4;
+			o.s5 = x1 * x3 + x2 * x4;
+			o.s6 = x2 * x3 + x1 * x4;
+			o.s7 = x2 * x4 - x1 * x3;
+
+			if (lsflg == 1) {
+				o.ss1 = o.s1;
+				o.ss2 = o.s2;
+				o.ss3 = o.s3;
+				o.ss4 = o.s4;
+				o.ss5 = o.s5;
+				o.ss6 = o.s6;
+				o.ss7 = o.s7;
+				o.sz1 = o.z1;
+				o.sz2 = o.z2;
+				o.sz3 = o.z3;
+				o.sz11 = o.z11;
+				o.sz12 = o.z12;
+				o.sz13 = o.z13;
+				o.sz21 = o.z21;
+				o.sz22 = o.z22;
+				o.sz23 = o.z23;
+				o.sz31 = o.z31;
+				o.sz32 = o.z32;
+				o.sz33 = o.z33;
+				zcosg = zcosgl;
+				zsing = zsingl;
+				zcosi = zcosil;
+				zsini = zsinil;
+				zcosh = zcoshl * o.cnodm + zsinhl * o.snodm;
+				zsinh = o.snodm * zcoshl - o.cnodm * zsinhl;
+				cc = c1l;
+			}
+		}
+
+		rec.zmol = std::fmod(4.7199672 + 0.22997150 * o.day - o.gam, twopi);
+		rec.zmos = std::fmod(6.2565837 + 0.017201977 * o.day, twopi);
+
+		// Солнечные коэффициенты
+		rec.se2 = 2.0 * o.ss1 * o.ss6;
+		rec.se3 = 2.0 * o.ss1 * o.ss7;
+		rec.si2 = 2.0 * o.ss2 * o.sz12;
+		rec.si3 = 2.0 * o.ss2 * (o.sz13 - o.sz11);
+		rec.sl2 = -2.0 * o.ss3 * o.sz2;
+		rec.sl3 = -2.0 * o.ss3 * (o.sz3 - o.sz1);
+		rec.sl4 = -2.0 * o.ss3 * (-21.0 - 9.0 * o.emsq) * zes;
+		rec.sgh2 = 2.0 * o.ss4 * o.sz32;
+		rec.sgh3 = 2.0 * o.ss4 * (o.sz33 - o.sz31);
+		rec.sgh4 = -18.0 * o.ss4 * zes;
+		rec.sh2 = -2.0 * o.ss2 * o.sz22;
+		rec.sh3 = -2.0 * o.ss2 * (o.sz23 - o.sz21);
+
+		// Лунные коэффициенты
+		rec.ee2 = 2.0 * o.s1 * o.s6;
+		rec.e3 = 2.0 * o.s1 * o.s7;
+		rec.xi2 = 2.0 * o.s2 * o.z12;
+		rec.xi3 = 2.0 * o.s2 * (o.z13 - o.z11);
+		rec.xl2 = -2.0 * o.s3 * o.z2;
+		rec.xl3 = -2.0 * o.s3 * (o.z3 - o.z1);
+		rec.xl4 = -2.0 * o.s3 * (-21.0 - 9.0 * o.emsq) * zel;
+		rec.xgh2 = 2.0 * o.s4 * o.z32;
+		rec.xgh3 = 2.0 * o.s4 * (o.z33 - o.z31);
+		rec.xgh4 = -18.0 * o.s4 * zel;
+		rec.xh2 = -2.0 * o.s2 * o.z22;
+		rec.xh3 = -2.0 * o.s2 * (o.z23 - o.z21);
+	}
+
+	// Вековые и резонансные члены глубокого космоса
+	void dsinit(const DscomOut& o, double eccsq, double xpidot, Sgp4Record& rec)
+	{
+		const double q22 = 1.7891679e-6, q31 = 2.1460748e-6, q33 = 2.2123015e-7,
+			root22 = 1.7891679e-6, root44 = 7.3636953e-9, root54 = 2.1765803e-9,
+			rptim = 4.37526908801129966e-3, root32 = 3.7393792e-7, root52 = 1.1428639e-7,
+			znl = 1.5835218e-4, zns = 1.19459e-5;
+
+		double nm = o.nm;
+		double em = o.em;
+		double emsq = o.emsq;
+		double inclm = rec.inclo;
+		double cosim = o.cosim;
+		double sinim = o.sinim;
+
+		rec.irez = 0;
+		if (nm < 0.0052359877 && nm > 0.0034906585)
+			rec.irez = 1;
+		if (nm >= 8.26e-3 && nm <= 9.24e-3 && em >= 0.5)
+			rec.irez = 2;
+
+		// Солнечные члены
+		double ses = o.ss1 * zns * o.ss5;
+		double sis = o.ss2 * zns * (o.sz11 + o.sz13);
+		double sls = -zns * o.ss3 * (o.sz1 + o.sz3 - 14.0 - 6.0 * emsq);
+		double sghs = o.ss4 * zns * (o.sz31 + o.sz33 - 6.0);
+		double shs = -zns * o.ss2 * (o.sz21 + o.sz23);
+		if (inclm < 5.2359877e-2 || inclm > pi - 5.2359877e-2)
+			shs = 0.0;
+		if (sinim != 0.0)
+			shs = shs / sinim;
+		double sgs = sghs - cosim * shs;
+
+		// Лунные члены
+		rec.dedt = ses + o.s1 * znl * o.s5;
+		rec.didt = sis + o.s2 * znl * (o.z11 + o.z13);
+		rec.dmdt = sls - znl * o.s3 * (o.z1 + o.z3 - 14.0 - 6.0 * emsq);
+		double sghl = o.s4 * znl * (o.z31 + o.z33 - 6.0);
+		double shll = -znl * o.s2 * (o.z21 + o.z23);
+		if (inclm < 5.2359877e-2 || inclm > pi - 5.2359877e-2)
+			shll = 0.0;
+		rec.domdt = sgs + sghl;
+		rec.dnodt = shs;
+		if (sinim != 0.0) {
+			rec.domdt = rec.domdt - cosim / sinim * shll;
+			rec.dnodt = rec.dnodt + shll / sinim;
+		}
+
+		double theta = std::fmod(rec.gsto, twopi);
+		if (rec.irez == 0)
+			return;
+
+		double aonv = std::pow(nm / Sgp4::xke(), x2o3);
+
+		// Резонанс 12-часовых орбит
+		if (rec.irez == 2) {
+			double cosisq = cosim * cosim;
+			em = rec.ecco;
+			emsq = eccsq;
+			double eoc = em * emsq;
+			double g201 = -0.306 - (em - 0.64) * 0.440;
+			double g211, g310, g322, g410, g422, g520, g521, g532, g533;
+
+			if (em <= 0.65) {
+				g211 = 3.616 - 13.2470 * em + 16.2900 * emsq;
+				g310 = -19.302 + 117.3900 * em - 228.4190 * emsq + 156.5910 * eoc;
+				g322 = -18.9068 + 109.7927 * em - 214.6334 * emsq + 146.5816 * eoc;
+				g410 = -41.122 + 242.6940 * em - 471.0940 * emsq + 313.9530 * eoc;
+				g422 = -146.407 + 841.8800 * em - 1629.014 * emsq + 1083.4350 * eoc;
+				g520 = -532.114 + 3017.977 * em - 5740.032 * emsq + 3708.2760 * eoc;
+			}
+			else {
+				g211 = -72.099 + 331.819 * em - 508.738 * emsq + 266.724 * eoc;
+				g310 = -346.844 + 1582.851 * em - 2415.925 * emsq + 1246.113 * eoc;
+				g322 = -342.585 + 1554.908 * em - 2366.899 * emsq + 1215.972 * eoc;
+				g410 = -1052.797 + 4758.686 * em - 7193.992 * emsq + 3651.957 * eoc;
+				g422 = -3581.690 + 16178.110 * em - 24462.770 * emsq + 12422.520 * eoc;
+				if (em > 0.715)
+					g520 = -5149.66 + 29936.92 * em - 54087.36 * emsq + 31324.56 * eoc;
+				else
+					g520 = 1464.74 - 4664.75 * em + 3763.64 * emsq;
+			}
+			if (em < 0.7) {
+				g533 = -919.22770 + 4988.6100 * em - 9064.7700 * emsq + 5542.21 * eoc;
+				g521 = -822.71072 + 4568.6173 * em - 8491.4146 * emsq + 5337.524 * eoc;
+				g532 = -853.66600 + 4690.2500 * em - 8624.7700 * emsq + 5341.4 * eoc;
+			}
+			else {
+				g533 = -37995.780 + 161616.52 * em - 229838.20 * emsq + 109377.94 * eoc;
+				g521 = -51752.104 + 218913.95 * em - 309468.16 * emsq + 146349.42 * eoc;
+				g532 = -40023.880 + 170470.89 * em - 242699.48 * emsq + 115605.82 * eoc;
+			}
+
+			double sini2 = sinim * sinim;
+			double f220 = 0.75 * (1.0 + 2.0 * cosim + cosisq);
+			double f221 = 1.5 * sini2;
+			double f321 = 1.875 * sinim * (1.0 - 2.0 * cosim - 3.0 * cosisq);
+			double f322 = -1.875 * sinim * (1.0 + 2.0 * cosim - 3.0 * cosisq);
+			double f441 = 35.0 * sini2 * f220;
+			double f442 = 39.3750 * sini2 * sini2;
+			double f522 = 9.84375 * sinim * (sini2 * (1.0 - 2.0 * cosim - 5.0 * cosisq) +
+				0.33333333 * (-2.0 + 4.0 * cosim + 6.0 * cosisq));
+			double f523 = sinim * (4.92187512 * sini2 * (-2.0 - 4.0 * cosim +
+				10.0 * cosisq) + 6.56250012 * (1.0 + 2.0 * cosim - 3.0 * cosisq));
+			double f542 = 29.53125 * sinim * (2.0 - 8.0 * cosim + cosisq *
+				(-12.0 + 8.0 * cosim + 10.0 * cosisq));
+			double f543 = 29.53125 * sinim * (-2.0 - 8.0 * cosim + cosisq *
+				(12.0 + 8.0 * cosim - 10.0 * cosisq));
+			double xno2 = nm * nm;
+			double ainv2 = aonv * aonv;
+			double temp1 = 3.0 * xno2 * ainv2;
+			double temp = temp1 * root22;
+			rec.d2201 = temp * f220 * g201;
+			rec.d2211 = temp * f221 * g211;
+			temp1 = temp1 * aonv;
+			temp = temp1 * root32;
+			rec.d3210 = temp * f321 * g310;
+			rec.d3222 = temp * f322 * g322;
+			temp1 = temp1 * aonv;
+			temp = 2.0 * temp1 * root44;
+			rec.d4410 = temp * f441 * g410;
+			rec.d4422 = temp * f442 * g422;
+			temp1 = temp1 * aonv;
+			temp = temp1 * root52;
+			rec.d5220 = temp * f522 * g520;
+			rec.d5232 = temp * f523 * g532;
+			temp = 2.0 * temp1 * root54;
+			rec.d5421 = temp * f542 * g521;
+			rec.d5433 = temp * f543 * g533;
+			rec.xlamo = std::fmod(rec.mo + rec.nodeo + rec.nodeo - theta - theta, twopi);
+			rec.xfact = rec.mdot + rec.dmdt + 2.0 * (rec.nodedot + rec.dnodt - rptim) - rec.noUnkozai;
+		}
+
+		// Синхронный (суточный) резонанс
+		if (rec.irez == 1) {
+			double g200 = 1.0 + emsq * (-2.5 + 0.8125 * emsq);
+			double g310 = 1.0 + 2.0 * emsq;
+			double g300 = 1.0 + emsq * (-6.0 + 6.60937 * emsq);
+			double f220 = 0.75 * (1.0 + cosim) * (1.0 + cosim);
+			double f311 = 0.9375 * sinim * sinim * (1.0 + 3.0 * cosim) - 0.75 * (1.0 + cosim);
+			double f330 = 1.0 + cosim;
+			f330 = 1.875 * f330 * f330 * f330;
+			rec.del1 = 3.0 * nm * nm * aonv * aonv;
+			rec.del2 = 2.0 * rec.del1 * f220 * g200 * q22;
+			rec.del3 = 3.0 * rec.del1 * f330 * g300 * q33 * aonv;
+			rec.del1 = rec.del1 * f311 * g310 * q31 * aonv;
+			rec.xlamo = std::fmod(rec.mo + rec.nodeo + rec.argpo - theta, twopi);
+			rec.xfact = rec.mdot + xpidot - rptim + rec.dmdt + rec.domdt + rec.dnodt - rec.noUnkozai;
+		}
+	}
+
+	// Вековые члены глубокого космоса и численное интегрирование резонансов.
+	// Интегратор каждый раз стартует с эпохи: шаги кратны 720 мин,
+	// поэтому результат совпадает с продолжением с сохранённого шага
+	void dspace(const Sgp4Record& rec, double t,
+		double& em, double& argpm, double& inclm, double& mm, double& nodem, double& nm)
+	{
+		const double fasx2 = 0.13130908, fasx4 = 2.8843198, fasx6 = 0.37448087,
+			g22 = 5.7686396, g32 = 0.95240898, g44 = 1.8014998, g52 = 1.0508330, g54 = 4.4108898,
+			rptim = 4.37526908801129966e-3, stepp = 720.0, stepn = -720.0, step2 = 259200.0;
+
+		double theta = std::fmod(rec.gsto + t * rptim, twopi);
+		em = em + rec.dedt * t;
+		inclm = inclm + rec.didt * t;
+		argpm = argpm + rec.domdt * t;
+		nodem = nodem + rec.dnodt * t;
+		mm = mm + rec.dmdt * t;
+
+		if (rec.irez == 0)
+			return;
+
+		double atime = 0.0;
+		double xni = rec.noUnkozai;
+		double xli = rec.xlamo;
+		double delt = t > 0.0 ? stepp : stepn;
+		double ft = 0.0, xndt = 0.0, xldot = 0.0, xnddt = 0.0;
+
+		while (true) {
+			if (rec.irez != 2) {
+				// Околосинхронный резонанс
+				xndt = rec.del1 * std::sin(xli - fasx2) + rec.del2 * std::sin(2.0 * (xli - fasx4)) +
+					rec.del3 * std::sin(3.0 * (xli - fasx6));
+				xldot = xni + rec.xfact;
+				xnddt = rec.del1 * std::cos(xli - fasx2) +
+					2.0 * rec.del2 * std::cos(2.0 * (xli - fasx4)) +
+					3.0 * rec.del3 * std::cos(3.0 * (xli - fasx6));
+				xnddt = xnddt * xldot;
+			}
+			else {
+				// Резонанс полусуточных орбит
+				double xomi = rec.argpo + rec.argpdot * atime;
+				double x2omi = xomi + xomi;
+				double x2li = xli + xli;
+				xndt = rec.d2201 * std::sin(x2omi + xli - g22) + rec.d2211 * std::sin(xli - g22) +
+					rec.d3210 * std::sin(xomi + xli - g32) + rec.d3222 * std::sin(-xomi + xli - g32) +
+					rec.d4410 * std::sin(x2omi + x2li - g44) + rec.d4422 * std::sin(x2li - g44) +
+					rec.d5220 * std::sin(xomi + xli - g52) + rec.d5232 * std::sin(-xomi + xli - g52) +
+					rec.d5421 * std::sin(xomi + x2li - g54) + rec.d5433 * std::sin(-xomi + x2li - g54);
+				xldot = xni + rec.xfact;
+				xnddt = rec.d2201 * std::cos(x2omi + xli - g22) + rec.d2211 * std::cos(xli - g22) +
+					rec.d3210 * std::cos(xomi + xli - g32) + rec.d3222 * std::cos(-xomi + xli - g32) +
+					rec.d5220 * std::cos(xomi + xli - g52) + rec.d5232 * std::cos(-xomi + xli - g52) +
+					2.0 * (rec.d4410 * std::cos(x2omi + x2li - g44) +
+						rec.d4422 * std::cos(x2li - g44) + rec.d5421 * std::cos(xomi + x2li - g54) +
+						rec.d5433 * std::cos(-xomi + x2li - g54));
+				xnddt = xnddt * xldot;
+			}
+
+			if (std::fabs(t - atime) < stepp) {
+				ft = t - atime;
+				break;
+			}
+
+			xli = xli + xldot * delt + xndt * step2;
+			xni = xni + xndt * delt + xnddt * step2;
+			atime = atime + delt;
+		}
+
+		nm = xni + xndt * ft + xnddt * ft * ft * 0.5;
+		double xl = xli + xldot * ft + xndt * ft * ft * 0.5;
+		if (rec.irez != 1)
+			mm = xl - 2.0 * nodem + 2.0 * theta;
+		else
+			mm = xl - nodem - argpm + theta;
+	}
+
+}
+
+double Sgp4::xke()
+{
+	// sqrt(mu) в единицах радиус Земли^1.5 / мин
+	static const double value = 60.0 / std::sqrt(earthRadiusKm * earthRadiusKm * earthRadiusKm / mu);
+	return value;
+}
+
+double Sgp4::gmst(double jdUt1)
+{
+	double tut1 = (jdUt1 - 2451545.0) / 36525.0;
+	double temp = -6.2e-6 * tut1 * tut1 * tut1 + 0.093104 * tut1 * tut1 +
+		(876600.0 * 3600.0 + 8640184.812866) * tut1 + 67310.54841; // секунды
+	temp = std::fmod(temp * (pi / 180.0) / 240.0, twopi);
+	if (temp < 0.0)
+		temp += twopi;
+	return temp;
+}
+
+Sgp4Error Sgp4::initialize(const TleElements& elements, Sgp4Record& record)
+{
+	Sgp4Record& rec = record;
+	rec = Sgp4Record{};
+
+	// Единицы TLE -> единицы модели
+	rec.epoch = elements.epoch;
+	rec.bstar = elements.bstar;
+	rec.ecco = elements.eccentricity;
+	rec.argpo = elements.argPerigee;
+	rec.inclo = elements.inclination;
+	rec.mo = elements.meanAnomaly;
+	rec.nodeo = elements.raan;
+	rec.noKozai = elements.meanMotion / xpdotp;
+
+	const double xke = Sgp4::xke();
+	const double ss = 78.0 / earthRadiusKm + 1.0;
+	const double qzms2ttemp = (120.0 - 78.0) / earthRadiusKm;
+	const double qzms2t = qzms2ttemp * qzms2ttemp * qzms2ttemp * qzms2ttemp;
+	const double temp4 = 1.5e-12;
+	// Дни от 1949-12-31 0h
+	const double epoch = (rec.epoch.day - 2433281.5) + rec.epoch.fraction;
+
+	// initl: вспомогательные величины эпохи и восстановление среднего движения
+	double eccsq = rec.ecco * rec.ecco;
+	double omeosq = 1.0 - eccsq;
+	double rteosq = std::sqrt(omeosq);
+	double cosio = std::cos(rec.inclo);
+	double cosio2 = cosio * cosio;
+
+	double ak = std::pow(xke / rec.noKozai, x2o3);
+	double d1 = 0.75 * j2 * (3.0 * cosio2 - 1.0) / (rteosq * omeosq);
+	double del = d1 / (ak * ak);
+	double adel = ak * (1.0 - del * del - del * (1.0 / 3.0 + 134.0 * del * del / 81.0));
+	del = d1 / (adel * adel);
+	rec.noUnkozai = rec.noKozai / (1.0 + del);
+
+	double ao = std::pow(xke / rec.noUnkozai, x2o3);
+	double sinio = std::sin(rec.inclo);
+	double po = ao * omeosq;
+	double con42 = 1.0 - 5.0 * cosio2;
+	rec.con41 = -con42 - cosio2 - cosio2;
+	double posq = po * po;
+	double rp = ao * (1.0 - rec.ecco);
+	rec.gsto = gmst(epoch + 2433281.5);
+
+	if (omeosq >= 0.0 || rec.noUnkozai >= 0.0) {
+		rec.isimp = rp < (220.0 / earthRadiusKm + 1.0);
+		double sfour = ss;
+		double qzms24 = qzms2t;
+		double perige = (rp - 1.0) * earthRadiusKm;
+
+		// Для перигея ниже 156 км параметры атмосферы меняются
+		if (perige < 156.0) {
+			sfour = perige - 78.0;
+			if (perige < 98.0)
+				sfour = 20.0;
+			double qzms24temp = (120.0 - sfour) / earthRadiusKm;
+			qzms24 = qzms24temp * qzms24temp * qzms24temp * qzms24temp;
+			sfour = sfour / earthRadiusKm + 1.0;
+		}
+		double pinvsq = 1.0 / posq;
+
+		double tsi = 1.0 / (ao - sfour);
+		rec.eta = ao * rec.ecco * tsi;
+		double etasq = rec.eta * rec.eta;
+		double eeta = rec.ecco * rec.eta;
+		double psisq = std::fabs(1.0 - etasq);
+		double coef = qzms24 * std::pow(tsi, 4.0);
+		double coef1 = coef / std::pow(psisq, 3.5);
+		double cc2 = coef1 * rec.noUnkozai * (ao * (1.0 + 1.5 * etasq + eeta *
+			(4.0 + etasq)) + 0.375 * j2 * tsi / psisq * rec.con41 *
+			(8.0 + 3.0 * etasq * (8.0 + etasq)));
+		rec.cc1 = rec.bstar * cc2;
+		double cc3 = 0.0;
+		if (rec.ecco > 1.0e-4)
+			cc3 = -2.0 * coef * tsi * j3oj2 * rec.noUnkozai * sinio / rec.ecco;
+		rec.x1mth2 = 1.0 - cosio2;
+		rec.cc4 = 2.0 * rec.noUnkozai * coef1 * ao * omeosq *
+			(rec.eta * (2.0 + 0.5 * etasq) + rec.ecco *
+			(0.5 + 2.0 * etasq) - j2 * tsi / (ao * psisq) *
+			(-3.0 * rec.con41 * (1.0 - 2.0 * eeta + etasq *
+			(1.5 - 0.5 * eeta)) + 0.75 * rec.x1mth2 *
+			(2.0 * etasq - eeta * (1.0 + etasq)) * std::cos(2.0 * rec.argpo)));
+		rec.cc5 = 2.0 * coef1 * ao * omeosq * (1.0 + 2.75 *
+			(etasq + eeta) + eeta * etasq);
+		double cosio4 = cosio2 * cosio2;
+		double temp1 = 1.5 * j2 * pinvsq * rec.noUnkozai;
+		double temp2 = 0.5 * temp1 * j2 * pinvsq;
+		double temp3 = -0.46875 * j4 * pinvsq * pinvsq * rec.noUnkozai;
+		rec.mdot = rec.noUnkozai + 0.5 * temp1 * rteosq * rec.con41 + 0.0625 *
+			temp2 * rteosq * (13.0 - 78.0 * cosio2 + 137.0 * cosio4);
+		rec.argpdot = -0.5 * temp1 * con42 + 0.0625 * temp2 *
+			(7.0 - 114.0 * cosio2 + 395.0 * cosio4) +
+			temp3 * (3.0 - 36.0 * cosio2 + 49.0 * cosio4);
+		double xhdot1 = -temp1 * cosio;
+		rec.nodedot = xhdot1 + (0.5 * temp2 * (4.0 - 19.0 * cosio2) +
+			2.0 * temp3 * (3.0 - 7.0 * cosio2)) * cosio;
+		double xpidot = rec.argpdot + rec.nodedot;
+		rec.omgcof = rec.bstar * cc3 * std::cos(rec.argpo);
+		rec.xmcof = 0.0;
+		if (rec.ecco > 1.0e-4)
+			rec.xmcof = -x2o3 * coef * rec.bstar / eeta;
+		rec.nodecf = 3.5 * omeosq * xhdot1 * rec.cc1;
+		rec.t2cof = 1.5 * rec.cc1;
+		// Наклонение 180 градусов - защита от деления на ноль
+		if (std::fabs(cosio + 1.0) > 1.5e-12)
+			rec.xlcof = -0.25 * j3oj2 * sinio * (3.0 + 5.0 * cosio) / (1.0 + cosio);
+		else
+			rec.xlcof = -0.25 * j3oj2 * sinio * (3.0 + 5.0 * cosio) / temp4;
+		rec.aycof = -0.5 * j3oj2 * sinio;
+		double delmotemp = 1.0 + rec.eta * std::cos(rec.mo);
+		rec.delmo = delmotemp * delmotemp * delmotemp;
+		rec.sinmao = std::sin(rec.mo);
+		rec.x7thm1 = 7.0 * cosio2 - 1.0;
+
+		// Период больше 225 минут - модель глубокого космоса (SDP4)
+		if ((2.0 * pi / rec.noUnkozai) >= 225.0) {
+			rec.deepSpace = true;
+			rec.isimp = true;
+
+			DscomOut o{};
+			dscom(epoch, rec.ecco, rec.argpo, 0.0, rec.inclo, rec.nodeo, rec.noUnkozai, rec, o);
+			dsinit(o, eccsq, xpidot, rec);
+		}
+
+		if (!rec.isimp) {
+			double cc1sq = rec.cc1 * rec.cc1;
+			rec.d2 = 4.0 * ao * tsi * cc1sq;
+			double temp = rec.d2 * tsi * rec.cc1 / 3.0;
+			rec.d3 = (17.0 * ao + sfour) * temp;
+			rec.d4 = 0.5 * temp * ao * tsi * (221.0 * ao + 31.0 * sfour) * rec.cc1;
+			rec.t3cof = rec.d2 + 2.0 * cc1sq;
+			rec.t4cof = 0.25 * (3.0 * rec.d3 + rec.cc1 * (12.0 * rec.d2 + 10.0 * cc1sq));
+			rec.t5cof = 0.2 * (3.0 * rec.d4 + 12.0 * rec.cc1 * rec.d3 +
+				6.0 * rec.d2 * rec.d2 + 15.0 * cc1sq * (2.0 * rec.d2 + cc1sq));
+		}
+	}
+
+	// Проверка записи распространением на эпоху
+	glm::dvec3 position, velocity;
+	return propagate(rec, 0.0, position, velocity);
+}
+
+Sgp4Error Sgp4::propagate(const Sgp4Record& rec, double t, glm::dvec3& position, glm::dvec3& velocity)
+{
+	const double xke = Sgp4::xke();
+	const double temp4 = 1.5e-12;
+	const double vkmpersec = earthRadiusKm * xke / 60.0;
+
+	// Вековые возмущения от гравитации и торможения
+	double xmdf = rec.mo + rec.mdot * t;
+	double argpdf = rec.argpo + rec.argpdot * t;
+	double nodedf = rec.nodeo + rec.nodedot * t;
+	double argpm = argpdf;
+	double mm = xmdf;
+	double t2 = t * t;
+	double nodem = nodedf + rec.nodecf * t2;
+	double tempa = 1.0 - rec.cc1 * t;
+	double tempe = rec.bstar * rec.cc4 * t;
+	double templ = rec.t2cof * t2;
+
+	if (!rec.isimp) {
+		double delomg = rec.omgcof * t;
+		double delmtemp = 1.0 + rec.eta * std::cos(xmdf);
+		double delm = rec.xmcof * (delmtemp * delmtemp * delmtemp - rec.delmo);
+		double temp = delomg + delm;
+		mm = xmdf + temp;
+		argpm = argpdf - temp;
+		double t3 = t2 * t;
+		double t4 = t3 * t;
+		tempa = tempa - rec.d2 * t2 - rec.d3 * t3 - rec.d4 * t4;
+		tempe = tempe + rec.bstar * rec.cc5 * (std::sin(mm) - rec.sinmao);
+		templ = templ + rec.t3cof * t3 + t4 * (rec.t4cof + t * rec.t5cof);
+	}
+
+	double nm = rec.noUnkozai;
+	double em = rec.ecco;
+	double inclm = rec.inclo;
+	if (rec.deepSpace)
+		dspace(rec, t, em, argpm, inclm, mm, nodem, nm);
+
+	if (nm <= 0.0)
+		return Sgp4Error::MeanMotion;
+
+	double am = std::pow(xke / nm, x2o3) * tempa * tempa;
+	nm = xke / std::pow(am, 1.5);
+	em = em - tempe;
+
+	if (em >= 1.0 || em < -0.001)
+		return Sgp4Error::MeanEccentricity;
+	if (em < 1.0e-6)
+		em = 1.0e-6;
+
+	mm = mm + rec.noUnkozai * templ;
+	double xlm = mm + argpm + nodem;
+
+	nodem = std::fmod(nodem, twopi);
+	argpm = std::fmod(argpm, twopi);
+	xlm = std::fmod(xlm, twopi);
+	mm = std::fmod(xlm - argpm - nodem, twopi);
+
+	double sinim = std::sin(inclm);
+	double cosim = std::cos(inclm);
+
+	// Лунно-солнечные периодические члены
+	double ep = em;
+	double xincp = inclm;
+	double argpp = argpm;
+	double nodep = nodem;
+	double mp = mm;
+	double sinip = sinim;
+	double cosip = cosim;
+	double aycof = rec.aycof;
+	double xlcof = rec.xlcof;
+	double con41 = rec.con41;
+	double x1mth2 = rec.x1mth2;
+	double x7thm1 = rec.x7thm1;
+
+	if (rec.deepSpace) {
+		dpper(rec, t, ep, xincp, nodep, argpp, mp);
+		if (xincp < 0.0) {
+			xincp = -xincp;
+			nodep = nodep + pi;
+			argpp = argpp - pi;
+		}
+		if (ep < 0.0 || ep > 1.0)
+			return Sgp4Error::PerturbedEccentricity;
+
+		// Долгопериодические коэффициенты зависят от возмущённого наклонения
+		sinip = std::sin(xincp);
+		cosip = std::cos(xincp);
+		aycof = -0.5 * j3oj2 * sinip;
+		if (std::fabs(cosip + 1.0) > 1.5e-12)
+			xlcof = -0.25 * j3oj2 * sinip * (3.0 + 5.0 * cosip) / (1.0 + cosip);
+		else
+			xlcof = -0.25 * j3oj2 * sinip * (3.0 + 5.0 * cosip) / temp4;
+	}
+
+	// Долгопериодические члены
+	double axnl = ep * std::cos(argpp);
+	double temp = 1.0 / (am * (1.0 - ep * ep));
+	double aynl = ep * std::sin(argpp) + temp * aycof;
+	double xl = mp + argpp + nodep + temp * xlcof * axnl;
+
+	// Уравнение Кеплера
+	double u = std::fmod(xl - nodep, twopi);
+	double eo1 = u;
+	double tem5 = 9999.9;
+	double sineo1 = 0.0, coseo1 = 0.0;
+	for (int ktr = 1; std::fabs(tem5) >= 1.0e-12 && ktr <= 10; ktr++) {
+		sineo1 = std::sin(eo1);
+		coseo1 = std::cos(eo1);
+		tem5 = 1.0 - coseo1 * axnl - sineo1 * aynl;
+		tem5 = (u - aynl * coseo1 + axnl * sineo1 - eo1) / tem5;
+		if (std::fabs(tem5) >= 0.95)
+			tem5 = tem5 > 0.0 ? 0.95 : -0.95;
+		eo1 = eo1 + tem5;
+	}
+
+	// Короткопериодические члены
+	double ecose = axnl * coseo1 + aynl * sineo1;
+	double esine = axnl * sineo1 - aynl * coseo1;
+	double el2 = axnl * axnl + aynl * aynl;
+	double pl = am * (1.0 - el2);
+	if (pl < 0.0)
+		return Sgp4Error::SemiLatusRectum;
+
+	double rl = am * (1.0 - ecose);
+	double rdotl = std::sqrt(am) * esine / rl;
+	double rvdotl = std::sqrt(pl) / rl;
+	double betal = std::sqrt(1.0 - el2);
+	temp = esine / (1.0 + betal);
+	double sinu = am / rl * (sineo1 - aynl - axnl * temp);
+	double cosu = am / rl * (coseo1 - axnl + aynl * temp);
+	double su = std::atan2(sinu, cosu);
+	double sin2u = (cosu + cosu) * sinu;
+	double cos2u = 1.0 - 2.0 * sinu * sinu;
+	temp = 1.0 / pl;
+	double temp1 = 0.5 * j2 * temp;
+	double temp2 = temp1 * temp;
+
+	if (rec.deepSpace) {
+		double cosisq = cosip * cosip;
+		con41 = 3.0 * cosisq - 1.0;
+		x1mth2 = 1.0 - cosisq;
+		x7thm1 = 7.0 * cosisq - 1.0;
+	}
+	double mrt = rl * (1.0 - 1.5 * temp2 * betal * con41) + 0.5 * temp1 * x1mth2 * cos2u;
+	su = su - 0.25 * temp2 * x7thm1 * sin2u;
+	double xnode = nodep + 1.5 * temp2 * cosip * sin2u;
+	double xinc = xincp + 1.5 * temp2 * cosip * sinip * cos2u;
+	double mvt = rdotl - nm * temp1 * x1mth2 * sin2u / xke;
+	double rvdot = rvdotl + nm * temp1 * (x1mth2 * cos2u + 1.5 * con41) / xke;
+
+	// Ориентация орбиты
+	double sinsu = std::sin(su);
+	double cossu = std::cos(su);
+	double snod = std::sin(xnode);
+	double cnod = std::cos(xnode);
+	double sini = std::sin(xinc);
+	double cosi = std::cos(xinc);
+	double xmx = -snod * cosi;
+	double xmy = cnod * cosi;
+	double ux = xmx * sinsu + cnod * cossu;
+	double uy = xmy * sinsu + snod * cossu;
+	double uz = sini * sinsu;
+	double vx = xmx * cossu - cnod * sinsu;
+	double vy = xmy * cossu - snod * sinsu;
+	double vz = sini * cossu;
+
+	position = glm::dvec3(mrt * ux, mrt * uy, mrt * uz) * earthRadiusKm;
+	velocity = glm::dvec3(mvt * ux + rvdot * vx, mvt * uy + rvdot * vy, mvt * uz + rvdot * vz) * vkmpersec;
+
+	if (mrt < 1.0)
+		return Sgp4Error::Decayed;
+
+	return Sgp4Error::None;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "../data/TleParser.h"
+#include "../time/JulianDate.h"
+
+// Ошибки распространения (коды совпадают с реализацией Вальядо)
+enum class Sgp4Error {
+	None = 0,
+	MeanEccentricity = 1,		// средний эксцентриситет вне [0, 1)
+	MeanMotion = 2,				// отрицательное среднее движение
+	PerturbedEccentricity = 3,	// эксцентриситет после возмущений вне [0, 1]
+	SemiLatusRectum = 4,		// отрицательный фокальный параметр
+	Decayed = 6					// спутник ниже поверхности Земли
+};
+
+// Предвычисленные коэффициенты SGP4/SDP4 для одного TLE.
+// Заполняется один раз в Sgp4::initialize(), дальше только читается
+struct Sgp4Record {
+	JulianDate epoch;	// эпоха TLE (UTC), по частям
+
+	// Средние элементы (радианы, рад/мин)
+	double bstar, ecco, argpo, inclo, mo, nodeo, noKozai, noUnkozai;
+
+	// Околоземная часть (SGP4)
+	bool isimp = false;
+	bool deepSpace = false;
+	double aycof, con41, cc1, cc4, cc5, d2, d3, d4, delmo, eta, argpdot, omgcof,
+		sinmao, t2cof, t3cof, t4cof, t5cof, x1mth2, x7thm1, mdot, nodedot, xlcof,
+		xmcof, nodecf;
+
+	// Глубокий космос (SDP4): лунно-солнечные возмущения и резонансы
+	int irez = 0;
+	double d2201, d2211, d3210, d3222, d4410, d4422, d5220, d5232, d5421, d5433,
+		dedt, del1, del2, del3, didt, dmdt, dnodt, domdt, e3, ee2, peo, pgho, pho,
+		pinco, plo, se2, se3, sgh2, sgh3, sgh4, sh2, sh3, si2, si3, sl2, sl3, sl4,
+		gsto, xfact, xgh2, xgh3, xgh4, xh2, xh3, xi2, xi3, xl2, xl3, xl4, xlamo,
+		zmol, zmos;
+};
+
+// Модель SGP4/SDP4 (Vallado et al., "Revisiting Spacetrack Report #3", 2006),
+// константы WGS-72, режим 'i'. Результат - положение (км) и скорость (км/с)
+// в системе TEME. Распространение не выделяет память и не меняет запись,
+// поэтому одну запись можно читать из нескольких потоков
+class Sgp4
+{
+public:
+	// Гравитационные константы WGS-72
+	static constexpr double earthRadiusKm = 6378.135;
+	static constexpr double mu = 398600.8;				// км^3/с^2
+	static constexpr double j2 = 0.001082616;
+	static constexpr double j3 = -0.00000253881;
+	static constexpr double j4 = -0.00000165597;
+
+	static Sgp4Error initialize(const TleElements& elements, Sgp4Record& record);
+
+	static Sgp4Error propagate(const Sgp4Record& record, double minutesSinceEpoch,
+		glm::dvec3& position, glm::dvec3& velocity);
+
+	// Разность по частям: без потери точности на округлении полной даты
+	static double minutesSinceEpoch(const Sgp4Record& record, const JulianDate& utc)
+	{
+		return utc.daysSince(record.epoch) * 1440.0;
+	}
+
+	// Момент одним числом уже округлён до ~40 мкс; эпоха остаётся точной
+	static double minutesSinceEpoch(const Sgp4Record& record, double jd)
+	{
+		return minutesSinceEpoch(record, JulianDate(jd));
+	}
+
+	// Гринвичское среднее звёздное время (IAU-82), радианы
+	static double gmst(double jdUt1);
+
+	static double xke();
+};
@@ -0,0 +1,265 @@
+#include "Sgp4Batch.h"
+#include "Sgp4Kernel.h"
+
+#include <iostream>
+#include <algorithm>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+namespace {
+
+	// Скалярная ветвь ядра: стандартная математика, по одному спутнику
+	struct ScalarOps {
+		using V = double;
+		using Mask = bool;
+		static constexpr size_t width = 1;
+
+		static V load(const double* pointer) { return *pointer; }
+		static void store(double* pointer, V value) { *pointer = value; }
+		static void storeCode(uint8_t* pointer, V code) { *pointer = static_cast<uint8_t>(code); }
+		static V sqrt(V x) { return std::sqrt(x); }
+		static V abs(V x) { return std::fabs(x); }
+		static V min(V a, V b) { return a < b ? a : b; }
+		static V max(V a, V b) { return a > b ? a : b; }
+		static V select(Mask mask, V a, V b) { return mask ? a : b; }
+		static bool any(Mask mask) { return mask; }
+		static V fmod2pi(V x) { return std::fmod(x, 2.0 * M_PI); }
+		static void sincos(V x, V& s, V& c)
+		{
+			s = std::sin(x);
+			c = std::cos(x);
+		}
+	};
+
+	// Заполнение колонок при сборке
+	template <typename Func>
+	void forEachColumn(Sgp4Batch::NearColumns& c, Func&& func)
+	{
+		for (auto* column : { &c.epochDay, &c.epochFraction, &c.mo, &c.mdot, &c.argpo, &c.argpdot, &c.nodeo,
+			&c.nodedot, &c.nodecf, &c.bstar, &c.cc1, &c.cc4, &c.cc5, &c.t2cof, &c.t3cof,
+			&c.t4cof, &c.t5cof, &c.d2, &c.d3, &c.d4, &c.omgcof, &c.xmcof, &c.eta, &c.delmo,
+			&c.sinmao, &c.aBase, &c.noUnkozai, &c.ecco, &c.inclo, &c.cosio, &c.sinio,
+			&c.aycof, &c.xlcof, &c.con41, &c.x1mth2, &c.x7thm1 })
+			func(*column);
+	}
+
+}
+
+void Sgp4Batch::States::resize(size_t count)
+{
+	x.resize(count);
+	y.resize(count);
+	z.resize(count);
+	vx.resize(count);
+	vy.resize(count);
+	vz.resize(count);
+	error.resize(count);
+}
+
+Sgp4Batch::Sgp4Batch()
+	: activeIsa(detectIsa())
+{
+}
+
+void Sgp4Batch::build(const SatelliteCatalog& catalog)
+{
+	clear();
+
+	std::vector<SatelliteCatalog::Slot> deepSlots;
+	std::vector<TleElements> deepElements;
+	for (SatelliteCatalog::Slot slot = 0; slot < catalog.slotCount(); slot++) {
+		if (!catalog.isAlive(slot))
+			continue;
+
+		TleElements source = catalog.elements(slot);
+		Sgp4Record record;
+		if (Sgp4::initialize(source, record) != Sgp4Error::None) {
+			rejected++;
+			continue;
+		}
+
+		if (record.deepSpace) {
+			deep.push_back(record);
+			deepSlots.push_back(slot);
+			deepElements.push_back(source);
+		}
+		else {
+			appendNear(record);
+			slotIndex.push_back(slot);
+			elements.push_back(source);
+		}
+	}
+	slotIndex.insert(slotIndex.end(), deepSlots.begin(), deepSlots.end());
+	elements.insert(elements.end(), deepElements.begin(), deepElements.end());
+
+	builtVersion = catalog.version();
+	built = true;
+
+	if (rejected > 0)
+		std::cerr << "SGP4 batch: skipped " << rejected << " objects with invalid elements" << std::endl;
+}
+
+void Sgp4Batch::clear()
+{
+	forEachColumn(near, [](AlignedVector<double>& column) { column.clear(); });
+	deep.clear();
+	slotIndex.clear();
+	elements.clear();
+	rejected = 0;
+	built = false;
+}
+
+void Sgp4Batch::propagate(const JulianDate& jd, States& states) const
+{
+	states.resize(size());
+	propagateRange(jd, 0, size(), states);
+}
+
+void Sgp4Batch::propagateRange(const JulianDate& jd, size_t begin, size_t end, States& states) const
+{
+	end = std::min(end, size());
+	size_t nearEnd = std::min(end, nearCount());
+
+	if (begin < nearEnd) {
+		size_t done = begin;
+		if (activeIsa == SimdIsa::Avx512)
+			done = propagateNearAvx512(near, jd, begin, nearEnd, states);
+		else if (activeIsa == SimdIsa::Avx2)
+			done = propagateNearAvx2(near, jd, begin, nearEnd, states);
+		propagateNearLanes<ScalarOps>(near, jd, done, nearEnd, states);
+	}
+
+	// Глубокий космос: резонансы и лунно-солнечные члены слишком ветвисты для SIMD
+	for (size_t i = std::max(begin, nearCount()); i < end; i++) {
+		const Sgp4Record& record = deep[i - nearCount()];
+		glm::dvec3 position, velocity;
+		Sgp4Error error = Sgp4::propagate(record, Sgp4::minutesSinceEpoch(record, jd), position, velocity);
+		bool invalid = error != Sgp4Error::None && error != Sgp4Error::Decayed;
+		if (invalid) {
+			position = glm::dvec3(0.0);
+			velocity = glm::dvec3(0.0);
+		}
+		states.x[i] = position.x;
+		states.y[i] = position.y;
+		states.z[i] = position.z;
+		states.vx[i] = velocity.x;
+		states.vy[i] = velocity.y;
+		states.vz[i] = velocity.z;
+		states.error[i] = static_cast<uint8_t>(error);
+	}
+}
+
+void Sgp4Batch::propagateReference(const JulianDate& jd, States& states) const
+{
+	states.resize(size());
+
+	for (size_t i = 0; i < size(); i++) {
+		// Запись пересоздаётся из исходных элементов, минуя колонки пакета
+		Sgp4Record record;
+		Sgp4::initialize(elements[i], record);
+
+		glm::dvec3 position, velocity;
+		Sgp4Error error = Sgp4::propagate(record, Sgp4::minutesSinceEpoch(record, jd), position, velocity);
+		if (error != Sgp4Error::None && error != Sgp4Error::Decayed) {
+			position = glm::dvec3(0.0);
+			velocity = glm::dvec3(0.0);
+		}
+		states.x[i] = position.x;
+		states.y[i] = position.y;
+		states.z[i] = position.z;
+		states.vx[i] = velocity.x;
+		states.vy[i] = velocity.y;
+		states.vz[i] = velocity.z;
+		states.error[i] = static_cast<uint8_t>(error);
+	}
+}
+
+SimdIsa Sgp4Batch::detectIsa()
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	__builtin_cpu_init();
+	if (sgp4Avx512Compiled && __builtin_cpu_supports("avx512f"))
+		return SimdIsa::Avx512;
+	if (sgp4Avx2Compiled && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+		return SimdIsa::Avx2;
+#elif defined(_MSC_VER) && defined(_M_X64)
+	int info[4];
+	__cpuidex(info, 1, 0);
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	bool fma = (info[2] & (1 << 12)) != 0;
+	// Регистры YMM/ZMM должна сохранять ОС
+	unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+	bool ymmEnabled = (xcr0 & 0x6) == 0x6;
+	bool zmmEnabled = (xcr0 & 0xE6) == 0xE6;
+
+	__cpuidex(info, 7, 0);
+	bool avx2 = (info[1] & (1 << 5)) != 0;
+	bool avx512f = (info[1] & (1 << 16)) != 0;
+
+	if (sgp4Avx512Compiled && avx512f && zmmEnabled)
+		return SimdIsa::Avx512;
+	if (sgp4Avx2Compiled && avx2 && fma && ymmEnabled)
+		return SimdIsa::Avx2;
+#endif
+	return SimdIsa::Scalar;
+}
+
+const char* Sgp4Batch::isaName(SimdIsa isa)
+{
+	switch (isa) {
+	case SimdIsa::Avx2: return "AVX2";
+	case SimdIsa::Avx512: return "AVX-512";
+	default: return "scalar";
+	}
+}
+
+void Sgp4Batch::setIsa(SimdIsa isa)
+{
+	activeIsa = std::min(isa, detectIsa());
+}
+
+void Sgp4Batch::appendNear(const Sgp4Record& r)
+{
+	// Для isimp члены высших порядков не используются - обнуляем их,
+	// чтобы ядро считало одну формулу без ветвлений
+	double keep = r.isimp ? 0.0 : 1.0;
+
+	near.epochDay.push_back(r.epoch.day);
+	near.epochFraction.push_back(r.epoch.fraction);
+	near.mo.push_back(r.mo);
+	near.mdot.push_back(r.mdot);
+	near.argpo.push_back(r.argpo);
+	near.argpdot.push_back(r.argpdot);
+	near.nodeo.push_back(r.nodeo);
+	near.nodedot.push_back(r.nodedot);
+	near.nodecf.push_back(r.nodecf);
+	near.bstar.push_back(r.bstar);
+	near.cc1.push_back(r.cc1);
+	near.cc4.push_back(r.cc4);
+	near.cc5.push_back(r.cc5 * keep);
+	near.t2cof.push_back(r.t2cof);
+	near.t3cof.push_back(r.t3cof * keep);
+	near.t4cof.push_back(r.t4cof * keep);
+	near.t5cof.push_back(r.t5cof * keep);
+	near.d2.push_back(r.d2 * keep);
+	near.d3.push_back(r.d3 * keep);
+	near.d4.push_back(r.d4 * keep);
+	near.omgcof.push_back(r.omgcof * keep);
+	near.xmcof.push_back(r.xmcof * keep);
+	near.eta.push_back(r.eta);
+	near.delmo.push_back(r.delmo);
+	near.sinmao.push_back(r.sinmao);
+	near.aBase.push_back(std::pow(Sgp4::xke() / r.noUnkozai, 2.0 / 3.0));
+	near.noUnkozai.push_back(r.noUnkozai);
+	near.ecco.push_back(r.ecco);
+	near.inclo.push_back(r.inclo);
+	near.cosio.push_back(std::cos(r.inclo));
+	near.sinio.push_back(std::sin(r.inclo));
+	near.aycof.push_back(r.aycof);
+	near.xlcof.push_back(r.xlcof);
+	near.con41.push_back(r.con41);
+	near.x1mth2.push_back(r.x1mth2);
+	near.x7thm1.push_back(r.x7thm1);
+}
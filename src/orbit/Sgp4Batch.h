@@ -0,0 +1,94 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "Sgp4.h"
+#include "../data/AlignedAllocator.h"
+#include "../data/SatelliteCatalog.h"
+
+// Набор инструкций векторного ядра
+enum class SimdIsa {
+	Scalar,
+	Avx2,	// 4 спутника за проход
+	Avx512	// 8 спутников за проход
+};
+
+// Пакетное распространение SGP4 для всего каталога.
+// Околоземные объекты хранятся колонками предвычисленных коэффициентов и
+// считаются векторным ядром по несколько спутников за раз; объекты глубокого
+// космоса (SDP4) идут отдельным скалярным путём через Sgp4::propagate().
+// Порядок в пакете: сначала околоземные [0, nearCount()), затем глубокий
+// космос [nearCount(), size()); slots() сопоставляет индекс слоту каталога
+class Sgp4Batch
+{
+public:
+	// Коэффициенты околоземной модели, индекс - номер в пакете
+	struct NearColumns {
+		AlignedVector<double> epochDay, epochFraction;	// эпоха по частям, см. JulianDate
+		AlignedVector<double> mo, mdot;
+		AlignedVector<double> argpo, argpdot;
+		AlignedVector<double> nodeo, nodedot, nodecf;
+		AlignedVector<double> bstar, cc1, cc4, cc5;
+		AlignedVector<double> t2cof, t3cof, t4cof, t5cof;
+		AlignedVector<double> d2, d3, d4;
+		AlignedVector<double> omgcof, xmcof, eta, delmo, sinmao;
+		AlignedVector<double> aBase;	// (xke / noUnkozai)^(2/3)
+		AlignedVector<double> noUnkozai, ecco, inclo, cosio, sinio;
+		AlignedVector<double> aycof, xlcof, con41, x1mth2, x7thm1;
+	};
+
+	// Результат: TEME, км и км/с; error - код Sgp4Error
+	struct States {
+		AlignedVector<double> x, y, z;
+		AlignedVector<double> vx, vy, vz;
+		AlignedVector<uint8_t> error;
+
+		void resize(size_t count);
+		size_t size() const { return x.size(); }
+	};
+
+	Sgp4Batch();
+
+	// Пересобирает пакет из живых слотов каталога
+	void build(const SatelliteCatalog& catalog);
+	void clear();
+	bool isStale(const SatelliteCatalog& catalog) const { return catalog.version() != builtVersion || !built; }
+
+	// Время от эпохи считается по частям (JulianDate), без округления до ~40 мкс
+	void propagate(const JulianDate& jd, States& states) const;
+	// Диапазон индексов пакета; states уже должен иметь размер size()
+	void propagateRange(const JulianDate& jd, size_t begin, size_t end, States& states) const;
+	// Эталон: Sgp4::propagate() по каждому объекту, для сверки векторных ветвей
+	void propagateReference(const JulianDate& jd, States& states) const;
+
+	size_t size() const { return slotIndex.size(); }
+	size_t nearCount() const { return near.epochDay.size(); }
+	size_t deepCount() const { return deep.size(); }
+	size_t rejectedCount() const { return rejected; }
+	const std::vector<SatelliteCatalog::Slot>& slots() const { return slotIndex; }
+	// Коэффициенты околоземных объектов - для переноса ядра на GPU
+	const NearColumns& nearColumns() const { return near; }
+	// Версия каталога, из которой собран пакет
+	uint64_t version() const { return builtVersion; }
+
+	// Лучший набор инструкций, поддерживаемый процессором и сборкой
+	static SimdIsa detectIsa();
+	static const char* isaName(SimdIsa isa);
+	// Принудительный выбор ветви (не выше detectIsa())
+	void setIsa(SimdIsa isa);
+	SimdIsa isa() const { return activeIsa; }
+
+private:
+	void appendNear(const Sgp4Record& record);
+
+	NearColumns near;
+	std::vector<Sgp4Record> deep;
+	std::vector<SatelliteCatalog::Slot> slotIndex;
+	std::vector<TleElements> elements;	// исходные элементы для propagateReference()
+	size_t rejected = 0;
+	uint64_t builtVersion = 0;
+	bool built = false;
+	SimdIsa activeIsa = SimdIsa::Scalar;
+};
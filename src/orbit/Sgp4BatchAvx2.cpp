@@ -0,0 +1,87 @@
+// Ветвь AVX2 + FMA: файл собирается с -mavx2 -mfma (/arch:AVX2),
+// вызывается только после проверки Sgp4Batch::detectIsa()
+
+#include "Sgp4Kernel.h"
+
+#if defined(__AVX2__)
+
+#include <immintrin.h>
+#include <cstring>
+
+const bool sgp4Avx2Compiled = true;
+
+namespace {
+
+	struct Vec4 {
+		__m256d v;
+		Vec4() = default;
+		Vec4(__m256d value) : v(value) {}
+		Vec4(double value) : v(_mm256_set1_pd(value)) {}
+	};
+
+	struct Mask4 {
+		__m256d m;
+	};
+
+	inline Vec4 operator+(Vec4 a, Vec4 b) { return _mm256_add_pd(a.v, b.v); }
+	inline Vec4 operator-(Vec4 a, Vec4 b) { return _mm256_sub_pd(a.v, b.v); }
+	inline Vec4 operator*(Vec4 a, Vec4 b) { return _mm256_mul_pd(a.v, b.v); }
+	inline Vec4 operator/(Vec4 a, Vec4 b) { return _mm256_div_pd(a.v, b.v); }
+	inline Vec4 operator-(Vec4 a) { return _mm256_xor_pd(a.v, _mm256_set1_pd(-0.0)); }
+
+	inline Mask4 operator<(Vec4 a, Vec4 b) { return { _mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ) }; }
+	inline Mask4 operator>=(Vec4 a, Vec4 b) { return { _mm256_cmp_pd(a.v, b.v, _CMP_GE_OQ) }; }
+	inline Mask4 operator==(Vec4 a, Vec4 b) { return { _mm256_cmp_pd(a.v, b.v, _CMP_EQ_OQ) }; }
+	inline Mask4 operator|(Mask4 a, Mask4 b) { return { _mm256_or_pd(a.m, b.m) }; }
+
+	struct Avx2Ops {
+		using V = Vec4;
+		using Mask = Mask4;
+		static constexpr size_t width = 4;
+
+		static V load(const double* pointer) { return _mm256_loadu_pd(pointer); }
+		static void store(double* pointer, V value) { _mm256_storeu_pd(pointer, value.v); }
+		static void storeCode(uint8_t* pointer, V code)
+		{
+			__m128i codes = _mm256_cvtpd_epi32(code.v);
+			codes = _mm_packs_epi32(codes, codes);
+			int packed = _mm_cvtsi128_si32(_mm_packus_epi16(codes, codes));
+			std::memcpy(pointer, &packed, sizeof(packed));
+		}
+		static V sqrt(V x) { return _mm256_sqrt_pd(x.v); }
+		static V abs(V x) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), x.v); }
+		static V min(V a, V b) { return _mm256_min_pd(a.v, b.v); }
+		static V max(V a, V b) { return _mm256_max_pd(a.v, b.v); }
+		static V select(Mask mask, V a, V b) { return _mm256_blendv_pd(b.v, a.v, mask.m); }
+		static bool any(Mask mask) { return _mm256_movemask_pd(mask.m) != 0; }
+		static V floor(V x) { return _mm256_floor_pd(x.v); }
+		static V roundNearest(V x) { return _mm256_round_pd(x.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+		// c - a * b
+		static V fnmadd(V a, V b, V c) { return _mm256_fnmadd_pd(a.v, b.v, c.v); }
+		static V fmod2pi(V x)
+		{
+			__m256d turns = _mm256_round_pd(_mm256_mul_pd(x.v, _mm256_set1_pd(0.5 / M_PI)),
+				_MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+			return _mm256_fnmadd_pd(turns, _mm256_set1_pd(2.0 * M_PI), x.v);
+		}
+		static void sincos(V x, V& s, V& c) { vectorSinCos<Avx2Ops>(x, s, c); }
+	};
+
+}
+
+size_t propagateNearAvx2(const Sgp4Batch::NearColumns& near, const JulianDate& jd,
+	size_t begin, size_t end, Sgp4Batch::States& states)
+{
+	return propagateNearLanes<Avx2Ops>(near, jd, begin, end, states);
+}
+
+#else
+
+const bool sgp4Avx2Compiled = false;
+
+size_t propagateNearAvx2(const Sgp4Batch::NearColumns&, const JulianDate&, size_t begin, size_t, Sgp4Batch::States&)
+{
+	return begin;
+}
+
+#endif
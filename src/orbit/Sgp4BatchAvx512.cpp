@@ -0,0 +1,94 @@
+// Ветвь AVX-512F: файл собирается с -mavx512f -mfma (/arch:AVX512),
+// вызывается только после проверки Sgp4Batch::detectIsa()
+
+#include "Sgp4Kernel.h"
+
+#if defined(__AVX512F__)
+
+#include <immintrin.h>
+
+const bool sgp4Avx512Compiled = true;
+
+namespace {
+
+	struct Vec8 {
+		__m512d v;
+		Vec8() = default;
+		Vec8(__m512d value) : v(value) {}
+		Vec8(double value) : v(_mm512_set1_pd(value)) {}
+	};
+
+	struct Mask8 {
+		__mmask8 m;
+	};
+
+	inline __m512d flipSign(__m512d x)
+	{
+		return _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(x),
+			_mm512_set1_epi64(static_cast<long long>(0x8000000000000000ull))));
+	}
+
+	inline Vec8 operator+(Vec8 a, Vec8 b) { return _mm512_add_pd(a.v, b.v); }
+	inline Vec8 operator-(Vec8 a, Vec8 b) { return _mm512_sub_pd(a.v, b.v); }
+	inline Vec8 operator*(Vec8 a, Vec8 b) { return _mm512_mul_pd(a.v, b.v); }
+	inline Vec8 operator/(Vec8 a, Vec8 b) { return _mm512_div_pd(a.v, b.v); }
+	inline Vec8 operator-(Vec8 a) { return flipSign(a.v); }
+
+	inline Mask8 operator<(Vec8 a, Vec8 b) { return { _mm512_cmp_pd_mask(a.v, b.v, _CMP_LT_OQ) }; }
+	inline Mask8 operator>=(Vec8 a, Vec8 b) { return { _mm512_cmp_pd_mask(a.v, b.v, _CMP_GE_OQ) }; }
+	inline Mask8 operator==(Vec8 a, Vec8 b) { return { _mm512_cmp_pd_mask(a.v, b.v, _CMP_EQ_OQ) }; }
+	inline Mask8 operator|(Mask8 a, Mask8 b) { return { static_cast<__mmask8>(a.m | b.m) }; }
+
+	struct Avx512Ops {
+		using V = Vec8;
+		using Mask = Mask8;
+		static constexpr size_t width = 8;
+
+		static V load(const double* pointer) { return _mm512_loadu_pd(pointer); }
+		static void store(double* pointer, V value) { _mm512_storeu_pd(pointer, value.v); }
+		static void storeCode(uint8_t* pointer, V code)
+		{
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(pointer),
+				_mm512_cvtepi64_epi8(_mm512_cvtepi32_epi64(_mm512_cvtpd_epi32(code.v))));
+		}
+		static V sqrt(V x) { return _mm512_sqrt_pd(x.v); }
+		static V abs(V x)
+		{
+			return _mm512_castsi512_pd(_mm512_and_si512(_mm512_castpd_si512(x.v),
+				_mm512_set1_epi64(0x7FFFFFFFFFFFFFFFll)));
+		}
+		static V min(V a, V b) { return _mm512_min_pd(a.v, b.v); }
+		static V max(V a, V b) { return _mm512_max_pd(a.v, b.v); }
+		static V select(Mask mask, V a, V b) { return _mm512_mask_blend_pd(mask.m, b.v, a.v); }
+		static bool any(Mask mask) { return mask.m != 0; }
+		static V floor(V x) { return _mm512_roundscale_pd(x.v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC); }
+		static V roundNearest(V x) { return _mm512_roundscale_pd(x.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+		// c - a * b
+		static V fnmadd(V a, V b, V c) { return _mm512_fnmadd_pd(a.v, b.v, c.v); }
+		static V fmod2pi(V x)
+		{
+			__m512d turns = _mm512_roundscale_pd(_mm512_mul_pd(x.v, _mm512_set1_pd(0.5 / M_PI)),
+				_MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+			return _mm512_fnmadd_pd(turns, _mm512_set1_pd(2.0 * M_PI), x.v);
+		}
+		static void sincos(V x, V& s, V& c) { vectorSinCos<Avx512Ops>(x, s, c); }
+	};
+
+}
+
+size_t propagateNearAvx512(const Sgp4Batch::NearColumns& near, const JulianDate& jd,
+	size_t begin, size_t end, Sgp4Batch::States& states)
+{
+	return propagateNearLanes<Avx512Ops>(near, jd, begin, end, states);
+}
+
+#else
+
+const bool sgp4Avx512Compiled = false;
+
+size_t propagateNearAvx512(const Sgp4Batch::NearColumns&, const JulianDate&, size_t begin, size_t, Sgp4Batch::States&)
+{
+	return begin;
+}
+
+#endif
@@ -0,0 +1,228 @@
+#pragma once
+
+// Внутренний заголовок пакетного SGP4: общее ядро для скалярной и векторных
+// ветвей. Подключается только из Sgp4Batch*.cpp; каждая единица трансляции
+// собирается со своим набором инструкций, поэтому всё здесь лежит в
+// анонимном пространстве имён и не пересекается между ними
+
+#include <cmath>
+
+#include "Sgp4Batch.h"
+
+// Векторные ветви (Sgp4BatchAvx2.cpp, Sgp4BatchAvx512.cpp). Возвращают индекс,
+// на котором остановились: хвост короче ширины вектора досчитывает скалярное ядро
+size_t propagateNearAvx2(const Sgp4Batch::NearColumns& near, const JulianDate& jd,
+	size_t begin, size_t end, Sgp4Batch::States& states);
+size_t propagateNearAvx512(const Sgp4Batch::NearColumns& near, const JulianDate& jd,
+	size_t begin, size_t end, Sgp4Batch::States& states);
+extern const bool sgp4Avx2Compiled;
+extern const bool sgp4Avx512Compiled;
+
+namespace {
+
+	// Синус и косинус для векторных ветвей: приведение к [-pi/4, pi/4] по
+	// Коди-Уэйту через FMA и минимаксные многочлены Cephes
+	template <typename Ops>
+	inline void vectorSinCos(typename Ops::V x, typename Ops::V& s, typename Ops::V& c)
+	{
+		using V = typename Ops::V;
+		using Mask = typename Ops::Mask;
+
+		V q = Ops::roundNearest(x * V(2.0 / M_PI));
+		V r = Ops::fnmadd(q, V(1.5707963267948966), x);
+		r = Ops::fnmadd(q, V(6.123233995736766e-17), r);
+		V z = r * r;
+
+		V ps = V(1.58962301576546568060e-10);
+		ps = ps * z + V(-2.50507477628578072866e-8);
+		ps = ps * z + V(2.75573136213857245213e-6);
+		ps = ps * z + V(-1.98412698295895385996e-4);
+		ps = ps * z + V(8.33333333332211858878e-3);
+		ps = ps * z + V(-1.66666666666666307295e-1);
+		ps = r + r * z * ps;
+
+		V pc = V(-1.13585365213876817300e-11);
+		pc = pc * z + V(2.08757008419747316778e-9);
+		pc = pc * z + V(-2.75573141792967388112e-7);
+		pc = pc * z + V(2.48015872888517045348e-5);
+		pc = pc * z + V(-1.38888888888730564116e-3);
+		pc = pc * z + V(4.16666666666665929218e-2);
+		pc = V(1.0) - V(0.5) * z + z * z * pc;
+
+		// Номер четверти 0..3 определяет перестановку и знаки
+		V quadrant = q - V(4.0) * Ops::floor(q * V(0.25));
+		Mask swap = (quadrant == V(1.0)) | (quadrant == V(3.0));
+		Mask negateSin = quadrant >= V(2.0);
+		Mask negateCos = (quadrant == V(1.0)) | (quadrant == V(2.0));
+
+		V sinValue = Ops::select(swap, pc, ps);
+		V cosValue = Ops::select(swap, ps, pc);
+		s = Ops::select(negateSin, -sinValue, sinValue);
+		c = Ops::select(negateCos, -cosValue, cosValue);
+	}
+
+	// Околоземная часть SGP4 для Ops::width спутников за проход. Повторяет
+	// Sgp4::propagate() без ветвлений: для объектов с isimp лишние
+	// коэффициенты обнулены при сборке пакета, итерации Кеплера идут под
+	// маской, а atan2 заменён нормировкой (sin u, cos u) - дальше нужны
+	// только синус и косинус аргумента широты
+	template <typename Ops>
+	size_t propagateNearLanes(const Sgp4Batch::NearColumns& c, const JulianDate& jd,
+		size_t begin, size_t end, Sgp4Batch::States& out)
+	{
+		using V = typename Ops::V;
+		using Mask = typename Ops::Mask;
+
+		const double xke = Sgp4::xke();
+		const double vkmpersec = Sgp4::earthRadiusKm * xke / 60.0;
+		const V zero(0.0);
+		const V one(1.0);
+
+		size_t i = begin;
+		for (; i + Ops::width <= end; i += Ops::width) {
+			auto col = [i](const AlignedVector<double>& column) { return Ops::load(column.data() + i); };
+
+			// Разность по частям: полночи вычитаются точно
+			V t = ((V(jd.day) - col(c.epochDay)) + (V(jd.fraction) - col(c.epochFraction))) * V(1440.0);
+
+			// Вековые возмущения от гравитации и торможения
+			V xmdf = col(c.mo) + col(c.mdot) * t;
+			V argpdf = col(c.argpo) + col(c.argpdot) * t;
+			V t2 = t * t;
+			V nodem = col(c.nodeo) + col(c.nodedot) * t + col(c.nodecf) * t2;
+			V bstar = col(c.bstar);
+			V tempa = one - col(c.cc1) * t;
+			V tempe = bstar * col(c.cc4) * t;
+			V templ = col(c.t2cof) * t2;
+
+			V sinxmdf, cosxmdf;
+			Ops::sincos(xmdf, sinxmdf, cosxmdf);
+			V delmtemp = one + col(c.eta) * cosxmdf;
+			V delm = col(c.xmcof) * (delmtemp * delmtemp * delmtemp - col(c.delmo));
+			V temp = col(c.omgcof) * t + delm;
+			V mm = xmdf + temp;
+			V argpm = argpdf - temp;
+			V t3 = t2 * t;
+			V t4 = t3 * t;
+			tempa = tempa - col(c.d2) * t2 - col(c.d3) * t3 - col(c.d4) * t4;
+			V sinmm, cosmm;
+			Ops::sincos(mm, sinmm, cosmm);
+			tempe = tempe + bstar * col(c.cc5) * (sinmm - col(c.sinmao));
+			templ = templ + col(c.t3cof) * t3 + t4 * (col(c.t4cof) + t * col(c.t5cof));
+
+			V noUnkozai = col(c.noUnkozai);
+			V am = col(c.aBase) * tempa * tempa;
+			V nm = V(xke) / (am * Ops::sqrt(am));
+			V em = col(c.ecco) - tempe;
+			Mask eccError = (em >= one) | (em < V(-0.001));
+			em = Ops::max(em, V(1.0e-6));
+
+			mm = mm + noUnkozai * templ;
+			V xlm = mm + argpm + nodem;
+			nodem = Ops::fmod2pi(nodem);
+			argpm = Ops::fmod2pi(argpm);
+			xlm = Ops::fmod2pi(xlm);
+			mm = Ops::fmod2pi(xlm - argpm - nodem);
+
+			// Долгопериодические члены
+			V sinargp, cosargp;
+			Ops::sincos(argpm, sinargp, cosargp);
+			V axnl = em * cosargp;
+			temp = one / (am * (one - em * em));
+			V aynl = em * sinargp + temp * col(c.aycof);
+			V xl = mm + argpm + nodem + temp * col(c.xlcof) * axnl;
+
+			// Уравнение Кеплера: сошедшиеся полосы замораживаются маской
+			V u = Ops::fmod2pi(xl - nodem);
+			V eo1 = u;
+			V tem5(9999.9);
+			V sineo1 = zero;
+			V coseo1 = zero;
+			for (int ktr = 1; ktr <= 10; ktr++) {
+				Mask active = Ops::abs(tem5) >= V(1.0e-12);
+				if (!Ops::any(active))
+					break;
+				V s, co;
+				Ops::sincos(eo1, s, co);
+				sineo1 = Ops::select(active, s, sineo1);
+				coseo1 = Ops::select(active, co, coseo1);
+				V step = (u - aynl * coseo1 + axnl * sineo1 - eo1) /
+					(one - coseo1 * axnl - sineo1 * aynl);
+				step = Ops::min(Ops::max(step, V(-0.95)), V(0.95));
+				tem5 = Ops::select(active, step, tem5);
+				eo1 = eo1 + Ops::select(active, step, zero);
+			}
+
+			// Короткопериодические члены
+			V ecose = axnl * coseo1 + aynl * sineo1;
+			V esine = axnl * sineo1 - aynl * coseo1;
+			V el2 = axnl * axnl + aynl * aynl;
+			V pl = am * (one - el2);
+			Mask plError = pl < zero;
+
+			V rl = am * (one - ecose);
+			V rdotl = Ops::sqrt(am) * esine / rl;
+			V rvdotl = Ops::sqrt(pl) / rl;
+			V betal = Ops::sqrt(one - el2);
+			temp = esine / (one + betal);
+			V sinu = am / rl * (sineo1 - aynl - axnl * temp);
+			V cosu = am / rl * (coseo1 - axnl + aynl * temp);
+			V sin2u = (cosu + cosu) * sinu;
+			V cos2u = one - V(2.0) * sinu * sinu;
+			temp = one / pl;
+			V temp1 = V(0.5 * Sgp4::j2) * temp;
+			V temp2 = temp1 * temp;
+
+			V con41 = col(c.con41);
+			V x1mth2 = col(c.x1mth2);
+			V cosio = col(c.cosio);
+			V mrt = rl * (one - V(1.5) * temp2 * betal * con41) + V(0.5) * temp1 * x1mth2 * cos2u;
+			V dsu = V(-0.25) * temp2 * col(c.x7thm1) * sin2u;
+			V xnode = nodem + V(1.5) * temp2 * cosio * sin2u;
+			V xinc = col(c.inclo) + V(1.5) * temp2 * cosio * col(c.sinio) * cos2u;
+			V mvt = rdotl - nm * temp1 * x1mth2 * sin2u / V(xke);
+			V rvdot = rvdotl + nm * temp1 * (x1mth2 * cos2u + V(1.5) * con41) / V(xke);
+
+			// su = atan2(sinu, cosu) + dsu, нужны только его синус и косинус
+			V norm = one / Ops::sqrt(sinu * sinu + cosu * cosu);
+			V sinun = sinu * norm;
+			V cosun = cosu * norm;
+			V sindsu, cosdsu;
+			Ops::sincos(dsu, sindsu, cosdsu);
+			V sinsu = sinun * cosdsu + cosun * sindsu;
+			V cossu = cosun * cosdsu - sinun * sindsu;
+
+			// Ориентация орбиты
+			V snod, cnod, sini, cosi;
+			Ops::sincos(xnode, snod, cnod);
+			Ops::sincos(xinc, sini, cosi);
+			V xmx = -snod * cosi;
+			V xmy = cnod * cosi;
+			V ux = xmx * sinsu + cnod * cossu;
+			V uy = xmy * sinsu + snod * cossu;
+			V uz = sini * sinsu;
+			V vx = xmx * cossu - cnod * sinsu;
+			V vy = xmy * cossu - snod * sinsu;
+			V vz = sini * cossu;
+
+			// Коды ошибок в порядке проверок скалярной версии; при ошибках
+			// эксцентриситета и фокального параметра вектор состояния обнуляется
+			Mask invalid = eccError | plError;
+			V code = Ops::select(mrt < one, V(double(Sgp4Error::Decayed)), zero);
+			code = Ops::select(plError, V(double(Sgp4Error::SemiLatusRectum)), code);
+			code = Ops::select(eccError, V(double(Sgp4Error::MeanEccentricity)), code);
+
+			V r = mrt * V(Sgp4::earthRadiusKm);
+			V v(vkmpersec);
+			Ops::store(out.x.data() + i, Ops::select(invalid, zero, r * ux));
+			Ops::store(out.y.data() + i, Ops::select(invalid, zero, r * uy));
+			Ops::store(out.z.data() + i, Ops::select(invalid, zero, r * uz));
+			Ops::store(out.vx.data() + i, Ops::select(invalid, zero, (mvt * ux + rvdot * vx) * v));
+			Ops::store(out.vy.data() + i, Ops::select(invalid, zero, (mvt * uy + rvdot * vy) * v));
+			Ops::store(out.vz.data() + i, Ops::select(invalid, zero, (mvt * uz + rvdot * vz) * v));
+			Ops::storeCode(out.error.data() + i, code);
+		}
+		return i;
+	}
+
+}
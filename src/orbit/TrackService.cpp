@@ -0,0 +1,205 @@
+#include "TrackService.h"
+
+#include <algorithm>
+#include <cmath>
+
+TrackService::TrackService(const SatelliteCatalog& catalog, WorkStealingPool& pool, const TrackSettings& settings)
+	: catalog(catalog), pool(pool), settings(settings)
+{
+	this->settings.minStepSeconds = std::max(this->settings.minStepSeconds, 0.1);
+	this->settings.maxStepSeconds = std::max(this->settings.maxStepSeconds, this->settings.minStepSeconds);
+}
+
+void TrackService::update(const std::vector<SatelliteCatalog::Slot>& slots, double jd)
+{
+	useCounter++;
+
+	// Записи создаются заранее: ссылки на элементы unordered_map не меняются
+	// при вставке, а параллельная часть не трогает саму таблицу
+	std::vector<Entry*> work;
+	work.reserve(slots.size());
+	for (SatelliteCatalog::Slot slot : slots) {
+		if (!catalog.isAlive(slot)) {
+			entries.erase(slot);
+			continue;
+		}
+		Entry& entry = entries[slot];
+		entry.track.slot = slot;
+		entry.lastUsed = useCounter;
+		work.push_back(&entry);
+	}
+
+	pool.parallelFor(work.size(), settings.tracksPerTask, [&](size_t begin, size_t end, unsigned) {
+		for (size_t i = begin; i < end; i++)
+			updateEntry(*work[i], jd);
+	});
+
+	// Вытеснение давно не запрошенных треков
+	if (entries.size() > settings.maxTracks) {
+		std::vector<std::pair<uint64_t, SatelliteCatalog::Slot>> byAge;
+		byAge.reserve(entries.size());
+		for (const auto& item : entries)
+			byAge.push_back({ item.second.lastUsed, item.first });
+		std::sort(byAge.begin(), byAge.end());
+		size_t excess = entries.size() - settings.maxTracks;
+		for (size_t i = 0; i < excess && byAge[i].first != useCounter; i++)
+			entries.erase(byAge[i].second);
+	}
+}
+
+const OrbitTrack* TrackService::track(SatelliteCatalog::Slot slot) const
+{
+	auto it = entries.find(slot);
+	if (it == entries.end() || it->second.track.points.empty())
+		return nullptr;
+	return &it->second.track;
+}
+
+void TrackService::release(SatelliteCatalog::Slot slot)
+{
+	entries.erase(slot);
+}
+
+void TrackService::clear()
+{
+	entries.clear();
+}
+
+TrackService::Stats TrackService::stats() const
+{
+	Stats total;
+	total.propagations = propagations.load(std::memory_order_relaxed);
+	total.rebuilds = rebuilds.load(std::memory_order_relaxed);
+	total.tracks = entries.size();
+	return total;
+}
+
+void TrackService::updateEntry(Entry& entry, double jd)
+{
+	OrbitTrack& track = entry.track;
+	std::vector<TrackPoint>& points = track.points;
+	uint32_t revision = catalog.columns().revision[track.slot];
+
+	if (!entry.valid || track.revision != revision) {
+		TleElements elements = catalog.elements(track.slot);
+		entry.valid = Sgp4::initialize(elements, entry.record) == Sgp4Error::None && elements.meanMotion > 0.0;
+		track.revision = revision;
+		track.periodDays = entry.valid ? 1.0 / elements.meanMotion : 0.0;
+		points.clear();
+	}
+	if (!entry.valid)
+		return;
+
+	const double start = jd - settings.pastRevolutions * track.periodDays;
+	const double end = jd + settings.futureRevolutions * track.periodDays;
+
+	// Скачок времени за пределы построенного - заново от текущего момента
+	if (!points.empty() && (end < points.front().jd || start > points.back().jd))
+		points.clear();
+	if (points.empty()) {
+		TrackPoint point;
+		if (!sample(entry, jd, point))
+			return;
+		points.push_back(point);
+		rebuilds.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	// По одной точке за краями окна остаются, чтобы линия доходила до границ
+	size_t drop = 0;
+	while (drop + 1 < points.size() && points[drop + 1].jd <= start)
+		drop++;
+	points.erase(points.begin(), points.begin() + drop);
+	size_t keep = points.size();
+	while (keep > 1 && points[keep - 2].jd >= end)
+		keep--;
+	points.resize(keep);
+
+	// Досчёт назад (время идёт в обратную сторону или трек только начат)
+	if (points.front().jd > start) {
+		std::vector<TrackPoint> prefix;
+		TrackPoint reference = points.front();
+		while (reference.jd > start) {
+			TrackPoint point;
+			if (!sample(entry, reference.jd - stepDays(reference), point))
+				break;
+			prefix.push_back(point);
+			reference = point;
+		}
+		points.insert(points.begin(), prefix.rbegin(), prefix.rend());
+	}
+
+	// Досчёт вперёд
+	while (points.back().jd < end) {
+		TrackPoint point;
+		if (!sample(entry, points.back().jd + stepDays(points.back()), point))
+			break;
+		points.push_back(point);
+	}
+}
+
+bool TrackService::sample(const Entry& entry, double jd, TrackPoint& point)
+{
+	propagations.fetch_add(1, std::memory_order_relaxed);
+	if (Sgp4::propagate(entry.record, Sgp4::minutesSinceEpoch(entry.record, jd), point.position, point.velocity) !=
+		Sgp4Error::None)
+		return false;
+	point.jd = jd;
+	point.geodetic = Frames::ecefToGeodetic(Frames::temeToEcef(point.position, jd));
+	return true;
+}
+
+double TrackService::stepDays(const TrackPoint& point) const
+{
+	// Угловая скорость радиус-вектора плюс вращение Земли - для подспутниковой точки
+	double radius2 = glm::dot(point.position, point.position);
+	double rate = glm::length(glm::cross(point.position, point.velocity)) / radius2 + Frames::earthRotation;
+	double seconds = settings.maxTurnDegrees * M_PI / 180.0 / rate;
+	return glm::clamp(seconds, settings.minStepSeconds, settings.maxStepSeconds) / 86400.0;
+}
+
+void TrackService::orbitPath(const OrbitTrack& track, double jd, std::vector<glm::vec3>& scene)
+{
+	double theta = Frames::gmst(jd);
+	double c = std::cos(theta), s = std::sin(theta);
+	scene.clear();
+	scene.reserve(track.points.size());
+	for (const auto& point : track.points) {
+		const glm::dvec3& teme = point.position;
+		scene.push_back(Frames::ecefToScene(glm::dvec3(c * teme.x + s * teme.y, -s * teme.x + c * teme.y, teme.z)));
+	}
+}
+
+void TrackService::groundTrack(const OrbitTrack& track, std::vector<glm::vec2>& vertices,
+	std::vector<uint32_t>& segmentStarts)
+{
+	const double radToDeg = 180.0 / M_PI;
+	vertices.clear();
+	segmentStarts.clear();
+	if (track.points.empty())
+		return;
+
+	segmentStarts.push_back(0);
+	double prevLon = track.points.front().geodetic.longitude * radToDeg;
+	double prevLat = track.points.front().geodetic.latitude * radToDeg;
+	vertices.push_back(glm::vec2(prevLon, prevLat));
+
+	for (size_t i = 1; i < track.points.size(); i++) {
+		double lon = track.points[i].geodetic.longitude * radToDeg;
+		double lat = track.points[i].geodetic.latitude * radToDeg;
+
+		// Переход через антимеридиан: точка пересечения интерполируется по
+		// непрерывной долготе и ставится на оба края карты
+		if (std::fabs(lon - prevLon) > 180.0) {
+			double edge = prevLon > 0.0 ? 180.0 : -180.0;
+			double unwrapped = lon + 2.0 * edge;
+			double t = (edge - prevLon) / (unwrapped - prevLon);
+			double crossingLat = prevLat + t * (lat - prevLat);
+			vertices.push_back(glm::vec2(edge, crossingLat));
+			segmentStarts.push_back(static_cast<uint32_t>(vertices.size()));
+			vertices.push_back(glm::vec2(-edge, crossingLat));
+		}
+		vertices.push_back(glm::vec2(lon, lat));
+		prevLon = lon;
+		prevLat = lat;
+	}
+}
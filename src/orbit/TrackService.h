@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Frames.h"
+#include "Sgp4.h"
+#include "WorkStealingPool.h"
+#include "../data/SatelliteCatalog.h"
+
+struct TrackPoint {
+	double jd = 0.0;
+	glm::dvec3 position = glm::dvec3(0.0);	// TEME, км
+	glm::dvec3 velocity = glm::dvec3(0.0);	// TEME, км/с
+	Geodetic geodetic;						// подспутниковая точка в момент jd
+};
+
+// Отрезок траектории одного объекта вокруг текущего момента
+struct OrbitTrack {
+	SatelliteCatalog::Slot slot = SatelliteCatalog::invalidSlot;
+	uint32_t revision = 0;		// ревизия слота каталога, по которой построен трек
+	double periodDays = 0.0;
+	std::vector<TrackPoint> points;		// по возрастанию jd
+};
+
+struct TrackSettings {
+	double pastRevolutions = 0.5;		// окно трека в периодах обращения до и после
+	double futureRevolutions = 1.0;
+	double maxTurnDegrees = 2.0;		// наибольший поворот радиус-вектора за шаг
+	double minStepSeconds = 5.0;
+	double maxStepSeconds = 300.0;
+	size_t maxTracks = 1024;			// сверх этого вытесняются давно не запрошенные
+	size_t tracksPerTask = 4;
+};
+
+// Линии орбит и подспутниковые трассы для выбранных объектов.
+// Трек хранит точки на окне [jd - past, jd + future] периодов; при движении
+// времени точки, вышедшие из окна, отбрасываются, а недостающие
+// досчитываются только с краёв, так что в установившемся режиме за кадр
+// распространяется по одной-две точки на объект. Шаг выбирается по кривизне:
+// чтобы направление на спутник с учётом вращения Земли поворачивалось не
+// больше чем на maxTurnDegrees - у перигея вытянутых орбит точки чаще.
+// Трек перестраивается целиком при обновлении TLE или скачке времени за окно
+class TrackService
+{
+public:
+	struct Stats {
+		uint64_t propagations = 0;
+		uint64_t rebuilds = 0;
+		size_t tracks = 0;
+	};
+
+	TrackService(const SatelliteCatalog& catalog, WorkStealingPool& pool,
+		const TrackSettings& settings = TrackSettings());
+
+	// Обновление треков выбранных объектов на момент jd, параллельно по объектам
+	void update(const std::vector<SatelliteCatalog::Slot>& slots, double jd);
+	// nullptr - трека нет (объект не запрашивался, удалён или не распространяется)
+	const OrbitTrack* track(SatelliteCatalog::Slot slot) const;
+	void release(SatelliteCatalog::Slot slot);
+	void clear();
+
+	Stats stats() const;
+
+	// Линия орбиты в системе сцены: инерциальная траектория, повёрнутая
+	// вместе с Землёй на момент jd
+	static void orbitPath(const OrbitTrack& track, double jd, std::vector<glm::vec3>& scene);
+	// Трасса в градусах (x - долгота, y - широта), разрезанная на антимеридиане:
+	// segmentStarts - начала непрерывных кусков в vertices
+	static void groundTrack(const OrbitTrack& track, std::vector<glm::vec2>& vertices,
+		std::vector<uint32_t>& segmentStarts);
+
+private:
+	struct Entry {
+		Sgp4Record record;
+		bool valid = false;
+		OrbitTrack track;
+		uint64_t lastUsed = 0;
+	};
+
+	void updateEntry(Entry& entry, double jd);
+	bool sample(const Entry& entry, double jd, TrackPoint& point);
+	double stepDays(const TrackPoint& point) const;
+
+	const SatelliteCatalog& catalog;
+	WorkStealingPool& pool;
+	TrackSettings settings;
+
+	std::unordered_map<SatelliteCatalog::Slot, Entry> entries;
+	uint64_t useCounter = 0;
+	std::atomic<uint64_t> propagations{ 0 };
+	std::atomic<uint64_t> rebuilds{ 0 };
+};
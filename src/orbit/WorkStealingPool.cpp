@@ -0,0 +1,144 @@
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(unsigned threadCount)
+{
+	if (threadCount == 0)
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+	workerCount = threadCount;
+	queues = std::make_unique<ChunkQueue[]>(workerCount);
+
+	// Поток 0 - вызывающий parallelFor()
+	for (unsigned worker = 1; worker < workerCount; worker++)
+		threads.emplace_back(&WorkStealingPool::workerLoop, this, worker);
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for (auto& thread : threads)
+		thread.join();
+}
+
+void WorkStealingPool::parallelFor(size_t count, size_t grain, const RangeFunc& func)
+{
+	if (count == 0)
+		return;
+	grain = std::max<size_t>(grain, 1);
+
+	// Блокировка и для короткого пути: вызовы из разных потоков по очереди,
+	// даже если задание выполняется целиком в вызывающем потоке
+	std::lock_guard<std::mutex> callLock(callMutex);
+	size_t chunkCount = (count + grain - 1) / grain;
+	if (chunkCount == 1 || workerCount == 1) {
+		func(0, count, 0);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		job = &func;
+		jobCount = count;
+		jobGrain = grain;
+		remainingChunks.store(chunkCount);
+
+		// Каждому потоку - непрерывный отрезок кусков: соседние данные
+		// обрабатываются одним ядром, пока его не обгонят
+		for (unsigned worker = 0; worker < workerCount; worker++) {
+			auto begin = static_cast<uint32_t>(chunkCount * worker / workerCount);
+			auto end = static_cast<uint32_t>(chunkCount * (worker + 1) / workerCount);
+			queues[worker].range.store(pack(begin, end));
+		}
+		busyWorkers.fetch_add(1);
+		generation++;
+	}
+	wake.notify_all();
+
+	runChunks(0);
+	busyWorkers.fetch_sub(1);
+
+	// Ждём хвосты у других потоков; после этого ссылка на func больше не используется
+	while (remainingChunks.load() > 0 || busyWorkers.load() > 0)
+		std::this_thread::yield();
+}
+
+void WorkStealingPool::workerLoop(unsigned worker)
+{
+	uint64_t seenGeneration = 0;
+
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [&] { return stopping || generation != seenGeneration; });
+			if (stopping)
+				return;
+			seenGeneration = generation;
+			busyWorkers.fetch_add(1);
+		}
+
+		runChunks(worker);
+		busyWorkers.fetch_sub(1);
+	}
+}
+
+void WorkStealingPool::runChunks(unsigned worker)
+{
+	uint32_t chunk;
+	while (popLocal(worker, chunk) || steal(worker, chunk)) {
+		size_t begin = chunk * jobGrain;
+		size_t end = std::min(jobCount, begin + jobGrain);
+		(*job)(begin, end, worker);
+		remainingChunks.fetch_sub(1);
+	}
+}
+
+bool WorkStealingPool::popLocal(unsigned worker, uint32_t& chunk)
+{
+	auto& range = queues[worker].range;
+	uint64_t current = range.load();
+	while (true) {
+		auto begin = static_cast<uint32_t>(current >> 32);
+		auto end = static_cast<uint32_t>(current);
+		if (begin >= end)
+			return false;
+		if (range.compare_exchange_weak(current, pack(begin + 1, end))) {
+			chunk = begin;
+			return true;
+		}
+	}
+}
+
+bool WorkStealingPool::steal(unsigned thief, uint32_t& chunk)
+{
+	for (unsigned offset = 1; offset < workerCount; offset++) {
+		auto& range = queues[(thief + offset) % workerCount].range;
+		uint64_t current = range.load();
+		while (true) {
+			auto begin = static_cast<uint32_t>(current >> 32);
+			auto end = static_cast<uint32_t>(current);
+			if (begin >= end)
+				break;
+
+			// Забираем верхнюю половину; нижняя остаётся в очереди, из неё
+			// продолжают брать владелец (с начала) и другие воры (с середины)
+			uint32_t middle = begin + (end - begin) / 2;
+			if (range.compare_exchange_weak(current, pack(begin, middle))) {
+				chunk = middle;
+				// Своя очередь пуста, а пустую не меняет никто: и владелец, и воры
+				// пишут только CAS по непустому отрезку. Поэтому хватает store;
+				// после него украденный остаток доступен для краж, как любой другой
+				queues[thief].range.store(pack(middle + 1, end));
+				steals.fetch_add(1, std::memory_order_relaxed);
+				return true;
+			}
+		}
+	}
+	return false;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Пул потоков для параллельных проходов по каталогу.
+// parallelFor() режет диапазон на куски, раздаёт каждому потоку свой
+// непрерывный отрезок кусков, а освободившиеся потоки забирают (крадут)
+// половину оставшегося отрезка у соседей. Очереди - упакованные в 64 бита
+// пары [начало, конец) с изменением через CAS, без блокировок
+class WorkStealingPool
+{
+public:
+	// begin, end - индексы элементов; worker - номер потока в [0, threadCount())
+	using RangeFunc = std::function<void(size_t begin, size_t end, unsigned worker)>;
+
+	// 0 - по числу аппаратных потоков
+	explicit WorkStealingPool(unsigned threadCount = 0);
+	~WorkStealingPool();
+	WorkStealingPool(WorkStealingPool&) = delete;
+
+	// Блокирует до завершения всех кусков; вызывающий поток работает как поток 0.
+	// Вызовы из разных потоков выполняются по очереди (и те, что из-за малого
+	// count выполняются целиком в вызывающем потоке). Вызов из func в тот же
+	// пул блокируется навсегда
+	void parallelFor(size_t count, size_t grain, const RangeFunc& func);
+
+	unsigned threadCount() const { return workerCount; }
+	uint64_t stealCount() const { return steals.load(std::memory_order_relaxed); }
+
+private:
+	struct alignas(64) ChunkQueue {
+		std::atomic<uint64_t> range{ 0 };	// (begin << 32) | end, в кусках
+	};
+
+	static uint64_t pack(uint32_t begin, uint32_t end) { return (uint64_t(begin) << 32) | end; }
+
+	void workerLoop(unsigned worker);
+	void runChunks(unsigned worker);
+	bool popLocal(unsigned worker, uint32_t& chunk);
+	bool steal(unsigned thief, uint32_t& chunk);
+
+	unsigned workerCount = 1;
+	std::vector<std::thread> threads;
+	std::unique_ptr<ChunkQueue[]> queues;
+
+	// Текущее задание
+	const RangeFunc* job = nullptr;
+	size_t jobCount = 0;
+	size_t jobGrain = 1;
+	std::atomic<size_t> remainingChunks{ 0 };
+	std::atomic<unsigned> busyWorkers{ 0 };
+	std::atomic<uint64_t> steals{ 0 };
+
+	std::mutex callMutex;	// один parallelFor за раз
+	std::mutex mutex;
+	std::condition_variable wake;
+	uint64_t generation = 0;
+	bool stopping = false;
+};
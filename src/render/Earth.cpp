@@ -1,5 +1,6 @@
 #include "Earth.h"
 #include "Shaders.h"
+#include "Frustum.h"
 
 #define _USE_MATH_DEFINES
 #include <math.h>
@@ -7,43 +8,84 @@
 #include <SDL3/SDL.h>
 #include <glm/gtc/matrix_transform.hpp>
 
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
-
+#include <algorithm>
 #include <iostream>
 
-Earth::Earth()
+namespace {
+
+    // Матрица нормалей transpose(inverse(M)); для ортонормированной M (поворот)
+    // она совпадает с самой M, и обращение не нужно
+    glm::mat3 normalMatrixOf(const glm::mat4& model)
+    {
+        glm::mat3 m(model);
+        glm::mat3 gram = glm::transpose(m) * m;
+        const float eps = 1e-6f;
+        bool orthonormal = true;
+        for (int i = 0; i < 3; i++)
+            for (int j = 0; j < 3; j++)
+                orthonormal = orthonormal && std::fabs(gram[i][j] - (i == j ? 1.0f : 0.0f)) < eps;
+        return orthonormal ? m : glm::transpose(glm::inverse(m));
+    }
+
+    // Точка единичной сферы так же, как в genarateSphereVertices
+    glm::vec3 spherePoint(float theta, float phi)
+    {
+        return glm::vec3(sin(theta) * cos(phi), cos(theta), sin(theta) * sin(phi));
+    }
+
+}
+
+Earth::Earth(TextureLoader& textures, int maxSegments)
+    : lineShader(Shader::create("res/shaders/line.vert", "res/shaders/line.frag"))
 {
-    genarateSphereVertices();
-    loadTexture("res/textures/earth_day.jpg", textureDay);
-    loadTexture("res/textures/earth_night.jpg", textureNight);
+    normalMatrix = normalMatrixOf(model);
+
+    // Все уровни - в одном буфере вершин и одном буфере индексов
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    for (int segments = minSegments; segments <= maxSegments; segments *= 2) {
+        Lod lod;
+        lod.segments = segments;
+        lod.firstIndex = indices.size();
+        lod.patchIndices = static_cast<size_t>(segments / patchGrid) * (segments / patchGrid) * 6;
+        genarateSphereVertices(segments, vertices, indices);
+        lods.push_back(lod);
+    }
+    generatePatches();
+
+    loadMaps(textures);
+    if (VirtualTexture::exists(dayTilesPath)) {
+        dayTiles = std::make_unique<VirtualTexture>(dayTilesPath);
+        if (!dayTiles->valid())
+            dayTiles.reset();
+    }
 
-    //  vao, vbo
+    // создание vao, vbo
     glGenVertexArrays(1, &vao);
     glGenBuffers(1, &vbo);
     glGenBuffers(1, &ebo);
     
     glBindVertexArray(vao);
     
-    //  vbo 
+    // Заполняем vbo вершинами
     glBindBuffer(GL_ARRAY_BUFFER, vbo);
     glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
 
-    //  ebo 
+    // заполняем ebo индексами
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), 
         indices.data(), GL_STATIC_DRAW);
 
-    //   
-    //  (location = 0)
+    // Атрибуты вершин 
+    // позиция (location = 0)
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
     
-    // UV- (location = 1)
+    // UV-координаты (location = 1)
     glEnableVertexAttribArray(1);
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, uv));
 
-    //  (location = 2)
+    // Нормали (location = 2)
     glEnableVertexAttribArray(2);
     glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
 
@@ -51,7 +93,7 @@ Earth::Earth()
 
     generateMeridianVertices();
 
-    //    
+    // Создание буферов для меридиана
     glGenVertexArrays(1, &meridianVAO);
     glGenBuffers(1, &meridianVBO);
 
@@ -63,108 +105,135 @@ Earth::Earth()
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
 
     glBindVertexArray(0);
-
-    //    
-    lineShader = Shader::create("res/shaders/line.vert", "res/shaders/line.frag");
 }
 
 Earth::~Earth()
 {
-    glDeleteTextures(1, &textureDay);
-    glDeleteTextures(1, &textureNight);
+    glDeleteTextures(1, &textureMaps);
     glDeleteBuffers(1, &vbo);
     glDeleteBuffers(1, &ebo);
     glDeleteVertexArrays(1, &vao);
 
     glDeleteVertexArrays(1, &meridianVAO);
     glDeleteBuffers(1, &meridianVBO);
-    glDeleteProgram(lineShader);
 }
 
-void Earth::loadTexture(const std::string& texturePath, GLuint& texture)
+void Earth::loadMaps(TextureLoader& textures)
 {
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
-
-    //  
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    //  
-    int width, height, channels;
-    
-    unsigned char* data = stbi_load(texturePath.c_str(), &width, &height, &channels, 0);
-    if (!data) {
-        std::cerr << "Can't load texture: " << texturePath << std::endl;
-        return;
-    }
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0,
-        channels == 4 ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-
-    stbi_image_free(data);
+    glGenTextures(1, &textureMaps);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, textureMaps);
+
+    // Настройки фильтрации
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // Загрузка слоёв с готовыми mip-уровнями (из кэша или с его созданием) - в фоне;
+    // ночная карта меньше дневной и приводится к её размеру.
+    // Пока грузятся: днём - цвет океана, ночью - темнота
+    std::vector<std::string> paths(static_cast<size_t>(MapLayer::Count));
+    std::vector<glm::vec3> placeholders(paths.size());
+    paths[static_cast<size_t>(MapLayer::Day)] = "res/textures/earth_day.jpg";
+    placeholders[static_cast<size_t>(MapLayer::Day)] = glm::vec3(0.08f, 0.18f, 0.38f);
+    paths[static_cast<size_t>(MapLayer::Night)] = "res/textures/earth_night.jpg";
+    placeholders[static_cast<size_t>(MapLayer::Night)] = glm::vec3(0.0f);
+    textures.requestLayers(paths, textureMaps, placeholders);
 }
 
-void Earth::genarateSphereVertices()
+void Earth::genarateSphereVertices(int segments, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
 {
-    //  
+    unsigned int base = static_cast<unsigned int>(vertices.size());
+
+    // Генерация вершин
     for (int lat = 0; lat <= segments; ++lat) {
         float theta = lat * M_PI / segments; // [0, pi]
         for (int lon = 0; lon <= segments; ++lon) {
             float phi = lon * 2 * M_PI / segments; // [0, 2pi]
 
             Vertex v;
-            //  (  -> 
+            // Позиция (сферические координаты -> декартовы
             v.position = glm::vec3(
                 sin(theta) * cos(phi),
                 cos(theta),
                 sin(theta) * sin(phi)
             );
-            // UV- 
+            // UV-координаты 
             v.uv = glm::vec2(
                 0.75f - static_cast<float>(lon) / segments,
                 static_cast<float>(lat) / segments
             );
-            //  =  
+            // нормаль = нормализованная позиция
             v.normal = glm::normalize(v.position);
 
             vertices.push_back(v);
         }
     }
 
-    //  
-    for (int lat = 0; lat < segments; ++lat) {
-        for (int lon = 0; lon < segments; ++lon) {
-            int first = (lat * (segments + 1)) + lon;
-            int second = first + segments + 1;
-
-            // k1 -- k1+1
-            // |   /  |
-            // |  /   |
-            // k2 -- k2+1
-            //   . 
-
-            indices.push_back(first);
-            indices.push_back(first + 1);
-            indices.push_back(second);
-            
-            indices.push_back(first + 1);
-            indices.push_back(second + 1);
-            indices.push_back(second);
-            
-            
+    // Генерация индексов: участок за участком, чтобы индексы каждого
+    // шли одним диапазоном (порядок участков - как в generatePatches)
+    int step = segments / patchGrid;
+    for (int patch = 0; patch < patchGrid * patchGrid; ++patch) {
+        int latBegin = (patch / patchGrid) * step;
+        int lonBegin = (patch % patchGrid) * step;
+        for (int lat = latBegin; lat < latBegin + step; ++lat) {
+            for (int lon = lonBegin; lon < lonBegin + step; ++lon) {
+                unsigned int first = base + (lat * (segments + 1)) + lon;
+                unsigned int second = first + segments + 1;
+
+                // k1 -- k1+1
+                // |   /  |
+                // |  /   |
+                // k2 -- k2+1
+                // порядок против час. стрелки
+
+                indices.push_back(first);
+                indices.push_back(first + 1);
+                indices.push_back(second);
+
+                indices.push_back(first + 1);
+                indices.push_back(second + 1);
+                indices.push_back(second);
+            }
+        }
+    }
+}
+
+void Earth::generatePatches()
+{
+    // Границы участков по широте и долготе; угловой радиус - по точкам границы
+    // (дальняя от середины точка участка-трапеции лежит на ней)
+    const int samples = 16;
+    float latStep = M_PI / patchGrid, lonStep = 2 * M_PI / patchGrid;
+    for (int patch = 0; patch < patchGrid * patchGrid; ++patch) {
+        float theta0 = (patch / patchGrid) * latStep;
+        float phi0 = (patch % patchGrid) * lonStep;
+
+        Patch p;
+        p.center = spherePoint(theta0 + latStep / 2, phi0 + lonStep / 2);
+        float minCos = 1.0f;
+        for (int k = 0; k <= samples; ++k) {
+            float t = static_cast<float>(k) / samples;
+            glm::vec3 edge[4] = {
+                spherePoint(theta0, phi0 + t * lonStep),
+                spherePoint(theta0 + latStep, phi0 + t * lonStep),
+                spherePoint(theta0 + t * latStep, phi0),
+                spherePoint(theta0 + t * latStep, phi0 + lonStep),
+            };
+            for (const glm::vec3& point : edge)
+                minCos = std::min(minCos, glm::dot(point, p.center));
         }
+        p.angularRadius = acos(glm::clamp(minCos, -1.0f, 1.0f));
+        patches.push_back(p);
     }
 }
 
 void Earth::generateMeridianVertices()
 {
-    const float radius = 1.01f; //    
+    const float radius = 1.01f; // Немного больше радиуса Земли
 
-    for (int i = 0; i <= segments; ++i) {
-        float theta = i * M_PI / segments;
+    for (int i = 0; i <= meridianSegments; ++i) {
+        float theta = i * M_PI / meridianSegments;
         meridianVertices.push_back(glm::vec3(
             0.0f,
             radius * cos(theta),
@@ -173,45 +242,104 @@ void Earth::generateMeridianVertices()
     }
 }
 
-void Earth::render(const glm::mat4& view, const glm::mat4& projection, GLuint shader) const
+int Earth::selectLod(float distance, float fov, int viewportHeight) const
+{
+    // Пикселей экрана на радиус Земли у ближайшей к камере точки поверхности
+    float altitude = std::max(distance - 1.0f, 1e-4f);
+    float pixelsPerUnit = viewportHeight / (2.0f * tan(fov / 2) * altitude);
+
+    // Наибольшее отклонение хорды от окружности при шаге 2pi/segments
+    for (size_t level = 0; level < lods.size(); ++level) {
+        float sagitta = 1.0f - cos(M_PI / lods[level].segments);
+        if (sagitta * pixelsPerUnit <= maxPixelError)
+            return static_cast<int>(level);
+    }
+    return static_cast<int>(lods.size()) - 1;
+}
+
+void Earth::stream(const Camera& camera)
+{
+    if (dayTiles)
+        dayTiles->update(camera, model);
+}
+
+Earth::RenderStats Earth::render(const ShaderProgram& shader, const Camera& camera) const
 {
-    glUseProgram(shader);
+    RenderStats stats;
+
+    // Камера в системе модели: сфера там единичная
+    glm::vec3 eye = glm::vec3(glm::inverse(model) * glm::vec4(camera.getPosition(), 1.0f));
+    float distance = glm::length(eye);
+    const Lod& lod = lods[selectLod(distance, camera.getFov(), camera.getViewportHeight())];
+
+    Frustum frustum(camera.getProjection() * camera.getView() * model);
+
+    // Грани уровня отклоняются от нормали сферы до половины шага сетки
+    float facet = M_PI / lod.segments;
 
-    glm::vec3 viewPos = glm::vec3(-view[3][0], -view[3][1], -view[3][2]);
+    shader.use();
 
-    //    
-    Shader::setMat4(shader, "model", model);
-    Shader::setMat4(shader, "view", view);
-    Shader::setMat4(shader, "projection", projection);
-    Shader::setVec3(shader, "viewPos", viewPos);
+    // Передача матрицы модели в шейдер
+    shader.set(Uniform::Model, model);
+    shader.set(Uniform::NormalMatrix, normalMatrix);
 
-    //  
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, textureDay);
-    glUniform1i(glGetUniformLocation(shader, "dayEarthTexture"), 0);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, textureNight);
-    glUniform1i(glGetUniformLocation(shader, "nightEarthTexture"), 1);
+    // Привязка текстуры: sampler-переменные уже смотрят на свои блоки (ShaderProgram)
+    glActiveTexture(GL_TEXTURE0 + static_cast<GLint>(TextureUnit::EarthMaps));
+    glBindTexture(GL_TEXTURE_2D_ARRAY, textureMaps);
+    if (dayTiles)
+        dayTiles->bind(shader);
+    else
+        shader.set(Uniform::VirtualMaxLevel, -1);
 
-    //  
+    // Отрисовка: подряд идущие видимые участки - одним вызовом
     glBindVertexArray(vao);
-    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
+    size_t runBegin = 0, runCount = 0;
+    auto flush = [&]() {
+        if (runCount == 0)
+            return;
+        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(runCount), GL_UNSIGNED_INT,
+            (void*)(runBegin * sizeof(unsigned int)));
+        stats.drawCalls++;
+        runCount = 0;
+    };
+    for (size_t i = 0; i < patches.size(); ++i) {
+        const Patch& patch = patches[i];
+
+        // За горизонтом (с запасом на грани) или вне пирамиды: ограничивающий
+        // шар участка - с центром на поверхности и радиусом по хорде до дальней точки
+        bool visible = Frustum::capAboveHorizon(eye, patch.center, patch.angularRadius + facet)
+            && frustum.intersectsSphere(patch.center, 2.0f * sin(patch.angularRadius / 2));
+
+        if (!visible) {
+            flush();
+            continue;
+        }
+        size_t first = lod.firstIndex + i * lod.patchIndices;
+        if (runCount == 0)
+            runBegin = first;
+        runCount += lod.patchIndices;
+        stats.patches++;
+    }
+    flush();
     glBindVertexArray(0);
 
+    stats.segments = lod.segments;
+    stats.triangles = static_cast<size_t>(stats.patches) * lod.patchIndices / 3;
 
-    //  
+
+    // Отрисовка меридиана
     //glDisable(GL_DEPTH_TEST);
     
-    //glUseProgram(lineShader);
-    //Shader::setMat4(lineShader, "model", model);
-    //Shader::setMat4(lineShader, "view", view);
-    //Shader::setMat4(lineShader, "projection", projection);
-    //Shader::setVec3(lineShader, "lineColor", glm::vec3(1.0f, 0.0f, 0.0f)); //  
+    //lineShader.use();
+    //lineShader.set(Uniform::Model, model);
+    //lineShader.set(Uniform::LineColor, glm::vec3(1.0f, 0.0f, 0.0f)); // Красный цвет
 
     //glBindVertexArray(meridianVAO);
     //glDrawArrays(GL_LINE_STRIP, 0, meridianVertices.size());
     //glBindVertexArray(0);
 
-    //glUseProgram(shader);
+    //shader.use();
     //glEnable(GL_DEPTH_TEST);
+
+    return stats;
 }
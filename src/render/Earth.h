@@ -2,40 +2,101 @@
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
+#include <memory>
 #include <vector>
 #include <string>
 
+#include "Shaders.h"
+#include "TextureLoader.h"
+#include "VirtualTexture.h"
+#include "../Camera.h"
+
 struct Vertex {
-	glm::vec3 position;	//  (x, y, z) 
-	glm::vec2 uv;		//   (u, v)
-	glm::vec3 normal;	//  ( )
+	glm::vec3 position;	// позиция (x, y, z) 
+	glm::vec2 uv;		// текстурные координаты (u, v)
+	glm::vec3 normal;	// нормаль (для освещения)
 };
 
+// Сфера с заранее построенными уровнями детализации (UV-сетки от minSegments
+// до maxSegments, вдвое гуще на каждом уровне). Уровень выбирается за кадр
+// по расстоянию камеры до поверхности так, чтобы отклонение граней от сферы
+// было не больше maxPixelError пикселя на экране. Каждый уровень разбит на
+// patchGrid x patchGrid участков с непрерывными диапазонами индексов: участки
+// вне пирамиды видимости и за горизонтом не рисуются, соседние видимые
+// сливаются в один вызов. Уровень на всю сферу один - швов между участками нет.
+// Если рядом с текстурами есть пирамида тайлов dayTilesPath (VirtualTexture::build),
+// дневная сторона рисуется из неё, а слой дня остаётся запасным вариантом.
+// Карты поверхности - слои одного массива текстур (MapLayer) на блоке
+// TextureUnit::EarthMaps: за отрисовку одна привязка текстуры
 class Earth
 {
 public:
-	Earth();
+	struct RenderStats {
+		int segments = 0;
+		int patches = 0;	// нарисованные участки
+		int drawCalls = 0;
+		size_t triangles = 0;
+	};
+
+	static constexpr int minSegments = 32;
+	static constexpr int patchGrid = 8;
+	static constexpr float maxPixelError = 0.5f;
+	static constexpr const char* dayTilesPath = "res/textures/tiles/earth_day";
+
+	// Порядок слоёв совпадает с индексами в earth.frag
+	enum class MapLayer : int {
+		Day = 0,
+		Night = 1,
+		Count
+	};
+
+	// maxSegments - самый подробный уровень (степень двойки от minSegments);
+	// текстуры догружаются через textures, до того видны заглушки
+	explicit Earth(TextureLoader& textures, int maxSegments = 256);
 	Earth(Earth&) = delete;
 	~Earth();
 	
-	void render(const glm::mat4& view, const glm::mat4& projection, GLuint shader) const;
+	// Камера и освещение - из блоков Camera и Lighting (FrameUniforms);
+	// от camera - положение и проекция для выбора уровня и отсечения
+	RenderStats render(const ShaderProgram& shader, const Camera& camera) const;
+
+	// Подкачка тайлов дневной текстуры под камеру; раз за кадр до render()
+	void stream(const Camera& camera);
+	// nullptr - пирамиды тайлов нет
+	const VirtualTexture* getDayTiles() const { return dayTiles.get(); }
+
+	// Уровень детализации по расстоянию от центра (в радиусах Земли)
+	int selectLod(float distance, float fov, int viewportHeight) const;
 
 private:
-	std::vector<Vertex> vertices; 
-	std::vector<unsigned int> indices;
-	GLuint textureDay;
-	GLuint textureNight;
+	struct Patch {
+		glm::vec3 center;		// направление на середину участка
+		float angularRadius;	// угол от center до дальней точки участка
+	};
+
+	struct Lod {
+		int segments;
+		size_t firstIndex;		// начало уровня в общем буфере индексов
+		size_t patchIndices;	// индексов на участок
+	};
+
+	GLuint textureMaps;	// GL_TEXTURE_2D_ARRAY, слои MapLayer
+	std::unique_ptr<VirtualTexture> dayTiles;
 	GLuint vao, vbo, ebo;
 
-	int segments = 64;
+	std::vector<Lod> lods;
+	std::vector<Patch> patches;	// общие для всех уровней: границы участков совпадают
 
-	void loadTexture(const std::string& texturePath, GLuint& texture);
-	void genarateSphereVertices();
+	void loadMaps(TextureLoader& textures);
+	void genarateSphereVertices(int segments, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+	void generatePatches();
 
 	GLuint meridianVAO, meridianVBO;
 	std::vector<glm::vec3> meridianVertices;
-	GLuint lineShader;
+	int meridianSegments = 64;
+	ShaderProgram lineShader;
 	void generateMeridianVertices();
 
-	glm::mat4 model = glm::mat4(1.0f); //  
+	glm::mat4 model = glm::mat4(1.0f); // матрица модели
+	glm::mat3 normalMatrix = glm::mat3(1.0f); // для нормалей, от model
 };
\ No newline at end of file
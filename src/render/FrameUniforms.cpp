@@ -0,0 +1,67 @@
+#include "FrameUniforms.h"
+#include "Shaders.h"
+
+static_assert(sizeof(FrameUniforms::CameraBlock) == 144, "CameraBlock must follow std140");
+static_assert(sizeof(FrameUniforms::LightingBlock) == 48, "LightingBlock must follow std140");
+
+FrameUniforms::FrameUniforms()
+{
+    glGenBuffers(1, &cameraUbo);
+    glBindBuffer(GL_UNIFORM_BUFFER, cameraUbo);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraBlock), nullptr, GL_DYNAMIC_DRAW);
+
+    glGenBuffers(1, &lightingUbo);
+    glBindBuffer(GL_UNIFORM_BUFFER, lightingUbo);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(LightingBlock), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    // Точки привязки общие для контекста - достаточно один раз
+    glBindBufferBase(GL_UNIFORM_BUFFER, static_cast<GLuint>(UniformBlock::Camera), cameraUbo);
+    glBindBufferBase(GL_UNIFORM_BUFFER, static_cast<GLuint>(UniformBlock::Lighting), lightingUbo);
+}
+
+FrameUniforms::~FrameUniforms()
+{
+    glDeleteBuffers(1, &cameraUbo);
+    glDeleteBuffers(1, &lightingUbo);
+}
+
+void FrameUniforms::setCamera(const glm::mat4& view, const glm::mat4& projection)
+{
+    camera.view = view;
+    camera.projection = projection;
+    // Положение камеры - перенос обратной матрицы вида
+    camera.viewPos = glm::vec3(glm::inverse(view)[3]);
+    cameraDirty = true;
+}
+
+void FrameUniforms::setLightPosition(const glm::vec3& position)
+{
+    lighting.lightPos = position;
+    lightingDirty = true;
+}
+
+void FrameUniforms::setLighting(const glm::vec3& color, float ambientStrength, float specularStrength,
+    float nightIntensity)
+{
+    lighting.lightColor = color;
+    lighting.ambientStrength = ambientStrength;
+    lighting.specularStrength = specularStrength;
+    lighting.nightIntensity = nightIntensity;
+    lightingDirty = true;
+}
+
+void FrameUniforms::upload()
+{
+    if (cameraDirty) {
+        glBindBuffer(GL_UNIFORM_BUFFER, cameraUbo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CameraBlock), &camera);
+        cameraDirty = false;
+    }
+    if (lightingDirty) {
+        glBindBuffer(GL_UNIFORM_BUFFER, lightingUbo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(LightingBlock), &lighting);
+        lightingDirty = false;
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Общее для всех программ состояние кадра: камера и освещение в блоках
+// uniform (std140). Значения копятся на CPU и уходят на GPU одним
+// glBufferSubData на блок в upload(), только если что-то изменилось;
+// буферы привязаны к точкам UniformBlock один раз при создании
+class FrameUniforms
+{
+public:
+	// Раскладка std140: vec3 выравнивается на 16 байт, следующий за ним
+	// float занимает его четвёртую компоненту. Порядок полей совпадает с
+	// блоками Camera и Lighting в шейдерах
+	struct CameraBlock {
+		glm::mat4 view = glm::mat4(1.0f);
+		glm::mat4 projection = glm::mat4(1.0f);
+		glm::vec3 viewPos = glm::vec3(0.0f);
+		float padding = 0.0f;
+	};
+
+	struct LightingBlock {
+		glm::vec3 lightPos = glm::vec3(0.0f);	// система сцены
+		float ambientStrength = 0.05f;
+		glm::vec3 lightColor = glm::vec3(1.0f);
+		float specularStrength = 0.1f;
+		float nightIntensity = 0.4f;
+		float padding[3] = { 0.0f, 0.0f, 0.0f };
+	};
+
+	FrameUniforms();
+	FrameUniforms(FrameUniforms&) = delete;
+	~FrameUniforms();
+
+	void setCamera(const glm::mat4& view, const glm::mat4& projection);
+	void setLightPosition(const glm::vec3& position);
+	void setLighting(const glm::vec3& color, float ambientStrength, float specularStrength, float nightIntensity);
+
+	void upload();
+
+private:
+	GLuint cameraUbo, lightingUbo;
+	CameraBlock camera;
+	LightingBlock lighting;
+	bool cameraDirty = true, lightingDirty = true;
+};
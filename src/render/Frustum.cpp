@@ -0,0 +1,38 @@
+#include "Frustum.h"
+
+#include <algorithm>
+#include <cmath>
+
+Frustum::Frustum(const glm::mat4& clip)
+{
+    // Плоскости по Gribb, Hartmann: точка внутри, если dot(xyz, p) + w >= 0 для всех шести
+    glm::vec4 row[4];
+    for (int i = 0; i < 4; i++)
+        row[i] = glm::vec4(clip[0][i], clip[1][i], clip[2][i], clip[3][i]);
+    for (int i = 0; i < 3; i++) {
+        planes[2 * i] = row[3] + row[i];
+        planes[2 * i + 1] = row[3] - row[i];
+    }
+    for (int i = 0; i < 6; i++)
+        planes[i] /= glm::length(glm::vec3(planes[i]));
+}
+
+bool Frustum::intersectsSphere(const glm::vec3& center, float radius) const
+{
+    for (int i = 0; i < 6; i++) {
+        if (glm::dot(glm::vec3(planes[i]), center) + planes[i].w < -radius)
+            return false;
+    }
+    return true;
+}
+
+bool Frustum::capAboveHorizon(const glm::vec3& eye, const glm::vec3& center, float angularRadius)
+{
+    // Самая близкая к камере точка шапки видна, только если dot(p, eye) > 1
+    float distance = glm::length(eye);
+    if (distance <= 1.0f)
+        return true;
+    float angle = std::acos(glm::clamp(glm::dot(center, eye / distance), -1.0f, 1.0f));
+    float closest = std::max(0.0f, angle - angularRadius);
+    return distance * std::cos(closest) > 1.0f;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// Отсечение для участков единичной сферы: пирамида видимости из матрицы
+// clip = P * V * M и горизон сферы. Используется Earth для участков сетки
+// и VirtualTexture для тайлов
+class Frustum
+{
+public:
+	explicit Frustum(const glm::mat4& clip);
+
+	bool intersectsSphere(const glm::vec3& center, float radius) const;
+
+	// Шапка сферы (направление center, угловой радиус) хотя бы частично над
+	// горизонтом камеры eye (в системе модели). Камера внутри сферы - видно всё
+	static bool capAboveHorizon(const glm::vec3& eye, const glm::vec3& center, float angularRadius);
+
+private:
+	glm::vec4 planes[6];
+};
@@ -0,0 +1,229 @@
+#include "GpuPropagator.h"
+#include "Shaders.h"
+#include "../orbit/Frames.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+    const int texelsPerObject = 9;
+    const int floatsPerObject = texelsPerObject * 4;
+
+    double fmod2pi(double x)
+    {
+        const double twoPi = 2.0 * M_PI;
+        return x - twoPi * std::floor(x / twoPi);
+    }
+
+    // Поворот TEME -> сцена на момент jd с переводом км в радиусы Земли
+    glm::mat3 temeToSceneMatrix(double jd)
+    {
+        glm::mat3 m;
+        for (int axis = 0; axis < 3; axis++) {
+            glm::dvec3 unit(0.0);
+            unit[axis] = 1.0;
+            m[axis] = Frames::ecefToScene(Frames::temeToEcef(unit, jd));
+        }
+        return m;
+    }
+
+}
+
+GpuPropagator::GpuPropagator()
+    : program(Shader::createFeedback("res/shaders/sgp4.vert", { "outPosition", "outLight" }))
+{
+    // Вершинных атрибутов нет, но в core profile рисовать без VAO нельзя
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &coefficientBuffer);
+    glGenTextures(1, &coefficientTexture);
+    glGenBuffers(1, &positions);
+    glGenBuffers(1, &lighting);
+
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+}
+
+GpuPropagator::~GpuPropagator()
+{
+    glDeleteBuffers(1, &coefficientBuffer);
+    glDeleteTextures(1, &coefficientTexture);
+    glDeleteBuffers(1, &positions);
+    glDeleteBuffers(1, &lighting);
+    glDeleteVertexArrays(1, &vao);
+}
+
+bool GpuPropagator::upload(const Sgp4Batch& batch, const JulianDate& referenceJd)
+{
+    const Sgp4Batch::NearColumns& c = batch.nearColumns();
+    size_t count = batch.nearCount();
+    if (static_cast<double>(count) * texelsPerObject > static_cast<double>(maxTexels))
+        return false;
+
+    // Угловые элементы - на опорный момент в двойной точности, остальное как есть.
+    // Порядок полей совпадает с разбором текселей c0..c8 в sgp4.vert
+    packed.assign(count * floatsPerObject, 0.0f);
+    for (size_t i = 0; i < count; i++) {
+        double tRef = ((referenceJd.day - c.epochDay[i]) + (referenceJd.fraction - c.epochFraction[i])) * 1440.0;
+        double values[floatsPerObject] = {
+            tRef,
+            fmod2pi(c.mo[i] + c.mdot[i] * tRef), c.mdot[i],
+            fmod2pi(c.argpo[i] + c.argpdot[i] * tRef),
+            c.argpdot[i],
+            fmod2pi(c.nodeo[i] + c.nodedot[i] * tRef + c.nodecf[i] * tRef * tRef),
+            c.nodedot[i] + 2.0 * c.nodecf[i] * tRef, c.nodecf[i],
+            c.bstar[i], c.cc1[i], c.cc4[i], c.cc5[i],
+            c.t2cof[i], c.t3cof[i], c.t4cof[i], c.t5cof[i],
+            c.d2[i], c.d3[i], c.d4[i], c.omgcof[i],
+            c.xmcof[i], c.eta[i], c.delmo[i], c.sinmao[i],
+            c.aBase[i], c.noUnkozai[i], c.ecco[i], c.inclo[i],
+            c.cosio[i], c.sinio[i], c.aycof[i], c.xlcof[i],
+            c.con41[i], c.x1mth2[i], c.x7thm1[i], 0.0,
+        };
+        float* out = packed.data() + i * floatsPerObject;
+        for (int k = 0; k < floatsPerObject; k++)
+            out[k] = static_cast<float>(values[k]);
+    }
+
+    glBindBuffer(GL_TEXTURE_BUFFER, coefficientBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, packed.size() * sizeof(float), packed.data(), GL_STATIC_DRAW);
+    glBindTexture(GL_TEXTURE_BUFFER, coefficientTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, coefficientBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    // Выходные буферы: околоземные объекты пишет GPU, хвост глубокого космоса - CPU
+    if (batch.version() != builtVersion || !built) {
+        glBindBuffer(GL_ARRAY_BUFFER, positions);
+        glBufferData(GL_ARRAY_BUFFER, batch.size() * 3 * sizeof(float), nullptr, GL_DYNAMIC_COPY);
+        glBindBuffer(GL_ARRAY_BUFFER, lighting);
+        glBufferData(GL_ARRAY_BUFFER, batch.size() * sizeof(float), nullptr, GL_DYNAMIC_COPY);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    this->referenceJd = referenceJd;
+    nearCount = count;
+    objectCount = batch.size();
+    objectSlots = batch.slots();
+    builtVersion = batch.version();
+    built = true;
+    return true;
+}
+
+bool GpuPropagator::propagate(const Sgp4Batch& batch, const JulianDate& jd)
+{
+    if (!built || batch.version() != builtVersion || std::fabs(jd.daysSince(referenceJd)) > rebaseDays) {
+        if (!upload(batch, jd)) {
+            built = false;
+            objectCount = 0;
+            return false;
+        }
+    }
+    lastJd = jd;
+
+    glm::dvec3 sun = Illumination::sunPosition(jd);
+
+    if (nearCount > 0) {
+        program.use();
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_BUFFER, coefficientTexture);
+        program.set(Uniform::Coefficients, 0);
+        program.set(Uniform::Minutes, static_cast<float>(jd.daysSince(referenceJd) * 1440.0));
+        program.set(Uniform::TemeToScene, temeToSceneMatrix(jd.value()));
+        program.set(Uniform::SunPosition, glm::vec3(sun));
+        program.set(Uniform::Xke, static_cast<float>(Sgp4::xke()));
+        program.set(Uniform::J2, static_cast<float>(Sgp4::j2));
+        program.set(Uniform::EarthRadius, static_cast<float>(Sgp4::earthRadiusKm));
+        program.set(Uniform::SunRadius, static_cast<float>(Illumination::sunRadiusKm));
+
+        glBindBufferRange(GL_TRANSFORM_FEEDBACK_BUFFER, 0, positions, 0, nearCount * 3 * sizeof(float));
+        glBindBufferRange(GL_TRANSFORM_FEEDBACK_BUFFER, 1, lighting, 0, nearCount * sizeof(float));
+
+        // Растеризация не нужна: результат - только буферы
+        glEnable(GL_RASTERIZER_DISCARD);
+        glBindVertexArray(vao);
+        glBeginTransformFeedback(GL_POINTS);
+        glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(nearCount));
+        glEndTransformFeedback();
+        glBindVertexArray(0);
+        glDisable(GL_RASTERIZER_DISCARD);
+
+        glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+        glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 1, 0);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+    }
+
+    propagateDeep(batch, jd);
+    return true;
+}
+
+void GpuPropagator::propagateDeep(const Sgp4Batch& batch, const JulianDate& jd)
+{
+    size_t deep = objectCount - nearCount;
+    if (deep == 0)
+        return;
+
+    deepStates.resize(batch.size());
+    batch.propagateRange(jd, nearCount, objectCount, deepStates);
+
+    deepTeme.resize(deep * 3);
+    deepScene.resize(deep * 3);
+    deepLight.resize(deep);
+    deepShadow.resize(deep);
+    for (size_t i = 0; i < deep; i++) {
+        deepTeme[3 * i] = static_cast<float>(deepStates.x[nearCount + i]);
+        deepTeme[3 * i + 1] = static_cast<float>(deepStates.y[nearCount + i]);
+        deepTeme[3 * i + 2] = static_cast<float>(deepStates.z[nearCount + i]);
+    }
+    Frames::temeToScene(jd.value(), deep, deepTeme.data(), deepScene.data());
+    Illumination::shadow(Illumination::sunPosition(jd), deep, deepTeme.data(),
+        deepLight.data(), deepShadow.data());
+    for (size_t i = 0; i < deep; i++)
+        deepLight[i] = deepStates.error[nearCount + i] != 0 ? -1.0f : deepLight[i];
+
+    glBindBuffer(GL_ARRAY_BUFFER, positions);
+    glBufferSubData(GL_ARRAY_BUFFER, nearCount * 3 * sizeof(float), deep * 3 * sizeof(float), deepScene.data());
+    glBindBuffer(GL_ARRAY_BUFFER, lighting);
+    glBufferSubData(GL_ARRAY_BUFFER, nearCount * sizeof(float), deep * sizeof(float), deepLight.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+GpuPropagator::CrossCheck GpuPropagator::crossCheck(const Sgp4Batch& batch) const
+{
+    CrossCheck result;
+    if (!built || nearCount == 0 || batch.version() != builtVersion)
+        return result;
+
+    std::vector<float> gpuPositions(nearCount * 3), gpuLight(nearCount);
+    glBindBuffer(GL_ARRAY_BUFFER, positions);
+    glGetBufferSubData(GL_ARRAY_BUFFER, 0, gpuPositions.size() * sizeof(float), gpuPositions.data());
+    glBindBuffer(GL_ARRAY_BUFFER, lighting);
+    glGetBufferSubData(GL_ARRAY_BUFFER, 0, gpuLight.size() * sizeof(float), gpuLight.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    Sgp4Batch::States states;
+    states.resize(batch.size());
+    batch.propagateRange(lastJd, 0, nearCount, states);
+
+    std::vector<float> teme(nearCount * 3), scene(nearCount * 3);
+    for (size_t i = 0; i < nearCount; i++) {
+        teme[3 * i] = static_cast<float>(states.x[i]);
+        teme[3 * i + 1] = static_cast<float>(states.y[i]);
+        teme[3 * i + 2] = static_cast<float>(states.z[i]);
+    }
+    Frames::temeToScene(lastJd.value(), nearCount, teme.data(), scene.data());
+
+    double sumSquares = 0.0;
+    for (size_t i = 0; i < nearCount; i++) {
+        if (states.error[i] != 0 || gpuLight[i] < 0.0f)
+            continue;
+        glm::dvec3 cpu(scene[3 * i], scene[3 * i + 1], scene[3 * i + 2]);
+        glm::dvec3 gpu(gpuPositions[3 * i], gpuPositions[3 * i + 1], gpuPositions[3 * i + 2]);
+        double error = glm::length(cpu - gpu) * Frames::wgs84A;
+        result.maxErrorKm = std::max(result.maxErrorKm, error);
+        sumSquares += error * error;
+        result.compared++;
+    }
+    if (result.compared > 0)
+        result.rmsErrorKm = std::sqrt(sumSquares / result.compared);
+    return result;
+}
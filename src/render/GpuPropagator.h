@@ -0,0 +1,72 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "Shaders.h"
+#include "../orbit/Illumination.h"
+#include "../orbit/Sgp4Batch.h"
+
+// Распространение орбит для отображения на GPU (GL 3.3, transform feedback).
+// Коэффициенты околоземных объектов пакета один раз загружаются в буферную
+// текстуру, и вершинный шейдер res/shaders/sgp4.vert пишет положения в системе
+// сцены и освещённость прямо в буферы, из которых рисует Satellites; за кадр
+// CPU передаёт только время и поворот Земли. Точность - одинарная, порядка
+// километра: для отображения, не для расчётов. Угловые элементы приводятся к
+// опорному моменту, который переносится раз в rebaseDays модельного времени.
+// Объекты глубокого космоса (SDP4) считаются на CPU и дописываются в хвост тех
+// же буферов - их в каталоге единицы процентов
+class GpuPropagator
+{
+public:
+	struct CrossCheck {
+		size_t compared = 0;
+		double maxErrorKm = 0.0;
+		double rmsErrorKm = 0.0;
+	};
+
+	static constexpr double rebaseDays = 0.5;
+
+	GpuPropagator();
+	GpuPropagator(GpuPropagator&) = delete;
+	~GpuPropagator();
+
+	// false - пакет не помещается в буферную текстуру; тогда нужен CPU-путь
+	bool propagate(const Sgp4Batch& batch, const JulianDate& jd);
+
+	// Сверка с CPU: положения околоземных объектов последнего propagate()
+	// против Sgp4Batch::propagate() на тот же момент. Читает буфер с GPU -
+	// для отладки, не для каждого кадра
+	CrossCheck crossCheck(const Sgp4Batch& batch) const;
+
+	GLuint positionBuffer() const { return positions; }
+	GLuint lightingBuffer() const { return lighting; }
+	size_t count() const { return objectCount; }
+	const std::vector<SatelliteCatalog::Slot>& slots() const { return objectSlots; }
+	uint64_t catalogVersion() const { return builtVersion; }
+
+private:
+	bool upload(const Sgp4Batch& batch, const JulianDate& referenceJd);
+	void propagateDeep(const Sgp4Batch& batch, const JulianDate& jd);
+
+	ShaderProgram program;
+	GLuint vao;
+	GLuint coefficientBuffer, coefficientTexture;
+	GLuint positions, lighting;
+	GLint maxTexels = 0;
+
+	JulianDate referenceJd;
+	JulianDate lastJd;
+	uint64_t builtVersion = 0;
+	bool built = false;
+	size_t nearCount = 0;
+	size_t objectCount = 0;
+	std::vector<SatelliteCatalog::Slot> objectSlots;
+
+	std::vector<float> packed;
+	Sgp4Batch::States deepStates;
+	std::vector<float> deepTeme, deepScene, deepLight;
+	std::vector<ShadowState> deepShadow;
+};
@@ -0,0 +1,48 @@
+#include "GpuTimer.h"
+
+GpuTimer::GpuTimer()
+{
+    glGenQueries(static_cast<GLsizei>(queryCount), queries.data());
+}
+
+GpuTimer::~GpuTimer()
+{
+    glDeleteQueries(static_cast<GLsizei>(queryCount), queries.data());
+}
+
+void GpuTimer::collect()
+{
+    // Запросы завершаются по порядку: первый неготовый - дальше смотреть незачем
+    for (size_t k = 0; k < queryCount; k++) {
+        size_t i = (next + k) % queryCount;
+        if (!pending[i])
+            continue;
+        GLint available = 0;
+        glGetQueryObjectiv(queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            break;
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(queries[i], GL_QUERY_RESULT, &elapsed);
+        lastMs = static_cast<double>(elapsed) * 1e-6;
+        pending[i] = false;
+    }
+}
+
+void GpuTimer::begin()
+{
+    collect();
+    if (pending[next])
+        return;
+    glBeginQuery(GL_TIME_ELAPSED, queries[next]);
+    running = true;
+}
+
+void GpuTimer::end()
+{
+    if (!running)
+        return;
+    glEndQuery(GL_TIME_ELAPSED);
+    pending[next] = true;
+    next = (next + 1) % queryCount;
+    running = false;
+}
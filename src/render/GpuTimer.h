@@ -0,0 +1,34 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <array>
+#include <cstddef>
+
+// Время выполнения команд между begin() и end() на GPU (GL_TIME_ELAPSED).
+// Результат запроса приходит с задержкой в несколько кадров, поэтому запросов
+// несколько по кругу: milliseconds() - последний готовый замер, ожидания
+// драйвера нет. Если все запросы ещё в работе, кадр не замеряется
+class GpuTimer
+{
+public:
+	GpuTimer();
+	GpuTimer(GpuTimer&) = delete;
+	~GpuTimer();
+
+	void begin();
+	void end();
+
+	double milliseconds() const { return lastMs; }
+
+private:
+	static constexpr size_t queryCount = 4;
+
+	void collect();
+
+	std::array<GLuint, queryCount> queries;
+	std::array<bool, queryCount> pending{};
+	size_t next = 0;
+	bool running = false;
+	double lastMs = 0.0;
+};
@@ -0,0 +1,209 @@
+#include "Satellites.h"
+#include "Shaders.h"
+#include "../orbit/Frames.h"
+
+#include <cstring>
+
+namespace {
+
+    // Буфер под запись целого кадра: старое содержимое отбрасывается, и драйвер
+    // выдаёт свежую память, не дожидаясь отрисовки предыдущего кадра
+    void* mapForFrame(GLuint buffer, size_t bytes, size_t& capacity)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        if (bytes > capacity) {
+            capacity = bytes + bytes / 4;
+            glBufferData(GL_ARRAY_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+        }
+        return glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    }
+
+    uint8_t toByte(float value)
+    {
+        float clamped = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+        return static_cast<uint8_t>(clamped * 255.0f + 0.5f);
+    }
+
+}
+
+Satellites::Satellites()
+    : shader(Shader::create("res/shaders/satellite.vert", "res/shaders/satellite.frag"))
+{
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &positionVbo);
+    glGenBuffers(1, &lightingVbo);
+    glGenBuffers(1, &styleVbo);
+
+    glBindVertexArray(vao);
+
+    // Положение в системе сцены (location = 0)
+    glBindBuffer(GL_ARRAY_BUFFER, positionVbo);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+
+    // Доля диска Солнца (location = 1)
+    glBindBuffer(GL_ARRAY_BUFFER, lightingVbo);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)0);
+
+    // Цвет и размер точки (location = 2, 3)
+    glBindBuffer(GL_ARRAY_BUFFER, styleVbo);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Instance), (void*)offsetof(Instance, color));
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)offsetof(Instance, size));
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    boundPositions = positionVbo;
+    boundLighting = lightingVbo;
+}
+
+Satellites::~Satellites()
+{
+    glDeleteBuffers(1, &positionVbo);
+    glDeleteBuffers(1, &lightingVbo);
+    glDeleteBuffers(1, &styleVbo);
+    glDeleteVertexArrays(1, &vao);
+}
+
+void Satellites::setGroupStyle(uint64_t groupMask, const SatelliteStyle& style)
+{
+    for (auto& entry : groupStyles) {
+        if (entry.first == groupMask) {
+            entry.second = style;
+            stylesDirty = true;
+            return;
+        }
+    }
+    groupStyles.emplace_back(groupMask, style);
+    stylesDirty = true;
+}
+
+void Satellites::setDefaultStyle(const SatelliteStyle& style)
+{
+    defaultStyle = style;
+    stylesDirty = true;
+}
+
+void Satellites::upload(const PositionFrame& frame, const SatelliteCatalog& catalog)
+{
+    size_t count = frame.size();
+    if (stylesDirty || frame.catalogVersion != styledVersion || styles.size() != count)
+        rebuildStyles(frame.slots, frame.catalogVersion, catalog);
+    bindSource(positionVbo, lightingVbo);
+
+    instanceCount = 0;
+    if (count == 0)
+        return;
+
+    // Положения: TEME -> сцена прямо в память буфера
+    void* positions = mapForFrame(positionVbo, count * 3 * sizeof(float), positionCapacity);
+    if (!positions)
+        return;
+    Frames::temeToScene(frame.jd.value(), count, frame.positions.data(), static_cast<float*>(positions));
+    bool positionsOk = glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE;
+
+    // Освещённость; у объектов, для которых SGP4 не дал положения, -1 - шейдер их не рисует
+    lighting.resize(count);
+    shadow.resize(count);
+    Illumination::shadow(Illumination::sunPosition(frame.jd), count, frame.positions.data(),
+        lighting.data(), shadow.data());
+    for (size_t i = 0; i < count; i++)
+        lighting[i] = frame.error[i] != 0 ? -1.0f : lighting[i];
+
+    void* light = mapForFrame(lightingVbo, count * sizeof(float), lightingCapacity);
+    if (!light)
+        return;
+    std::memcpy(light, lighting.data(), count * sizeof(float));
+    bool lightingOk = glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE;
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // Содержимое буфера потеряно (смена видеорежима) - кадр пропускается
+    if (positionsOk && lightingOk)
+        instanceCount = count;
+}
+
+void Satellites::upload(const GpuPropagator& gpu, const SatelliteCatalog& catalog)
+{
+    if (stylesDirty || gpu.catalogVersion() != styledVersion || styles.size() != gpu.count())
+        rebuildStyles(gpu.slots(), gpu.catalogVersion(), catalog);
+    bindSource(gpu.positionBuffer(), gpu.lightingBuffer());
+    instanceCount = gpu.count();
+}
+
+void Satellites::bindSource(GLuint positions, GLuint light)
+{
+    if (positions == boundPositions && light == boundLighting)
+        return;
+
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, positions);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glBindBuffer(GL_ARRAY_BUFFER, light);
+    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)0);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    boundPositions = positions;
+    boundLighting = light;
+}
+
+void Satellites::rebuildStyles(const std::vector<SatelliteCatalog::Slot>& slots, uint64_t version,
+    const SatelliteCatalog& catalog)
+{
+    auto pack = [](const SatelliteStyle& style) {
+        Instance instance;
+        instance.color[0] = toByte(style.color.r);
+        instance.color[1] = toByte(style.color.g);
+        instance.color[2] = toByte(style.color.b);
+        instance.color[3] = 255;
+        instance.size = style.size;
+        return instance;
+    };
+
+    std::vector<Instance> packedGroups;
+    packedGroups.reserve(groupStyles.size());
+    for (const auto& entry : groupStyles)
+        packedGroups.push_back(pack(entry.second));
+    Instance packedDefault = pack(defaultStyle);
+
+    const auto& groupMask = catalog.columns().groupMask;
+    styles.resize(slots.size());
+    for (size_t i = 0; i < slots.size(); i++) {
+        SatelliteCatalog::Slot slot = slots[i];
+        uint64_t mask = slot < groupMask.size() ? groupMask[slot] : 0;
+        styles[i] = packedDefault;
+        for (size_t g = 0; g < groupStyles.size(); g++) {
+            if (mask & groupStyles[g].first) {
+                styles[i] = packedGroups[g];
+                break;
+            }
+        }
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, styleVbo);
+    glBufferData(GL_ARRAY_BUFFER, styles.size() * sizeof(Instance), styles.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    styledVersion = version;
+    stylesDirty = false;
+}
+
+void Satellites::render() const
+{
+    if (instanceCount == 0)
+        return;
+
+    // Камера - из блока Camera (FrameUniforms)
+    shader.use();
+    shader.set(Uniform::ShadowBrightness, shadowBrightness);
+
+    // Размер точки задаёт вершинный шейдер
+    glEnable(GL_PROGRAM_POINT_SIZE);
+    glBindVertexArray(vao);
+    glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(instanceCount));
+    glBindVertexArray(0);
+    glDisable(GL_PROGRAM_POINT_SIZE);
+}
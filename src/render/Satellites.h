@@ -0,0 +1,76 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "../data/SatelliteCatalog.h"
+#include "../orbit/Illumination.h"
+#include "../orbit/PropagationScheduler.h"
+#include "GpuPropagator.h"
+#include "Shaders.h"
+
+// Оформление объектов группы
+struct SatelliteStyle {
+	glm::vec3 color = glm::vec3(0.85f, 0.85f, 0.85f);
+	float size = 3.0f;	// диаметр точки, пиксели
+};
+
+// Слой спутников: весь кадр положений рисуется одним glDrawArrays(GL_POINTS)
+// круглыми точками постоянного экранного размера.
+// Положения и освещённость каждый кадр пишутся в буферы с отбрасыванием
+// старого содержимого (orphaning), чтобы не ждать, пока GPU дочитает
+// предыдущий кадр; цвет и размер зависят только от групп и пересобираются
+// при изменении каталога или стилей
+class Satellites
+{
+public:
+	Satellites();
+	Satellites(Satellites&) = delete;
+	~Satellites();
+
+	// Объект из нескольких групп получает стиль группы, заданной первой
+	void setGroupStyle(uint64_t groupMask, const SatelliteStyle& style);
+	void setDefaultStyle(const SatelliteStyle& style);
+	// Яркость объекта в тени Земли относительно освещённого
+	void setShadowBrightness(float brightness) { shadowBrightness = brightness; }
+
+	void upload(const PositionFrame& frame, const SatelliteCatalog& catalog);
+	// Положения и освещённость уже посчитаны на GPU - рисуем прямо из его буферов
+	void upload(const GpuPropagator& gpu, const SatelliteCatalog& catalog);
+	void render() const;
+
+	size_t count() const { return instanceCount; }
+
+private:
+	// Постоянные атрибуты объекта: цвет RGBA8 и размер точки
+	struct Instance {
+		uint8_t color[4];
+		float size;
+	};
+
+	void rebuildStyles(const std::vector<SatelliteCatalog::Slot>& slots, uint64_t version,
+		const SatelliteCatalog& catalog);
+	void bindSource(GLuint positions, GLuint light);
+
+	ShaderProgram shader;
+	GLuint vao;
+	GLuint positionVbo, lightingVbo, styleVbo;
+	size_t positionCapacity = 0, lightingCapacity = 0;	// байты
+	GLuint boundPositions, boundLighting;	// откуда VAO сейчас берёт атрибуты 0 и 1
+
+	std::vector<std::pair<uint64_t, SatelliteStyle>> groupStyles;
+	SatelliteStyle defaultStyle;
+	float shadowBrightness = 0.3f;
+
+	std::vector<Instance> styles;
+	uint64_t styledVersion = 0;
+	bool stylesDirty = true;
+
+	std::vector<float> lighting;
+	std::vector<ShadowState> shadow;
+	size_t instanceCount = 0;
+};
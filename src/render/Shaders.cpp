@@ -3,53 +3,86 @@
 #include <sstream>
 #include <iostream>
 
+namespace {
+
+    // Имена в порядке Uniform
+    const char* const uniformNames[] = {
+        "model", "normalMatrix",
+        "lineColor", "shadowBrightness",
+        "coefficients", "minutes", "temeToScene", "sunPosition",
+        "xke", "j2", "earthRadius", "sunRadius",
+        "virtualMaxLevel", "virtualLayout",
+    };
+    static_assert(sizeof(uniformNames) / sizeof(uniformNames[0]) == static_cast<size_t>(Uniform::Count),
+        "uniformNames must match Uniform");
+
+    // Имена блоков в порядке UniformBlock
+    const char* const blockNames[] = { "Camera", "Lighting" };
+    static_assert(sizeof(blockNames) / sizeof(blockNames[0]) == static_cast<size_t>(UniformBlock::Count),
+        "blockNames must match UniformBlock");
+
+    // Имена sampler-переменных в порядке TextureUnit
+    const char* const samplerNames[] = { "earthMaps", "virtualAtlas", "virtualPageTable" };
+    static_assert(sizeof(samplerNames) / sizeof(samplerNames[0]) == static_cast<size_t>(TextureUnit::Count),
+        "samplerNames must match TextureUnit");
+
+}
+
 GLuint Shader::create(const std::string& vertexPath, const std::string& fragmentPath)
 {
-    //  
+    // чтение исходников
     std::string vertexCode = readFile(vertexPath);
     std::string fragmentCode = readFile(fragmentPath);
     const char* vcode = vertexCode.c_str();
     const char* fcode = fragmentCode.c_str();
 
-    //   
+    // компиляция вершинного шейдера
     GLuint vertex = glCreateShader(GL_VERTEX_SHADER);
     glShaderSource(vertex, 1, &vcode, NULL);
     glCompileShader(vertex);
     checkCompileErrors(vertex, VERTEX);
 
-    //   
+    // компиляция фрагментного шейдера
     GLuint fragment = glCreateShader(GL_FRAGMENT_SHADER);
     glShaderSource(fragment, 1, &fcode, NULL);
     glCompileShader(fragment);
     checkCompileErrors(fragment, FRAGMENT);
 
-    //  
+    // линковка программы
     GLuint program = glCreateProgram();
     glAttachShader(program, vertex);
     glAttachShader(program, fragment);
     glLinkProgram(program);
     checkCompileErrors(program, PROGRAM);
 
-    //  
+    // удаление шейдеров
     glDeleteShader(vertex);
     glDeleteShader(fragment);
 
     return program;
 }
 
-void Shader::setMat4(GLuint shader, const std::string& name, const glm::mat4& matrix)
+GLuint Shader::createFeedback(const std::string& vertexPath, const std::vector<const char*>& varyings)
 {
-    glUniformMatrix4fv(glGetUniformLocation(shader, name.c_str()), 1, GL_FALSE, glm::value_ptr(matrix));
-}
+    std::string vertexCode = readFile(vertexPath);
+    const char* vcode = vertexCode.c_str();
 
-void Shader::setVec3(GLuint shader, const std::string& name, const glm::vec3& vector)
-{
-    glUniform3fv(glGetUniformLocation(shader, name.c_str()), 1, glm::value_ptr(vector));
-}
+    GLuint vertex = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertex, 1, &vcode, NULL);
+    glCompileShader(vertex);
+    checkCompileErrors(vertex, VERTEX);
 
-void Shader::setFloat(GLuint shader, const std::string& name, const float& value)
-{
-    glUniform1f(glGetUniformLocation(shader, name.c_str()), value);
+    // выходы для transform feedback задаются до линковки
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertex);
+    glTransformFeedbackVaryings(program, static_cast<GLsizei>(varyings.size()), varyings.data(),
+        GL_SEPARATE_ATTRIBS);
+    glLinkProgram(program);
+    checkCompileErrors(program, PROGRAM);
+
+    glDeleteShader(vertex);
+
+    return program;
 }
 
 void Shader::checkCompileErrors(GLuint shader, ShaderTypes type)
@@ -66,7 +99,7 @@ void Shader::checkCompileErrors(GLuint shader, ShaderTypes type)
         }
     }
     else {
-        glGetProgramiv(shader, GL_COMPILE_STATUS, &success);
+        glGetProgramiv(shader, GL_LINK_STATUS, &success);
         if (!success) {
             glGetProgramInfoLog(shader, 1024, NULL, infoLog);
             std::cerr << "Shader program compile error:\n" << infoLog << std::endl;
@@ -85,3 +118,54 @@ std::string Shader::readFile(const std::string& path)
     buffer << file.rdbuf();
     return buffer.str();
 }
+
+ShaderProgram::ShaderProgram(GLuint program) : program(program)
+{
+    // Все активные переменные программы - одним проходом после линковки
+    GLint count = 0, maxLength = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::vector<GLchar> name(maxLength > 0 ? maxLength : 1);
+    for (GLint i = 0; i < count; i++) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program, i, static_cast<GLsizei>(name.size()), &length, &size, &type, name.data());
+        std::string key(name.data(), length);
+        // массивы приходят как "name[0]"
+        if (key.size() > 3 && key.compare(key.size() - 3, 3, "[0]") == 0)
+            key.resize(key.size() - 3);
+        locations[key] = glGetUniformLocation(program, name.data());
+    }
+
+    for (size_t i = 0; i < known.size(); i++)
+        known[i] = location(uniformNames[i]);
+
+    for (GLuint binding = 0; binding < static_cast<GLuint>(UniformBlock::Count); binding++) {
+        GLuint index = glGetUniformBlockIndex(program, blockNames[binding]);
+        if (index != GL_INVALID_INDEX)
+            glUniformBlockBinding(program, index, binding);
+    }
+
+    // glUniform* действует на текущую программу - она возвращается после
+    GLint previous = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &previous);
+    glUseProgram(program);
+    for (GLint unit = 0; unit < static_cast<GLint>(TextureUnit::Count); unit++) {
+        GLint sampler = location(samplerNames[unit]);
+        if (sampler >= 0)
+            glUniform1i(sampler, unit);
+    }
+    glUseProgram(static_cast<GLuint>(previous));
+}
+
+ShaderProgram::~ShaderProgram()
+{
+    glDeleteProgram(program);
+}
+
+GLint ShaderProgram::location(const std::string& name) const
+{
+    auto it = locations.find(name);
+    return it != locations.end() ? it->second : -1;
+}
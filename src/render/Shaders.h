@@ -4,7 +4,10 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <array>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 enum ShaderTypes {
 	VERTEX, FRAGMENT, PROGRAM
@@ -14,14 +17,81 @@ class Shader
 {
 public:
 	static GLuint create(const std::string& vertexPath, const std::string& fragmentPath);
+	// Программа только из вершинного шейдера, выходы которого пишутся
+	// в буферы transform feedback (по буферу на выход)
+	static GLuint createFeedback(const std::string& vertexPath, const std::vector<const char*>& varyings);
 
-	//      
-	static void setMat4(GLuint shader, const std::string& name, const glm::mat4& matrix);
-	static void setVec3(GLuint shader, const std::string& name, const glm::vec3& vector);
-	static void setFloat(GLuint shader, const std::string& name, const float& value);
-	
 private:
 	static std::string readFile(const std::string& path);
-	//   
+	// Проверка ошибок компиляции
 	static void checkCompileErrors(GLuint shader, ShaderTypes type);
-};
\ No newline at end of file
+};
+
+// Uniform-переменные шейдеров проекта. Расположения всех известных имён
+// ищутся один раз при создании ShaderProgram, дальше - индекс в массиве
+enum class Uniform {
+	Model, NormalMatrix,
+	LineColor, ShadowBrightness,
+	Coefficients, Minutes, TemeToScene, SunPosition,
+	Xke, J2, EarthRadius, SunRadius,
+	VirtualMaxLevel, VirtualLayout,
+	Count
+};
+
+// Общие для всех программ блоки uniform (std140) и их точки привязки.
+// В GLSL 3.30 нет layout(binding), поэтому блоки с этими именами
+// привязываются к точкам при создании ShaderProgram
+enum class UniformBlock : GLuint {
+	Camera = 0,		// FrameUniforms::CameraBlock
+	Lighting = 1,	// FrameUniforms::LightingBlock
+	Count
+};
+
+// Текстурные блоки sampler-переменных - по той же причине назначаются
+// один раз при создании ShaderProgram, а не перед каждой отрисовкой
+enum class TextureUnit : GLint {
+	EarthMaps = 0,			// массив слоёв Earth::MapLayer
+	VirtualAtlas = 1,		// VirtualTexture
+	VirtualPageTable = 2,
+	Count
+};
+
+// Слинкованная программа с таблицей расположений uniform-переменных.
+// Значения задаются для текущей программы: перед set() нужен use()
+class ShaderProgram
+{
+public:
+	explicit ShaderProgram(GLuint program);	// программа переходит во владение
+	ShaderProgram(const ShaderProgram&) = delete;
+	ShaderProgram& operator=(const ShaderProgram&) = delete;
+	~ShaderProgram();
+
+	GLuint id() const { return program; }
+	void use() const { glUseProgram(program); }
+
+	// -1 - переменной в программе нет (или её выбросил компилятор),
+	// glUniform* с таким расположением ничего не делают
+	GLint location(Uniform uniform) const { return known[static_cast<size_t>(uniform)]; }
+	// Имя вне Uniform - по таблице активных переменных, без обращения к драйверу
+	GLint location(const std::string& name) const;
+
+	void set(Uniform uniform, const glm::mat4& matrix) const
+	{
+		glUniformMatrix4fv(location(uniform), 1, GL_FALSE, glm::value_ptr(matrix));
+	}
+	void set(Uniform uniform, const glm::mat3& matrix) const
+	{
+		glUniformMatrix3fv(location(uniform), 1, GL_FALSE, glm::value_ptr(matrix));
+	}
+	void set(Uniform uniform, const glm::vec3& vector) const
+	{
+		glUniform3fv(location(uniform), 1, glm::value_ptr(vector));
+	}
+	void set(Uniform uniform, float value) const { glUniform1f(location(uniform), value); }
+	void set(Uniform uniform, int value) const { glUniform1i(location(uniform), value); }
+
+private:
+	GLuint program;
+	std::array<GLint, static_cast<size_t>(Uniform::Count)> known;
+	std::unordered_map<std::string, GLint> locations;
+};
@@ -0,0 +1,439 @@
+#include "TextureCache.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+    // GL_EXT_texture_compression_s3tc: в glad (core 3.3) констант нет
+    const GLenum compressedRgbDxt1 = 0x83F0;
+
+    const uint32_t cacheMagic = 0x58455453;	// "STEX"
+    const uint32_t cacheVersion = 1;
+
+    struct CacheHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t format;
+        uint32_t levels;
+        uint64_t sourceSize;
+        int64_t sourceTime;
+    };
+
+    uint16_t toRgb565(const float color[3])
+    {
+        auto quantize = [](float value, int maxValue) {
+            float clamped = value < 0.0f ? 0.0f : (value > 255.0f ? 255.0f : value);
+            return static_cast<unsigned>(clamped * maxValue / 255.0f + 0.5f);
+        };
+        return static_cast<uint16_t>((quantize(color[0], 31) << 11) | (quantize(color[1], 63) << 5) | quantize(color[2], 31));
+    }
+
+    void fromRgb565(uint16_t packed, int color[3])
+    {
+        int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+        color[0] = (r << 3) | (r >> 2);
+        color[1] = (g << 2) | (g >> 4);
+        color[2] = (b << 3) | (b >> 2);
+    }
+
+    // Блок 4x4 в BC1: концы отрезка - крайние проекции на главную ось
+    // разброса цветов блока, индексы - ближайший из четырёх цветов палитры
+    void encodeBc1Block(const uint8_t pixels[16][3], uint8_t out[8])
+    {
+        float mean[3] = { 0.0f, 0.0f, 0.0f };
+        for (int i = 0; i < 16; i++)
+            for (int c = 0; c < 3; c++)
+                mean[c] += pixels[i][c] / 16.0f;
+
+        float cov[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };	// rr rg rb gg gb bb
+        for (int i = 0; i < 16; i++) {
+            float d[3] = { pixels[i][0] - mean[0], pixels[i][1] - mean[1], pixels[i][2] - mean[2] };
+            cov[0] += d[0] * d[0]; cov[1] += d[0] * d[1]; cov[2] += d[0] * d[2];
+            cov[3] += d[1] * d[1]; cov[4] += d[1] * d[2]; cov[5] += d[2] * d[2];
+        }
+
+        // Главная ось - несколько шагов степенного метода
+        float axis[3] = { 1.0f, 1.0f, 1.0f };
+        for (int iteration = 0; iteration < 4; iteration++) {
+            float next[3] = {
+                cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2],
+                cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2],
+                cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2],
+            };
+            float length = std::max(std::max(std::fabs(next[0]), std::fabs(next[1])), std::fabs(next[2]));
+            if (length < 1e-6f)
+                break;
+            for (int c = 0; c < 3; c++)
+                axis[c] = next[c] / length;
+        }
+
+        float minT = 0.0f, maxT = 0.0f;
+        for (int i = 0; i < 16; i++) {
+            float t = 0.0f;
+            for (int c = 0; c < 3; c++)
+                t += (pixels[i][c] - mean[c]) * axis[c];
+            minT = std::min(minT, t);
+            maxT = std::max(maxT, t);
+        }
+        float norm = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+        float high[3], low[3];
+        for (int c = 0; c < 3; c++) {
+            high[c] = mean[c] + axis[c] * maxT / norm;
+            low[c] = mean[c] + axis[c] * minT / norm;
+        }
+
+        // Четырёхцветный режим требует c0 > c1
+        uint16_t c0 = toRgb565(high), c1 = toRgb565(low);
+        if (c0 < c1)
+            std::swap(c0, c1);
+
+        int palette[4][3];
+        fromRgb565(c0, palette[0]);
+        fromRgb565(c1, palette[1]);
+        for (int c = 0; c < 3; c++) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        uint32_t indices = 0;
+        if (c0 != c1) {
+            for (int i = 0; i < 16; i++) {
+                int best = 0, bestDistance = INT32_MAX;
+                for (int k = 0; k < 4; k++) {
+                    int distance = 0;
+                    for (int c = 0; c < 3; c++) {
+                        int d = pixels[i][c] - palette[k][c];
+                        distance += d * d;
+                    }
+                    if (distance < bestDistance) {
+                        bestDistance = distance;
+                        best = k;
+                    }
+                }
+                indices |= static_cast<uint32_t>(best) << (2 * i);
+            }
+        }
+
+        out[0] = c0 & 0xFF; out[1] = c0 >> 8;
+        out[2] = c1 & 0xFF; out[3] = c1 >> 8;
+        for (int b = 0; b < 4; b++)
+            out[4 + b] = (indices >> (8 * b)) & 0xFF;
+    }
+
+    // Размер уровня в байтах: BC1 - 8 байт на блок 4x4, RGB8 - 3 на тексель
+    uint64_t levelBytes(TextureCache::Format format, uint32_t width, uint32_t height)
+    {
+        if (format == TextureCache::Format::Bc1)
+            return ((static_cast<uint64_t>(width) + 3) / 4) * ((static_cast<uint64_t>(height) + 3) / 4) * 8;
+        return static_cast<uint64_t>(width) * height * 3;
+    }
+
+    // Длина полной цепочки mip-уровней до 1x1
+    uint32_t mipLevels(uint32_t width, uint32_t height)
+    {
+        uint32_t levels = 1;
+        for (uint32_t size = std::max(width, height); size > 1; size /= 2)
+            levels++;
+        return levels;
+    }
+
+    TextureCache::Level compressBc1(const TextureCache::Level& rgb)
+    {
+        TextureCache::Level out;
+        out.width = rgb.width;
+        out.height = rgb.height;
+        uint32_t blocksX = (rgb.width + 3) / 4, blocksY = (rgb.height + 3) / 4;
+        out.data.resize(static_cast<size_t>(blocksX) * blocksY * 8);
+
+        uint8_t pixels[16][3];
+        for (uint32_t by = 0; by < blocksY; by++) {
+            for (uint32_t bx = 0; bx < blocksX; bx++) {
+                // Блоки за краем уровня добираются повтором крайних текселей
+                for (int i = 0; i < 16; i++) {
+                    uint32_t x = std::min(bx * 4 + i % 4, rgb.width - 1);
+                    uint32_t y = std::min(by * 4 + i / 4, rgb.height - 1);
+                    std::memcpy(pixels[i], &rgb.data[(static_cast<size_t>(y) * rgb.width + x) * 3], 3);
+                }
+                encodeBc1Block(pixels, &out.data[(static_cast<size_t>(by) * blocksX + bx) * 8]);
+            }
+        }
+        return out;
+    }
+
+}
+
+bool TextureCache::load(const std::string& sourcePath)
+{
+    Image image;
+    if (!loadImage(sourcePath, preferredFormat(), image))
+        return false;
+    upload(image);
+    return true;
+}
+
+bool TextureCache::loadImage(const std::string& sourcePath, Format format, Image& image,
+    uint32_t width, uint32_t height)
+{
+    std::error_code ec;
+    fs::path source(sourcePath);
+    uint64_t sourceSize = fs::file_size(source, ec);
+    if (ec) {
+        std::cerr << "Can't load texture: " << sourcePath << std::endl;
+        return false;
+    }
+    int64_t sourceTime = static_cast<int64_t>(fs::last_write_time(source, ec).time_since_epoch().count());
+
+    fs::path cache = cachePath(source, format, width, height);
+    if (readCache(cache, sourceSize, sourceTime, image)
+        && image.levels.size() == mipLevels(image.levels[0].width, image.levels[0].height)
+        && (width == 0 || (image.levels[0].width == width && image.levels[0].height == height)))
+        return true;
+
+    if (!convert(sourcePath, format, width, height, image))
+        return false;
+    if (!writeCache(cache, sourceSize, sourceTime, image))
+        std::cerr << "Can't write texture cache: " << cache.string() << std::endl;
+    return true;
+}
+
+bool TextureCache::sourceSize(const std::string& sourcePath, uint32_t& width, uint32_t& height)
+{
+    int w, h, channels;
+    if (!stbi_info(sourcePath.c_str(), &w, &h, &channels))
+        return false;
+    width = static_cast<uint32_t>(w);
+    height = static_cast<uint32_t>(h);
+    return true;
+}
+
+void TextureCache::upload(const Image& image)
+{
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (size_t level = 0; level < image.levels.size(); level++) {
+        const Level& l = image.levels[level];
+        if (image.format == Format::Bc1) {
+            glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), internalFormat(image.format), l.width, l.height, 0,
+                static_cast<GLsizei>(l.data.size()), l.data.data());
+        }
+        else {
+            glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), internalFormat(image.format), l.width, l.height, 0,
+                GL_RGB, GL_UNSIGNED_BYTE, l.data.data());
+        }
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(image.levels.size()) - 1);
+}
+
+TextureCache::Format TextureCache::preferredFormat()
+{
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++) {
+        const char* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        if (name && std::strcmp(name, "GL_EXT_texture_compression_s3tc") == 0)
+            return Format::Bc1;
+    }
+    return Format::Rgb8;
+}
+
+bool TextureCache::readFile(const fs::path& path, Image& image)
+{
+    return readCache(path, 0, 0, image);
+}
+
+bool TextureCache::writeFile(const fs::path& path, const Image& image)
+{
+    return writeCache(path, 0, 0, image);
+}
+
+TextureCache::Level TextureCache::compress(const Level& rgb, Format format)
+{
+    return format == Format::Bc1 ? compressBc1(rgb) : rgb;
+}
+
+TextureCache::Level TextureCache::downsample(const Level& src)
+{
+    Level dst;
+    dst.width = std::max(1u, src.width / 2);
+    dst.height = std::max(1u, src.height / 2);
+    dst.data.resize(static_cast<size_t>(dst.width) * dst.height * 3);
+    for (uint32_t y = 0; y < dst.height; y++) {
+        uint32_t y0 = std::min(2 * y, src.height - 1), y1 = std::min(2 * y + 1, src.height - 1);
+        for (uint32_t x = 0; x < dst.width; x++) {
+            uint32_t x0 = std::min(2 * x, src.width - 1), x1 = std::min(2 * x + 1, src.width - 1);
+            for (int c = 0; c < 3; c++) {
+                unsigned sum = src.data[(static_cast<size_t>(y0) * src.width + x0) * 3 + c]
+                    + src.data[(static_cast<size_t>(y0) * src.width + x1) * 3 + c]
+                    + src.data[(static_cast<size_t>(y1) * src.width + x0) * 3 + c]
+                    + src.data[(static_cast<size_t>(y1) * src.width + x1) * 3 + c];
+                dst.data[(static_cast<size_t>(y) * dst.width + x) * 3 + c] = static_cast<uint8_t>((sum + 2) / 4);
+            }
+        }
+    }
+    return dst;
+}
+
+TextureCache::Level TextureCache::resize(const Level& rgb, uint32_t width, uint32_t height)
+{
+    // Билинейная выборка берёт 2x2 текселя - при уменьшении больше чем вдвое
+    // исходник сначала ужимается усреднением
+    Level src = rgb;
+    while (src.width >= 2 * width && src.height >= 2 * height)
+        src = downsample(src);
+
+    Level dst;
+    dst.width = width;
+    dst.height = height;
+    dst.data.resize(static_cast<size_t>(width) * height * 3);
+    float scaleX = static_cast<float>(src.width) / width, scaleY = static_cast<float>(src.height) / height;
+    for (uint32_t y = 0; y < height; y++) {
+        float fy = std::clamp((y + 0.5f) * scaleY - 0.5f, 0.0f, static_cast<float>(src.height - 1));
+        uint32_t y0 = static_cast<uint32_t>(fy), y1 = std::min(y0 + 1, src.height - 1);
+        float ty = fy - y0;
+        for (uint32_t x = 0; x < width; x++) {
+            float fx = std::clamp((x + 0.5f) * scaleX - 0.5f, 0.0f, static_cast<float>(src.width - 1));
+            uint32_t x0 = static_cast<uint32_t>(fx), x1 = std::min(x0 + 1, src.width - 1);
+            float tx = fx - x0;
+            for (int c = 0; c < 3; c++) {
+                auto texel = [&](uint32_t sx, uint32_t sy) {
+                    return static_cast<float>(src.data[(static_cast<size_t>(sy) * src.width + sx) * 3 + c]);
+                };
+                float top = texel(x0, y0) * (1 - tx) + texel(x1, y0) * tx;
+                float bottom = texel(x0, y1) * (1 - tx) + texel(x1, y1) * tx;
+                dst.data[(static_cast<size_t>(y) * width + x) * 3 + c] = static_cast<uint8_t>(top * (1 - ty) + bottom * ty + 0.5f);
+            }
+        }
+    }
+    return dst;
+}
+
+GLenum TextureCache::internalFormat(Format format)
+{
+    return format == Format::Bc1 ? compressedRgbDxt1 : GL_RGB8;
+}
+
+fs::path TextureCache::cachePath(const fs::path& source, Format format, uint32_t width, uint32_t height)
+{
+    // Приведённый к другому размеру - отдельный файл: исходник может грузиться и сам по себе
+    std::string name = source.stem().string();
+    if (width != 0)
+        name += "." + std::to_string(width) + "x" + std::to_string(height);
+    name += format == Format::Bc1 ? ".bc1.tex" : ".rgb.tex";
+    return source.parent_path() / "cache" / name;
+}
+
+bool TextureCache::readCache(const fs::path& path, uint64_t sourceSize, int64_t sourceTime, Image& image)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+        return false;
+    uint64_t remaining = static_cast<uint64_t>(file.tellg());
+    file.seekg(0);
+
+    CacheHeader header;
+    if (remaining < sizeof(header) || !file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+        return false;
+    remaining -= sizeof(header);
+    if (header.magic != cacheMagic || header.version != cacheVersion
+        || header.sourceSize != sourceSize || header.sourceTime != sourceTime
+        || (header.format != static_cast<uint32_t>(Format::Rgb8) && header.format != static_cast<uint32_t>(Format::Bc1))
+        || header.levels == 0 || header.levels > 32)
+        return false;
+
+    // Размеры из файла проверяются до выделения памяти: уровни - начало
+    // mip-цепочки первого (тайлы хранят один уровень), байты - по формату
+    // и не больше, чем осталось в файле. Битый кэш пересобирается из исходника
+    image.format = static_cast<Format>(header.format);
+    image.levels.resize(header.levels);
+    for (size_t i = 0; i < image.levels.size(); i++) {
+        Level& level = image.levels[i];
+        uint32_t sizes[3];
+        if (remaining < sizeof(sizes) || !file.read(reinterpret_cast<char*>(sizes), sizeof(sizes)))
+            return false;
+        remaining -= sizeof(sizes);
+
+        if (i == 0) {
+            if (sizes[0] == 0 || sizes[1] == 0 || header.levels > mipLevels(sizes[0], sizes[1]))
+                return false;
+        }
+        else if (sizes[0] != std::max(1u, image.levels[0].width >> i)
+            || sizes[1] != std::max(1u, image.levels[0].height >> i)) {
+            return false;
+        }
+        if (sizes[2] != levelBytes(image.format, sizes[0], sizes[1]) || sizes[2] > remaining)
+            return false;
+        remaining -= sizes[2];
+
+        level.width = sizes[0];
+        level.height = sizes[1];
+        level.data.resize(sizes[2]);
+        if (!file.read(reinterpret_cast<char*>(level.data.data()), sizes[2]))
+            return false;
+    }
+    return true;
+}
+
+bool TextureCache::writeCache(const fs::path& path, uint64_t sourceSize, int64_t sourceTime, const Image& image)
+{
+    std::error_code ec;
+    fs::create_directories(path.parent_path(), ec);
+
+    // Через временный файл: оборванная запись не оставит битый кэш
+    fs::path temporary = path;
+    temporary += ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file)
+            return false;
+
+        CacheHeader header = { cacheMagic, cacheVersion, static_cast<uint32_t>(image.format),
+            static_cast<uint32_t>(image.levels.size()), sourceSize, sourceTime };
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (const Level& level : image.levels) {
+            uint32_t sizes[3] = { level.width, level.height, static_cast<uint32_t>(level.data.size()) };
+            file.write(reinterpret_cast<const char*>(sizes), sizeof(sizes));
+            file.write(reinterpret_cast<const char*>(level.data.data()), level.data.size());
+        }
+        if (!file)
+            return false;
+    }
+    fs::rename(temporary, path, ec);
+    return !ec;
+}
+
+bool TextureCache::convert(const std::string& sourcePath, Format format, uint32_t width, uint32_t height, Image& image)
+{
+    int sourceWidth, sourceHeight, channels;
+    unsigned char* data = stbi_load(sourcePath.c_str(), &sourceWidth, &sourceHeight, &channels, 3);
+    if (!data) {
+        std::cerr << "Can't load texture: " << sourcePath << std::endl;
+        return false;
+    }
+
+    Level rgb;
+    rgb.width = sourceWidth;
+    rgb.height = sourceHeight;
+    rgb.data.assign(data, data + static_cast<size_t>(sourceWidth) * sourceHeight * 3);
+    stbi_image_free(data);
+    if (width != 0 && (rgb.width != width || rgb.height != height))
+        rgb = resize(rgb, width, height);
+
+    image.format = format;
+    image.levels.clear();
+    while (true) {
+        image.levels.push_back(compress(rgb, format));
+        if (rgb.width == 1 && rgb.height == 1)
+            break;
+        rgb = downsample(rgb);
+    }
+    return true;
+}
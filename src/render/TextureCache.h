@@ -0,0 +1,68 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Кэш текстур в готовом для GPU виде. При первом запуске (или если исходник
+// изменился) JPEG/PNG декодируется, на CPU строится вся цепочка mip-уровней,
+// и при поддержке S3TC уровни сжимаются в BC1 (DXT1, 4 бита на тексель).
+// Результат пишется рядом с исходником в cache/<имя>.<формат>.tex, и дальше
+// загрузка - чтение файла и glCompressedTexImage2D по уровням без декодирования
+// и glGenerateMipmap. Устаревший кэш узнаётся по размеру и времени изменения
+// исходника, записанным в заголовке
+class TextureCache
+{
+public:
+	enum class Format : uint32_t {
+		Rgb8 = 1,	// несжатый запасной вариант: GPU без S3TC
+		Bc1 = 2,
+	};
+
+	struct Level {
+		uint32_t width = 0, height = 0;
+		std::vector<uint8_t> data;
+	};
+
+	struct Image {
+		Format format = Format::Rgb8;
+		std::vector<Level> levels;	// от полного размера до 1x1
+	};
+
+	// Загрузка в текстуру, привязанную к GL_TEXTURE_2D
+	static bool load(const std::string& sourcePath);
+
+	// Только CPU: кэш или преобразование исходника с записью кэша.
+	// Не трогает GL - можно вызывать из другого потока. Ненулевые width и
+	// height - привести исходник к этому размеру (слои одного массива текстур)
+	static bool loadImage(const std::string& sourcePath, Format format, Image& image,
+		uint32_t width = 0, uint32_t height = 0);
+	// Размер исходника по заголовку, без декодирования
+	static bool sourceSize(const std::string& sourcePath, uint32_t& width, uint32_t& height);
+	static void upload(const Image& image);
+
+	// Файлы контейнера без привязки к исходнику (тайлы VirtualTexture)
+	static bool readFile(const std::filesystem::path& path, Image& image);
+	static bool writeFile(const std::filesystem::path& path, const Image& image);
+	// Один уровень RGB8 -> format (BC1 - сжатие на CPU)
+	static Level compress(const Level& rgb, Format format);
+	// Следующий mip-уровень RGB8: среднее 2x2 (у нечётного края - с повтором)
+	static Level downsample(const Level& rgb);
+	// RGB8 другого размера: билинейно, при сильном уменьшении - после downsample
+	static Level resize(const Level& rgb, uint32_t width, uint32_t height);
+
+	// Формат, в котором кэшировать для текущего контекста
+	static Format preferredFormat();
+	// Внутренний формат текстуры GL
+	static GLenum internalFormat(Format format);
+
+private:
+	static std::filesystem::path cachePath(const std::filesystem::path& source, Format format,
+		uint32_t width, uint32_t height);
+	static bool readCache(const std::filesystem::path& path, uint64_t sourceSize, int64_t sourceTime, Image& image);
+	static bool writeCache(const std::filesystem::path& path, uint64_t sourceSize, int64_t sourceTime, const Image& image);
+	static bool convert(const std::string& sourcePath, Format format, uint32_t width, uint32_t height, Image& image);
+};
@@ -0,0 +1,251 @@
+#include "TextureLoader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+TextureLoader::TextureLoader(unsigned threadCount, size_t uploadBudget)
+    : pool(threadCount), uploadBudget(uploadBudget)
+{
+    glGenBuffers(2, pbos);
+    dispatcher = std::thread(&TextureLoader::dispatchLoop, this);
+}
+
+TextureLoader::~TextureLoader()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    // Начатое декодирование не прерывается - ждём его
+    dispatcher.join();
+    glDeleteBuffers(2, pbos);
+}
+
+void TextureLoader::request(const std::string& path, GLuint texture, const glm::vec3& placeholder)
+{
+    requestLayers({ path }, texture, { placeholder });
+}
+
+void TextureLoader::requestLayers(const std::vector<std::string>& paths, GLuint texture,
+    const std::vector<glm::vec3>& placeholders)
+{
+    // Одиночный файл - обычная текстура, несколько - слои массива
+    auto job = std::make_unique<Job>();
+    job->paths = paths;
+    job->target = paths.size() == 1 ? GL_TEXTURE_2D : GL_TEXTURE_2D_ARRAY;
+    job->texture = texture;
+
+    // Заглушка 1x1 на слой до прихода первых уровней
+    std::vector<uint8_t> texels(paths.size() * 3);
+    for (size_t layer = 0; layer < paths.size(); layer++) {
+        for (int c = 0; c < 3; c++)
+            texels[layer * 3 + c] = static_cast<uint8_t>(glm::clamp(placeholders[layer][c], 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+    glBindTexture(job->target, texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (job->target == GL_TEXTURE_2D)
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, 1, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, texels.data());
+    else
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGB8, 1, 1, static_cast<GLsizei>(paths.size()), 0, GL_RGB, GL_UNSIGNED_BYTE, texels.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(job->target, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(job->target, GL_TEXTURE_MAX_LEVEL, 0);
+    glBindTexture(job->target, 0);
+
+    enqueue(std::move(job));
+}
+
+void TextureLoader::enqueue(std::unique_ptr<Job> job)
+{
+    // Формат зависит от контекста - выбирается здесь, в потоке GL
+    job->format = TextureCache::preferredFormat();
+    job->images.resize(job->paths.size());
+    job->remaining = job->paths.size();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(job.get());
+    }
+    jobs.push_back(std::move(job));
+    wake.notify_one();
+}
+
+void TextureLoader::dispatchLoop()
+{
+    while (true) {
+        std::vector<Job*> batch;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (stopping)
+                return;
+            batch.swap(queue);
+        }
+
+        // По файлу (слою) на поток; готовность - по каждому заданию
+        // отдельно, выгрузка первых не ждёт остальных
+        std::vector<std::pair<Job*, size_t>> layers;
+        for (Job* job : batch) {
+            // Размер массива - по заголовку первого файла, без декодирования
+            if (job->target == GL_TEXTURE_2D_ARRAY)
+                TextureCache::sourceSize(job->paths[0], job->width, job->height);
+            for (size_t layer = 0; layer < job->paths.size(); layer++)
+                layers.emplace_back(job, layer);
+        }
+        pool.parallelFor(layers.size(), 1, [&layers](size_t begin, size_t end, unsigned) {
+            for (size_t i = begin; i < end; i++) {
+                Job* job = layers[i].first;
+                size_t layer = layers[i].second;
+                if (!TextureCache::loadImage(job->paths[layer], job->format, job->images[layer], job->width, job->height))
+                    job->failed = true;
+                if (job->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    job->state.store(job->failed ? State::Failed : State::Ready, std::memory_order_release);
+            }
+        });
+    }
+}
+
+void TextureLoader::update()
+{
+    size_t budget = uploadBudget;
+    for (auto it = jobs.begin(); it != jobs.end();) {
+        Job& job = **it;
+        State state = job.state.load(std::memory_order_acquire);
+        // Неудачная загрузка оставляет заглушку
+        if (state == State::Failed || (state == State::Ready && budget > 0 && uploadJob(job, budget)))
+            it = jobs.erase(it);
+        else
+            ++it;
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+bool TextureLoader::layersMatch(const Job& job)
+{
+    const TextureCache::Image& first = job.images[0];
+    for (const TextureCache::Image& image : job.images) {
+        if (image.format != first.format || image.levels.size() != first.levels.size())
+            return false;
+        for (size_t i = 0; i < image.levels.size(); i++) {
+            if (image.levels[i].width != first.levels[i].width || image.levels[i].height != first.levels[i].height)
+                return false;
+        }
+    }
+    return true;
+}
+
+bool TextureLoader::uploadJob(Job& job, size_t& budget)
+{
+    const std::vector<TextureCache::Level>& levels = job.images[0].levels;
+    if (levels.empty())
+        return true;
+
+    bool compressed = job.format == TextureCache::Format::Bc1;
+    GLint lastLevel = static_cast<GLint>(levels.size()) - 1;
+    glBindTexture(job.target, job.texture);
+
+    if (!job.started) {
+        if (!layersMatch(job)) {
+            std::cerr << "Texture layers differ in size: " << job.paths[0] << std::endl;
+            return true;
+        }
+        // Память всей цепочки сразу и сверху вниз: при выделении уровней снизу
+        // драйвер может перестраивать хранилище и терять уже залитые уровни
+        // (llvmpipe, размеры не степени двойки). Заглушка пропадает здесь -
+        // следующим же вызовом придёт самый грубый уровень
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        GLenum format = TextureCache::internalFormat(job.format);
+        for (size_t i = 0; i < levels.size(); i++) {
+            if (job.target == GL_TEXTURE_2D) {
+                glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), format, levels[i].width, levels[i].height, 0,
+                    GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+            }
+            else {
+                glTexImage3D(GL_TEXTURE_2D_ARRAY, static_cast<GLint>(i), format, levels[i].width, levels[i].height,
+                    static_cast<GLsizei>(job.images.size()), 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+            }
+        }
+        glTexParameteri(job.target, GL_TEXTURE_BASE_LEVEL, lastLevel);
+        glTexParameteri(job.target, GL_TEXTURE_MAX_LEVEL, lastLevel);
+        job.level = levels.size() - 1;
+        job.layer = 0;
+        job.rows = 0;
+        job.started = true;
+    }
+
+    while (budget > 0) {
+        const TextureCache::Level& level = levels[job.level];
+        // Для BC1 строка - ряд блоков 4x4
+        uint32_t totalRows = compressed ? (level.height + 3) / 4 : level.height;
+        size_t rowBytes = compressed ? static_cast<size_t>((level.width + 3) / 4) * 8 : static_cast<size_t>(level.width) * 3;
+
+        // Хотя бы одна строка за вызов, иначе крупный уровень не сдвинется
+        uint32_t count = static_cast<uint32_t>(std::min<size_t>(totalRows - job.rows, std::max<size_t>(1, budget / rowBytes)));
+        uploadRows(job, job.rows, count, rowBytes);
+        budget -= std::min(budget, count * rowBytes);
+        job.rows += count;
+
+        if (job.rows < totalRows)
+            continue;
+        job.rows = 0;
+        if (++job.layer < job.images.size())
+            continue;
+
+        // Уровни от job.level до последнего готовы во всех слоях - можно показывать
+        glTexParameteri(job.target, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(job.level));
+        glTexParameteri(job.target, GL_TEXTURE_MAX_LEVEL, lastLevel);
+        job.layer = 0;
+        if (job.level == 0) {
+            job.images.clear();
+            return true;
+        }
+        job.level--;
+    }
+    return false;
+}
+
+void TextureLoader::uploadRows(const Job& job, uint32_t firstRow, uint32_t rowCount, size_t rowBytes)
+{
+    const TextureCache::Level& level = job.images[job.layer].levels[job.level];
+    size_t bytes = rowCount * rowBytes;
+    const uint8_t* source = level.data.data() + firstRow * rowBytes;
+
+    // Копия в PBO (память буфера каждый раз новая), дальше драйвер забирает
+    // данные сам, не задерживая поток; без PBO - прямо из памяти
+    const void* pixels = source;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos[nextPbo]);
+    nextPbo ^= 1;
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+    void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (mapped) {
+        std::memcpy(mapped, source, bytes);
+        if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE)
+            pixels = nullptr;	// смещение 0 в PBO
+    }
+    if (pixels)
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    GLint mip = static_cast<GLint>(job.level);
+    GLint layer = static_cast<GLint>(job.layer);
+    GLenum format = TextureCache::internalFormat(job.format);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (job.format == TextureCache::Format::Bc1) {
+        GLint y = static_cast<GLint>(firstRow * 4);
+        GLsizei height = std::min<GLsizei>(rowCount * 4, static_cast<GLsizei>(level.height) - y);
+        if (job.target == GL_TEXTURE_2D)
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, mip, 0, y, level.width, height, format, static_cast<GLsizei>(bytes), pixels);
+        else
+            glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, mip, 0, y, layer, level.width, height, 1, format,
+                static_cast<GLsizei>(bytes), pixels);
+    }
+    else {
+        if (job.target == GL_TEXTURE_2D)
+            glTexSubImage2D(GL_TEXTURE_2D, mip, 0, firstRow, level.width, rowCount, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+        else
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, mip, 0, firstRow, layer, level.width, rowCount, 1, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
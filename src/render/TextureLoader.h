@@ -0,0 +1,84 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TextureCache.h"
+#include "../orbit/WorkStealingPool.h"
+
+// Фоновая загрузка текстур. request() сразу кладёт в текстуру заглушку 1x1
+// и ставит файл в очередь; поток-диспетчер раздаёт очередь пулу потоков
+// (TextureCache::loadImage: кэш или декодирование со сжатием), а update()
+// в главном потоке каждый кадр переносит готовые уровни на GPU через PBO,
+// не больше uploadBudget байт за кадр. Уровни идут от грубого к подробному:
+// GL_TEXTURE_BASE_LEVEL опускается по мере готовности, и текстура
+// уточняется на экране, не блокируя запуск даже для снимков 8k/16k.
+// requestLayers() - то же для слоёв GL_TEXTURE_2D_ARRAY: слои декодируются
+// параллельно, уровень открывается, когда выгружен во всех слоях
+class TextureLoader
+{
+public:
+	explicit TextureLoader(unsigned threadCount = 2, size_t uploadBudget = 8u << 20);
+	TextureLoader(TextureLoader&) = delete;
+	~TextureLoader();
+
+	// texture - созданная текстура GL_TEXTURE_2D с настроенной фильтрацией
+	void request(const std::string& path, GLuint texture, const glm::vec3& placeholder);
+	// texture - GL_TEXTURE_2D_ARRAY; слои приводятся к размеру первого файла
+	void requestLayers(const std::vector<std::string>& paths, GLuint texture,
+		const std::vector<glm::vec3>& placeholders);
+
+	// Главный поток, раз за кадр
+	void update();
+
+	size_t pending() const { return jobs.size(); }
+
+private:
+	enum class State { Queued, Ready, Failed };
+
+	struct Job {
+		std::vector<std::string> paths;	// по файлу на слой
+		GLenum target;	// GL_TEXTURE_2D или GL_TEXTURE_2D_ARRAY
+		GLuint texture;
+		TextureCache::Format format;
+		uint32_t width = 0, height = 0;	// размер слоёв массива (0 - как у файла)
+		std::vector<TextureCache::Image> images;
+		std::atomic<size_t> remaining{ 0 };	// слоёв в декодировании
+		std::atomic<bool> failed{ false };
+		std::atomic<State> state{ State::Queued };
+		// Ход выгрузки: текущие уровень и слой, сколько строк (блоков для BC1) уже передано
+		bool started = false;
+		size_t level = 0;
+		size_t layer = 0;
+		uint32_t rows = 0;
+	};
+
+	void enqueue(std::unique_ptr<Job> job);
+	void dispatchLoop();
+	// false - задание не закончено, бюджет кадра исчерпан
+	bool uploadJob(Job& job, size_t& budget);
+	// Слои с одинаковыми форматом и цепочкой уровней
+	static bool layersMatch(const Job& job);
+	void uploadRows(const Job& job, uint32_t firstRow, uint32_t rowCount, size_t rowBytes);
+
+	WorkStealingPool pool;
+	size_t uploadBudget;
+	GLuint pbos[2];
+	int nextPbo = 0;
+
+	std::vector<std::unique_ptr<Job>> jobs;	// главный поток
+
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::vector<Job*> queue;	// под mutex
+	bool stopping = false;
+	std::thread dispatcher;
+};
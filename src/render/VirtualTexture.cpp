@@ -0,0 +1,498 @@
+#include "VirtualTexture.h"
+#include "Frustum.h"
+#include "stb_image.h"
+#include "../orbit/WorkStealingPool.h"
+
+#ifndef _USE_MATH_DEFINES
+#define _USE_MATH_DEFINES
+#endif
+#include <math.h>
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+    const char* const pyramidFile = "pyramid.txt";
+
+    // Середина тайла и угол до дальней точки его границы (как у участков Earth)
+    void tileBounds(int level, int x, int y, glm::vec3& center, float& angularRadius)
+    {
+        const int samples = 8;
+        float du = 1.0f / (2 << level), dv = 1.0f / (1 << level);
+        float u0 = x * du, v0 = y * dv;
+        center = VirtualTexture::surfacePoint(u0 + du / 2, v0 + dv / 2);
+        float minCos = 1.0f;
+        for (int k = 0; k <= samples; ++k) {
+            float t = static_cast<float>(k) / samples;
+            glm::vec3 edge[4] = {
+                VirtualTexture::surfacePoint(u0 + t * du, v0),
+                VirtualTexture::surfacePoint(u0 + t * du, v0 + dv),
+                VirtualTexture::surfacePoint(u0, v0 + t * dv),
+                VirtualTexture::surfacePoint(u0 + du, v0 + t * dv),
+            };
+            for (const glm::vec3& point : edge)
+                minCos = std::min(minCos, glm::dot(point, center));
+        }
+        angularRadius = acos(glm::clamp(minCos, -1.0f, 1.0f));
+    }
+
+    // Билинейная выборка RGB8 в текселях src: по x - с повтором (долгота), по y - до края
+    void sampleBilinear(const TextureCache::Level& src, float fx, float fy, uint8_t* out)
+    {
+        fy = glm::clamp(fy, 0.0f, static_cast<float>(src.height - 1));
+        int x0 = static_cast<int>(std::floor(fx)), y0 = static_cast<int>(fy);
+        float tx = fx - x0, ty = fy - y0;
+        int w = static_cast<int>(src.width);
+        int y1 = std::min(y0 + 1, static_cast<int>(src.height) - 1);
+        int xa = ((x0 % w) + w) % w, xb = (xa + 1) % w;
+        auto texel = [&](int x, int y, int c) {
+            return static_cast<float>(src.data[(static_cast<size_t>(y) * src.width + x) * 3 + c]);
+        };
+        for (int c = 0; c < 3; c++) {
+            float top = texel(xa, y0, c) * (1 - tx) + texel(xb, y0, c) * tx;
+            float bottom = texel(xa, y1, c) * (1 - tx) + texel(xb, y1, c) * tx;
+            out[c] = static_cast<uint8_t>(top * (1 - ty) + bottom * ty + 0.5f);
+        }
+    }
+
+    // Части исходника одного размера, склеенные в один уровень RGB8. Размеры
+    // проверяются по заголовкам до декодирования: stb_image не декодирует
+    // больше INT_MAX байт, и без проверки большая часть падала бы на середине
+    bool loadParts(const std::vector<std::string>& parts, int columns, TextureCache::Level& source)
+    {
+        if (parts.empty() || columns <= 0 || parts.size() % columns != 0) {
+            std::cerr << "Tile source: " << parts.size() << " parts don't fill rows of " << columns << std::endl;
+            return false;
+        }
+        size_t rows = parts.size() / columns;
+
+        int partWidth = 0, partHeight = 0;
+        for (const std::string& part : parts) {
+            int w, h, channels;
+            if (!stbi_info(part.c_str(), &w, &h, &channels)) {
+                std::cerr << "Failed to load tile source: " << part << std::endl;
+                return false;
+            }
+            if (static_cast<uint64_t>(w) * h * 3 > static_cast<uint64_t>(INT_MAX)) {
+                std::cerr << "Tile source " << part << " is " << w << "x" << h
+                    << ": over 2 GB in RGB, split it into parts (--columns)" << std::endl;
+                return false;
+            }
+            if (partWidth == 0) {
+                partWidth = w;
+                partHeight = h;
+            }
+            else if (w != partWidth || h != partHeight) {
+                std::cerr << "Tile source " << part << " is " << w << "x" << h << ", expected "
+                    << partWidth << "x" << partHeight << std::endl;
+                return false;
+            }
+        }
+        if (static_cast<uint64_t>(partWidth) * columns > UINT32_MAX || static_cast<uint64_t>(partHeight) * rows > UINT32_MAX) {
+            std::cerr << "Tile source is too large" << std::endl;
+            return false;
+        }
+
+        source.width = static_cast<uint32_t>(partWidth * static_cast<uint64_t>(columns));
+        source.height = static_cast<uint32_t>(partHeight * static_cast<uint64_t>(rows));
+        source.data.resize(static_cast<size_t>(source.width) * source.height * 3);
+        size_t partRow = static_cast<size_t>(partWidth) * 3;
+        for (size_t i = 0; i < parts.size(); ++i) {
+            int w, h, channels;
+            unsigned char* data = stbi_load(parts[i].c_str(), &w, &h, &channels, 3);
+            if (!data || w != partWidth || h != partHeight) {
+                std::cerr << "Failed to load tile source: " << parts[i] << std::endl;
+                stbi_image_free(data);
+                return false;
+            }
+            size_t column = i % columns, row = i / columns;
+            for (int y = 0; y < partHeight; ++y) {
+                size_t offset = ((row * partHeight + y) * source.width + column * partWidth) * 3;
+                std::memcpy(&source.data[offset], data + y * partRow, partRow);
+            }
+            stbi_image_free(data);
+        }
+        return true;
+    }
+
+}
+
+bool VirtualTexture::build(const std::string& sourcePath, const std::string& directory, TextureCache::Format format)
+{
+    return build(std::vector<std::string>{ sourcePath }, 1, directory, format);
+}
+
+bool VirtualTexture::build(const std::vector<std::string>& parts, int columns, const std::string& directory,
+    TextureCache::Format format)
+{
+    TextureCache::Level source;
+    if (!loadParts(parts, columns, source))
+        return false;
+    uint32_t width = source.width;
+
+    // Цепочка уменьшенных копий: тайлы уровня берутся из ближайшей не меньшей
+    std::vector<TextureCache::Level> chain;
+    chain.push_back(std::move(source));
+    while (chain.back().width > 2u * tileSize)
+        chain.push_back(TextureCache::downsample(chain.back()));
+
+    // Самый подробный уровень - ближайший к разрешению исходника
+    int maxLevel = std::max(0, static_cast<int>(std::lround(std::log2(width / (2.0 * tileSize)))));
+
+    WorkStealingPool pool;
+    for (int level = 0; level <= maxLevel; ++level) {
+        int columns = 2 << level, rows = 1 << level;
+        float virtualWidth = static_cast<float>(columns) * tileSize;
+        const TextureCache::Level* src = &chain.front();
+        for (const TextureCache::Level& candidate : chain) {
+            if (candidate.width >= virtualWidth)
+                src = &candidate;
+        }
+        float scaleX = src->width / virtualWidth;
+        float scaleY = src->height / (static_cast<float>(rows) * tileSize);
+
+        std::atomic<bool> ok{ true };
+        pool.parallelFor(static_cast<size_t>(columns) * rows, 1, [&](size_t begin, size_t end, unsigned) {
+            for (size_t tile = begin; tile < end; ++tile) {
+                int x = static_cast<int>(tile % columns), y = static_cast<int>(tile / columns);
+                TextureCache::Level rgb;
+                rgb.width = rgb.height = slotSize;
+                rgb.data.resize(static_cast<size_t>(slotSize) * slotSize * 3);
+                for (int py = 0; py < slotSize; ++py) {
+                    float vy = static_cast<float>(y * tileSize + py - border);
+                    for (int px = 0; px < slotSize; ++px) {
+                        float vx = static_cast<float>(x * tileSize + px - border);
+                        sampleBilinear(*src, (vx + 0.5f) * scaleX - 0.5f, (vy + 0.5f) * scaleY - 0.5f,
+                            &rgb.data[(static_cast<size_t>(py) * slotSize + px) * 3]);
+                    }
+                }
+                TextureCache::Image image;
+                image.format = format;
+                image.levels.push_back(TextureCache::compress(rgb, format));
+                fs::path path = fs::path(directory) / std::to_string(level)
+                    / (std::to_string(x) + "_" + std::to_string(y) + ".tex");
+                if (!TextureCache::writeFile(path, image))
+                    ok = false;
+            }
+        });
+        if (!ok) {
+            std::cerr << "Failed to write tiles to " << directory << std::endl;
+            return false;
+        }
+        std::cout << "Tiles: level " << level << ", " << columns << "x" << rows << std::endl;
+    }
+
+    // Описание - последним: прерванная нарезка не выглядит готовой
+    std::ofstream file(fs::path(directory) / pyramidFile, std::ios::trunc);
+    file << tileSize << ' ' << border << ' ' << static_cast<uint32_t>(format) << ' ' << maxLevel << '\n';
+    return static_cast<bool>(file);
+}
+
+bool VirtualTexture::exists(const std::string& directory)
+{
+    std::error_code ec;
+    return fs::exists(fs::path(directory) / pyramidFile, ec);
+}
+
+VirtualTexture::VirtualTexture(const std::string& directory)
+    : directory(directory)
+{
+    std::ifstream file(fs::path(directory) / pyramidFile);
+    int fileTileSize = 0, fileBorder = 0, maxLevel = -1;
+    uint32_t fileFormat = 0;
+    if (!(file >> fileTileSize >> fileBorder >> fileFormat >> maxLevel) || fileTileSize != tileSize
+        || fileBorder != border || maxLevel < 0 || maxLevel > 20
+        || (fileFormat != static_cast<uint32_t>(TextureCache::Format::Rgb8)
+            && fileFormat != static_cast<uint32_t>(TextureCache::Format::Bc1))) {
+        std::cerr << "Invalid tile pyramid: " << directory << std::endl;
+        return;
+    }
+    format = static_cast<TextureCache::Format>(fileFormat);
+    if (format == TextureCache::Format::Bc1 && TextureCache::preferredFormat() != TextureCache::Format::Bc1) {
+        std::cerr << "Tile pyramid needs S3TC: " << directory << std::endl;
+        return;
+    }
+    levels = maxLevel + 1;
+
+    // Атлас без mip-уровней: уровень дерева выбирает шейдер, рамка тайла
+    // закрывает билинейную выборку у края слота
+    const int atlasSize = atlasSlots * slotSize;
+    glGenTextures(1, &atlas);
+    glBindTexture(GL_TEXTURE_2D, atlas);
+    if (format == TextureCache::Format::Bc1) {
+        glCompressedTexImage2D(GL_TEXTURE_2D, 0, TextureCache::internalFormat(format), atlasSize, atlasSize, 0,
+            (atlasSize / 4) * (atlasSize / 4) * 8, nullptr);
+    }
+    else {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, atlasSize, atlasSize, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+
+    // Таблица страниц: mip-уровень maxLevel - z - сетка тайлов уровня z,
+    // тексель - (слот x, слот y, уровень загруженного тайла, есть ли он)
+    glGenTextures(1, &pageTable);
+    glBindTexture(GL_TEXTURE_2D, pageTable);
+    for (int level = 0; level < levels; ++level)
+        glTexImage2D(GL_TEXTURE_2D, maxLevel - level, GL_RGBA8, 2 << level, 1 << level, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, maxLevel);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    slots.resize(atlasSlots * atlasSlots);
+    rebuildPageTable();
+    io = std::thread(&VirtualTexture::ioLoop, this);
+}
+
+VirtualTexture::~VirtualTexture()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (io.joinable())
+        io.join();
+    glDeleteTextures(1, &atlas);
+    glDeleteTextures(1, &pageTable);
+}
+
+glm::vec3 VirtualTexture::surfacePoint(float u, float v)
+{
+    // Обращение UV из Earth::genarateSphereVertices
+    float theta = v * M_PI;
+    float phi = (0.75f - u) * 2 * M_PI;
+    return glm::vec3(sin(theta) * cos(phi), cos(theta), sin(theta) * sin(phi));
+}
+
+std::string VirtualTexture::tilePath(uint64_t key) const
+{
+    int level = static_cast<int>(key >> 48);
+    int y = static_cast<int>((key >> 24) & 0xFFFFFF), x = static_cast<int>(key & 0xFFFFFF);
+    return (fs::path(directory) / std::to_string(level) / (std::to_string(x) + "_" + std::to_string(y) + ".tex")).string();
+}
+
+void VirtualTexture::update(const Camera& camera, const glm::mat4& model)
+{
+    if (!valid())
+        return;
+    frame++;
+    stats.uploads = 0;
+
+    std::vector<uint64_t> wanted;
+    selectTiles(camera, model, wanted);
+    for (uint64_t key : wanted) {
+        auto it = resident.find(key);
+        if (it != resident.end())
+            slots[it->second].lastUsed = frame;
+    }
+    requestTiles(wanted);
+    uploadTiles();
+    if (pageTableDirty)
+        rebuildPageTable();
+
+    stats.wanted = static_cast<int>(wanted.size());
+    stats.resident = static_cast<int>(resident.size());
+    stats.loading = static_cast<int>(loading.size());
+    stats.level = wanted.empty() ? 0 : static_cast<int>(wanted.back() >> 48);
+}
+
+void VirtualTexture::selectTiles(const Camera& camera, const glm::mat4& model, std::vector<uint64_t>& wanted)
+{
+    // Камера в системе модели: сфера там единичная
+    glm::vec3 eye = glm::vec3(glm::inverse(model) * glm::vec4(camera.getPosition(), 1.0f));
+    Frustum frustum(camera.getProjection() * camera.getView() * model);
+    float pixelsAtUnitDistance = camera.getViewportHeight() / (2.0f * tan(camera.getFov() / 2));
+
+    // Обход в ширину: уровень за уровнем, пока выбранное помещается в атлас.
+    // Четверть слотов - запас под вытеснение
+    const size_t capacity = slots.size() * 3 / 4;
+    std::vector<glm::ivec2> current = { glm::ivec2(0, 0), glm::ivec2(1, 0) };
+    for (int level = 0; level < levels && !current.empty(); ++level) {
+        // Угловой размер текселя уровня (по обеим осям одинаковый)
+        float texel = static_cast<float>(M_PI) / ((1 << level) * tileSize);
+        std::vector<glm::ivec2> refine;
+        for (const glm::ivec2& tile : current) {
+            glm::vec3 center;
+            float angularRadius;
+            tileBounds(level, tile.x, tile.y, center, angularRadius);
+            float chord = 2.0f * sin(angularRadius / 2);
+            bool visible = Frustum::capAboveHorizon(eye, center, angularRadius)
+                && frustum.intersectsSphere(center, chord);
+            // Уровень 0 нужен всегда: запасной для любой точки
+            if (!visible && level > 0)
+                continue;
+            wanted.push_back(tileKey(level, tile.x, tile.y));
+
+            float distance = std::max(glm::length(eye - center) - chord, 1e-4f);
+            if (visible && level + 1 < levels && texel * pixelsAtUnitDistance / distance > 1.0f)
+                refine.push_back(tile);
+        }
+        if (wanted.size() + 4 * refine.size() > capacity)
+            break;
+        current.clear();
+        for (const glm::ivec2& tile : refine) {
+            for (int k = 0; k < 4; ++k)
+                current.push_back(glm::ivec2(tile.x * 2 + (k & 1), tile.y * 2 + (k >> 1)));
+        }
+    }
+}
+
+void VirtualTexture::requestTiles(const std::vector<uint64_t>& wanted)
+{
+    // Очередь заменяется целиком: тайлы, ставшие ненужными, пока камера
+    // двигалась, не читаются. wanted идёт от грубых уровней к подробным
+    std::lock_guard<std::mutex> lock(mutex);
+    for (uint64_t key : requests)
+        loading.erase(key);
+    requests.clear();
+    for (uint64_t key : wanted) {
+        if (loading.size() >= static_cast<size_t>(maxInFlight))
+            break;
+        if (resident.count(key) || failed.count(key))
+            continue;
+        if (loading.insert(key).second)
+            requests.push_back(key);
+    }
+    if (!requests.empty())
+        wake.notify_one();
+}
+
+void VirtualTexture::ioLoop()
+{
+    for (;;) {
+        uint64_t key;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !requests.empty(); });
+            if (stopping)
+                return;
+            key = requests.front();
+            requests.pop_front();
+        }
+        Loaded loaded{ key, false, {} };
+        loaded.ok = TextureCache::readFile(tilePath(key), loaded.image) && loaded.image.format == format
+            && loaded.image.levels.size() == 1 && loaded.image.levels[0].width == static_cast<uint32_t>(slotSize)
+            && loaded.image.levels[0].height == static_cast<uint32_t>(slotSize);
+        std::lock_guard<std::mutex> lock(mutex);
+        done.push_back(std::move(loaded));
+    }
+}
+
+void VirtualTexture::uploadTiles()
+{
+    std::vector<Loaded> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t count = std::min(done.size(), static_cast<size_t>(uploadsPerFrame));
+        std::move(done.begin(), done.begin() + count, std::back_inserter(ready));
+        done.erase(done.begin(), done.begin() + count);
+        for (const Loaded& loaded : ready)
+            loading.erase(loaded.key);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, atlas);
+    for (const Loaded& loaded : ready) {
+        if (!loaded.ok) {
+            std::cerr << "Failed to read tile: " << tilePath(loaded.key) << std::endl;
+            failed.insert(loaded.key);
+            continue;
+        }
+        int slot = allocateSlot();
+        if (slot < 0)
+            continue;	// всё занято нужным в этом кадре - запросится снова
+        if (slots[slot].used)
+            resident.erase(slots[slot].key);
+
+        const TextureCache::Level& level = loaded.image.levels[0];
+        GLint x = (slot % atlasSlots) * slotSize, y = (slot / atlasSlots) * slotSize;
+        if (format == TextureCache::Format::Bc1) {
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, 0, x, y, slotSize, slotSize, TextureCache::internalFormat(format),
+                static_cast<GLsizei>(level.data.size()), level.data.data());
+        }
+        else {
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, slotSize, slotSize, GL_RGB, GL_UNSIGNED_BYTE, level.data.data());
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        }
+
+        slots[slot] = { loaded.key, frame, true };
+        resident[loaded.key] = slot;
+        pageTableDirty = true;
+        stats.uploads++;
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+int VirtualTexture::allocateSlot()
+{
+    // Свободный слот или давно не нужный; тайлы уровня 0 не вытесняются
+    int oldest = -1;
+    for (int i = 0; i < static_cast<int>(slots.size()); ++i) {
+        const Slot& slot = slots[i];
+        if (!slot.used)
+            return i;
+        if (slot.lastUsed < frame && (slot.key >> 48) != 0
+            && (oldest < 0 || slot.lastUsed < slots[oldest].lastUsed))
+            oldest = i;
+    }
+    return oldest;
+}
+
+void VirtualTexture::rebuildPageTable()
+{
+    // Нет своего тайла - берётся запись родителя, то есть самый подробный
+    // загруженный предок
+    std::vector<uint8_t> parent, current;
+    glBindTexture(GL_TEXTURE_2D, pageTable);
+    for (int level = 0; level < levels; ++level) {
+        int columns = 2 << level, rows = 1 << level;
+        current.assign(static_cast<size_t>(columns) * rows * 4, 0);
+        for (int y = 0; y < rows; ++y) {
+            for (int x = 0; x < columns; ++x) {
+                uint8_t* entry = &current[(static_cast<size_t>(y) * columns + x) * 4];
+                auto it = resident.find(tileKey(level, x, y));
+                if (it != resident.end()) {
+                    entry[0] = static_cast<uint8_t>(it->second % atlasSlots);
+                    entry[1] = static_cast<uint8_t>(it->second / atlasSlots);
+                    entry[2] = static_cast<uint8_t>(level);
+                    entry[3] = 255;
+                }
+                else if (level > 0) {
+                    const uint8_t* up = &parent[(static_cast<size_t>(y / 2) * (columns / 2) + x / 2) * 4];
+                    std::copy(up, up + 4, entry);
+                }
+            }
+        }
+        glTexSubImage2D(GL_TEXTURE_2D, maxLevel() - level, 0, 0, columns, rows, GL_RGBA, GL_UNSIGNED_BYTE, current.data());
+        std::swap(parent, current);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    pageTableDirty = false;
+}
+
+void VirtualTexture::bind(const ShaderProgram& shader) const
+{
+    glActiveTexture(GL_TEXTURE0 + static_cast<GLint>(TextureUnit::VirtualAtlas));
+    glBindTexture(GL_TEXTURE_2D, atlas);
+    glActiveTexture(GL_TEXTURE0 + static_cast<GLint>(TextureUnit::VirtualPageTable));
+    glBindTexture(GL_TEXTURE_2D, pageTable);
+    shader.set(Uniform::VirtualMaxLevel, maxLevel());
+    shader.set(Uniform::VirtualLayout, glm::vec3(tileSize, border, atlasSlots * slotSize));
+}
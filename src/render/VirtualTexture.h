@@ -0,0 +1,123 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Shaders.h"
+#include "TextureCache.h"
+#include "../Camera.h"
+
+// Виртуальная текстура для снимков, не помещающихся в одну GL_TEXTURE_2D
+// (16k-43k по ширине). Исходник заранее режется build() на пирамиду тайлов
+// в равнопромежуточной проекции: на уровне z сетка 2^(z+1) x 2^z тайлов по
+// tileSize текселей с рамкой border из соседей (для билинейной фильтрации
+// на стыках). Каждый кадр update() обходит дерево тайлов и спускается туда,
+// где тексель крупнее пикселя экрана; невидимые (вне пирамиды, за
+// горизонтом) ветви не рассматриваются. Недостающие тайлы читает с диска
+// отдельный поток, готовые кладутся в атлас с фиксированным числом слотов
+// (вытесняется давно не нужный), а таблица страниц - текстура с mip-уровнем
+// на уровень дерева - говорит шейдеру, где лежит самый подробный
+// загруженный тайл для точки. Память GPU и CPU ограничена размером атласа
+// и очереди, а не разрешением исходника
+class VirtualTexture
+{
+public:
+	static constexpr int tileSize = 256;
+	static constexpr int border = 4;
+	static constexpr int slotSize = tileSize + 2 * border;	// кратно 4 - блоки BC1
+	static constexpr int atlasSlots = 16;	// слотов по стороне атласа
+	static constexpr int maxInFlight = 16;	// тайлов в очереди чтения
+	static constexpr int uploadsPerFrame = 8;
+
+	struct Stats {
+		int wanted = 0;		// выбрано обходом дерева
+		int resident = 0;	// в атласе
+		int loading = 0;
+		int uploads = 0;	// за кадр
+		int level = 0;		// самый подробный из выбранных
+	};
+
+	// Нарезка исходника в directory (offline: исходник должен поместиться в память).
+	// stb_image декодирует файл не больше INT_MAX байт - в RGB около 37800x18900;
+	// снимок крупнее подаётся частями одного размера: parts по строкам с севера,
+	// в строке columns частей с запада на восток (как 8 частей Blue Marble, 4x2)
+	static bool build(const std::string& sourcePath, const std::string& directory, TextureCache::Format format);
+	static bool build(const std::vector<std::string>& parts, int columns, const std::string& directory,
+		TextureCache::Format format);
+	static bool exists(const std::string& directory);
+
+	// Нужен контекст GL; при ошибке (нет пирамиды, GPU без её формата) valid() == false
+	explicit VirtualTexture(const std::string& directory);
+	VirtualTexture(VirtualTexture&) = delete;
+	~VirtualTexture();
+
+	bool valid() const { return atlas != 0; }
+	int maxLevel() const { return levels - 1; }
+	const Stats& getStats() const { return stats; }
+
+	// Главный поток, раз за кадр: выбор тайлов, выгрузка прочитанных, таблица страниц
+	void update(const Camera& camera, const glm::mat4& model);
+	// Атлас и таблица страниц на блоки TextureUnit::VirtualAtlas и VirtualPageTable,
+	// раскладка - в uniform earth.frag
+	void bind(const ShaderProgram& shader) const;
+
+	// Точка единичной сферы по текстурным координатам Earth: u растёт на запад
+	// от 0.75 на нулевом меридиане, v - от северного полюса
+	static glm::vec3 surfacePoint(float u, float v);
+
+private:
+	struct Slot {
+		uint64_t key = 0;
+		uint64_t lastUsed = 0;
+		bool used = false;
+	};
+
+	struct Loaded {
+		uint64_t key;
+		bool ok;
+		TextureCache::Image image;
+	};
+
+	static uint64_t tileKey(int level, int x, int y)
+	{
+		return (static_cast<uint64_t>(level) << 48) | (static_cast<uint64_t>(y) << 24) | static_cast<uint64_t>(x);
+	}
+	std::string tilePath(uint64_t key) const;
+
+	void selectTiles(const Camera& camera, const glm::mat4& model, std::vector<uint64_t>& wanted);
+	void requestTiles(const std::vector<uint64_t>& wanted);
+	void uploadTiles();
+	int allocateSlot();
+	void rebuildPageTable();
+	void ioLoop();
+
+	std::string directory;
+	TextureCache::Format format = TextureCache::Format::Rgb8;
+	int levels = 0;
+
+	GLuint atlas = 0, pageTable = 0;
+	std::vector<Slot> slots;
+	std::unordered_map<uint64_t, int> resident;	// тайл -> слот
+	std::unordered_set<uint64_t> loading;		// отдан потоку чтения
+	std::unordered_set<uint64_t> failed;
+	bool pageTableDirty = true;
+	uint64_t frame = 0;
+	Stats stats;
+
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::deque<uint64_t> requests;		// под mutex
+	std::vector<Loaded> done;			// под mutex
+	bool stopping = false;
+	std::thread io;
+};
@@ -0,0 +1,173 @@
+#include "JulianDate.h"
+
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+	// Юлианская дата 1970-01-01 0h UTC
+	const double unixEpochJd = 2440587.5;
+
+	// Секунды координации: MJD полуночи UTC, с которой действует TAI - UTC.
+	// Новые секунды объявляются IERS в Bulletin C не позже чем за полгода
+	struct LeapSecond {
+		int mjd;
+		int taiMinusUtc;
+	};
+
+	const LeapSecond leapSecondTable[] = {
+		{ 41317, 10 }, { 41499, 11 }, { 41683, 12 }, { 42048, 13 }, { 42413, 14 },
+		{ 42778, 15 }, { 43144, 16 }, { 43509, 17 }, { 43874, 18 }, { 44239, 19 },
+		{ 44786, 20 }, { 45151, 21 }, { 45516, 22 }, { 46247, 23 }, { 47161, 24 },
+		{ 47892, 25 }, { 48257, 26 }, { 48804, 27 }, { 49169, 28 }, { 49534, 29 },
+		{ 50083, 30 }, { 50630, 31 }, { 51179, 32 }, { 53736, 33 }, { 54832, 34 },
+		{ 56109, 35 }, { 57204, 36 }, { 57754, 37 },
+	};
+
+	bool isDigit(char c)
+	{
+		return c >= '0' && c <= '9';
+	}
+
+}
+
+JulianDate::JulianDate(double day, double fraction)
+{
+	// Дробная часть day переносится в долю суток, целые сутки доли - в day
+	double midnight = std::floor(day - 0.5) + 0.5;
+	fraction += day - midnight;
+	double whole = std::floor(fraction);
+	this->day = midnight + whole;
+	this->fraction = fraction - whole;
+	if (this->fraction >= 1.0) {
+		this->day += 1.0;
+		this->fraction -= 1.0;
+	}
+}
+
+JulianDate::JulianDate(double jd)
+	: JulianDate(jd, 0.0)
+{
+}
+
+JulianDate JulianDate::fromCalendar(int year, int month, int dayOfMonth, int hour, int minute, double second)
+{
+	// Номер юлианского дня (Fliegel, Van Flandern), целочисленно
+	int64_t a = (month - 14) / 12;
+	int64_t jdn = (1461 * (year + 4800 + a)) / 4 + (367 * (month - 2 - 12 * a)) / 12 -
+		(3 * ((year + 4900 + a) / 100)) / 4 + dayOfMonth - 32075;
+	double seconds = hour * 3600.0 + minute * 60.0 + second;
+	return JulianDate(static_cast<double>(jdn) - 0.5, seconds / 86400.0);
+}
+
+void JulianDate::toCalendar(int& year, int& month, int& dayOfMonth, int& hour, int& minute, double& second) const
+{
+	int64_t l = static_cast<int64_t>(day + 0.5) + 68569;
+	int64_t n = 4 * l / 146097;
+	l -= (146097 * n + 3) / 4;
+	int64_t i = 4000 * (l + 1) / 1461001;
+	l = l - 1461 * i / 4 + 31;
+	int64_t j = 80 * l / 2447;
+	dayOfMonth = static_cast<int>(l - 2447 * j / 80);
+	l = j / 11;
+	month = static_cast<int>(j + 2 - 12 * l);
+	year = static_cast<int>(100 * (n - 49) + i + l);
+
+	double seconds = fraction * 86400.0;
+	hour = static_cast<int>(seconds / 3600.0);
+	seconds -= hour * 3600.0;
+	minute = static_cast<int>(seconds / 60.0);
+	second = seconds - minute * 60.0;
+}
+
+JulianDate JulianDate::fromSystemTime(std::chrono::system_clock::time_point time)
+{
+	using Days = std::chrono::duration<int64_t, std::ratio<86400>>;
+
+	auto sinceEpoch = time.time_since_epoch();
+	auto days = std::chrono::duration_cast<Days>(sinceEpoch);
+	if (days > sinceEpoch)
+		days -= Days(1);	// округление вниз для моментов до 1970 года
+	double fraction = std::chrono::duration<double>(sinceEpoch - days).count() / 86400.0;
+	return JulianDate(unixEpochJd + static_cast<double>(days.count()), fraction);
+}
+
+std::chrono::system_clock::time_point JulianDate::toSystemTime() const
+{
+	auto days = std::chrono::duration<int64_t, std::ratio<86400>>(static_cast<int64_t>(day - unixEpochJd));
+	auto part = std::chrono::duration<double>(fraction * 86400.0);
+	return std::chrono::system_clock::time_point(
+		std::chrono::duration_cast<std::chrono::system_clock::duration>(days) +
+		std::chrono::duration_cast<std::chrono::system_clock::duration>(part));
+}
+
+bool JulianDate::fromTleEpoch(const char* text, size_t length, JulianDate& epoch)
+{
+	if (length < 5 || !isDigit(text[0]) || !isDigit(text[1]))
+		return false;
+
+	int yy = (text[0] - '0') * 10 + (text[1] - '0');
+	int year = yy < 57 ? 2000 + yy : 1900 + yy;
+
+	// День года; некоторые источники дополняют его пробелами вместо нулей
+	size_t i = 2;
+	while (i < length && text[i] == ' ')
+		i++;
+	int dayOfYear = 0, digits = 0;
+	for (; i < length && isDigit(text[i]); i++, digits++)
+		dayOfYear = dayOfYear * 10 + (text[i] - '0');
+	if (digits == 0 || dayOfYear < 1 || dayOfYear > 366)
+		return false;
+
+	// Доля суток целым числом: до 15 знаков делятся один раз без накопления ошибки
+	double fraction = 0.0;
+	if (i < length && text[i] == '.') {
+		int64_t mantissa = 0;
+		double scale = 1.0;
+		for (i++; i < length && isDigit(text[i]) && scale < 1e15; i++) {
+			mantissa = mantissa * 10 + (text[i] - '0');
+			scale *= 10.0;
+		}
+		fraction = static_cast<double>(mantissa) / scale;
+	}
+
+	// Юлианская дата 0 января года year, 0h UTC
+	int y = year - 1;
+	double jdJan0 = 1721424.5 + 365.0 * y + y / 4 - y / 100 + y / 400;
+	epoch = JulianDate(jdJan0 + dayOfYear, fraction);
+	return true;
+}
+
+int TimeScales::leapSeconds(const JulianDate& utc)
+{
+	double mjd = utc.mjd();
+	const size_t count = sizeof(leapSecondTable) / sizeof(leapSecondTable[0]);
+	for (size_t i = count; i > 0; i--) {
+		if (mjd >= leapSecondTable[i - 1].mjd)
+			return leapSecondTable[i - 1].taiMinusUtc;
+	}
+	// До 1972 года UTC шло с переменной длиной секунды; точнее здесь не нужно
+	return leapSecondTable[0].taiMinusUtc;
+}
+
+JulianDate TimeScales::utcToTai(const JulianDate& utc)
+{
+	return utc.addSeconds(leapSeconds(utc));
+}
+
+JulianDate TimeScales::taiToUtc(const JulianDate& tai)
+{
+	// Таблица задана по UTC: первое приближение и уточнение по нему
+	JulianDate guess = tai.addSeconds(-leapSeconds(tai));
+	return tai.addSeconds(-leapSeconds(guess));
+}
+
+JulianDate TimeScales::utcToTt(const JulianDate& utc)
+{
+	return utcToTai(utc).addSeconds(ttMinusTai);
+}
+
+JulianDate TimeScales::ttToUtc(const JulianDate& tt)
+{
+	return taiToUtc(tt.addSeconds(-ttMinusTai));
+}
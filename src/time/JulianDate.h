@@ -0,0 +1,60 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+// Момент времени - юлианская дата, разбитая на полночь (day, оканчивается на .5)
+// и долю суток от полуночи. Одно число double даёт у современных дат шаг ~40 мкс;
+// в разбитом виде доля суток хранится с точностью ~10 пс, а разности моментов
+// считаются без потери точности. Шкала (UTC, TAI, TT) определяется контекстом.
+// Секунда координации 23:59:60 UTC в этом представлении не отличается от
+// 00:00:00 следующих суток
+struct JulianDate {
+	double day = 0.0;
+	double fraction = 0.0;		// [0, 1)
+
+	JulianDate() = default;
+	JulianDate(double day, double fraction);
+	explicit JulianDate(double jd);
+
+	double value() const { return day + fraction; }
+	double mjd() const { return (day - 2400000.5) + fraction; }
+
+	JulianDate addDays(double days) const { return JulianDate(day, fraction + days); }
+	JulianDate addSeconds(double seconds) const { return JulianDate(day, fraction + seconds / 86400.0); }
+	double daysSince(const JulianDate& other) const { return (day - other.day) + (fraction - other.fraction); }
+	double secondsSince(const JulianDate& other) const { return daysSince(other) * 86400.0; }
+
+	bool operator<(const JulianDate& other) const { return daysSince(other) < 0.0; }
+	bool operator==(const JulianDate& other) const { return day == other.day && fraction == other.fraction; }
+	bool operator!=(const JulianDate& other) const { return !(*this == other); }
+
+	// Григорианский календарь
+	static JulianDate fromCalendar(int year, int month, int dayOfMonth, int hour = 0, int minute = 0,
+		double second = 0.0);
+	void toCalendar(int& year, int& month, int& dayOfMonth, int& hour, int& minute, double& second) const;
+
+	// Системные часы идут в UTC без секунд координации (POSIX)
+	static JulianDate fromSystemTime(std::chrono::system_clock::time_point time);
+	std::chrono::system_clock::time_point toSystemTime() const;
+	static JulianDate now() { return fromSystemTime(std::chrono::system_clock::now()); }
+
+	// Эпоха TLE "YYDDD.DDDDDDDD" (год 57-99 -> 19xx, 00-56 -> 20xx), UTC.
+	// Без выделения памяти и strtod; false - текст не похож на эпоху
+	static bool fromTleEpoch(const char* text, size_t length, JulianDate& epoch);
+};
+
+// Шкалы времени: UTC, TAI и TT. UT1 приравнивается к UTC (|UT1 - UTC| < 0.9 с)
+class TimeScales
+{
+public:
+	static constexpr double ttMinusTai = 32.184;
+
+	// TAI - UTC, секунды, по таблице секунд координации с 1972 года
+	static int leapSeconds(const JulianDate& utc);
+
+	static JulianDate utcToTai(const JulianDate& utc);
+	static JulianDate taiToUtc(const JulianDate& tai);
+	static JulianDate utcToTt(const JulianDate& utc);
+	static JulianDate ttToUtc(const JulianDate& tt);
+};
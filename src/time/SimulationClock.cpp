@@ -0,0 +1,30 @@
+#include "SimulationClock.h"
+
+#include <cmath>
+
+SimulationClock::SimulationClock()
+{
+	resetToNow();
+}
+
+void SimulationClock::advance(double realSeconds)
+{
+	if (paused)
+		return;
+
+	elapsedSeconds += realSeconds * warp;
+	current = anchor.addSeconds(elapsedSeconds);
+
+	// Раз в модельные сутки опора переносится, накопитель остаётся малым
+	if (std::fabs(elapsedSeconds) >= 86400.0) {
+		anchor = current;
+		elapsedSeconds = 0.0;
+	}
+}
+
+void SimulationClock::setUtc(const JulianDate& utc)
+{
+	anchor = utc;
+	current = utc;
+	elapsedSeconds = 0.0;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "JulianDate.h"
+
+// Модельное время: UTC, идущее с заданным ускорением относительно реального
+// (отрицательное - назад). Продвигается из шага фиксированного обновления
+// Application::update, поэтому положения спутников и освещение в одном кадре
+// считаются на один и тот же момент и не зависят от частоты кадров
+class SimulationClock
+{
+public:
+	SimulationClock();	// текущее системное UTC, ускорение 1
+
+	void advance(double realSeconds);
+
+	const JulianDate& utc() const { return current; }
+	JulianDate tt() const { return TimeScales::utcToTt(current); }
+
+	void setUtc(const JulianDate& utc);
+	void resetToNow() { setUtc(JulianDate::now()); }
+
+	void setWarp(double warp) { this->warp = warp; }
+	double getWarp() const { return warp; }
+	void setPaused(bool paused) { this->paused = paused; }
+	bool isPaused() const { return paused; }
+
+private:
+	// Модельные секунды копятся от опорного момента, а не прибавляются к дате
+	// по шагу, чтобы ошибка округления не росла с числом шагов
+	JulianDate anchor;
+	double elapsedSeconds = 0.0;
+	JulianDate current;
+	double warp = 1.0;
+	bool paused = false;
+};
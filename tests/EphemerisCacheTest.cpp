@@ -0,0 +1,104 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "../src/orbit/EphemerisCache.h"
+
+// Граница ошибки EphemerisCache: положения из кэша против прямого SGP4 на
+// плотной сетке в двое суток. Околоземный почти круговой объект должен
+// укладываться в допуск без делений, "Молния" (e = 0.69) - за счёт делений
+// отрезков у перигея, а без делений (maxSplits = 0) - за счёт отрезков,
+// отданных SGP4 напрямую. Для сравнения печатается ошибка без сверки
+// (validateFit = false), она допуском не ограничена. Код возврата 0 - обе
+// орбиты в пределах допуска в обоих режимах
+
+namespace {
+
+	// Сверка идёт в серединах между узлами, а максимум ошибки многочлена
+	// может лежать чуть в стороне - небольшой запас
+	constexpr double toleranceMargin = 1.5;
+	constexpr double stepMinutes = 0.37;	// не кратно длине отрезка
+	constexpr double spanMinutes = 2.0 * 1440.0;
+
+	struct Sample {
+		const char* name;
+		const char* line1;
+		const char* line2;
+	};
+
+	const Sample samples[] = {
+		{ "ISS",
+		  "1 25544U 98067A   08264.51782528 -.00002182  00000-0 -11606-4 0  2927",
+		  "2 25544  51.6416 247.4627 0006703 130.5360 325.0288 15.72125391563537" },
+		{ "Molniya 08195",
+		  "1 08195U 75081A   06176.33215444  .00000099  00000-0  11873-3 0   813",
+		  "2 08195  64.1586 279.0717 6877146 264.7651  20.2257  2.00491383225656" },
+	};
+
+	struct Result {
+		double maxError = 0.0;	// км
+		size_t failures = 0;	// кэш не дал положения
+		EphemerisCache::Stats stats;
+	};
+
+	Result measure(const Sample& sample, const EphemerisSettings& settings)
+	{
+		SatelliteTle satellite{};
+		satellite.noradId = std::stoi(std::string(sample.line1 + 2, 5));
+		satellite.name = sample.name;
+		satellite.tleLine1 = sample.line1;
+		satellite.tleLine2 = sample.line2;
+		satellite.epoch = satellite.tleLine1.substr(18, 14);
+
+		SatelliteCatalog catalog;
+		SatelliteCatalog::Slot slot = catalog.upsert(satellite);
+		Sgp4Record record;
+		Sgp4::initialize(catalog.elements(slot), record);
+
+		EphemerisCache cache(catalog, settings);
+		Result result;
+		double epoch = record.epoch.value();
+		for (double minutes = 0.0; minutes < spanMinutes; minutes += stepMinutes) {
+			double jd = epoch + minutes / 1440.0;
+			glm::dvec3 cached, exact, velocity;
+			if (!cache.position(slot, jd, cached)) {
+				result.failures++;
+				continue;
+			}
+			Sgp4::propagate(record, Sgp4::minutesSinceEpoch(record, jd), exact, velocity);
+			result.maxError = std::max(result.maxError, glm::length(cached - exact));
+		}
+		result.stats = cache.stats();
+		return result;
+	}
+
+}
+
+int main()
+{
+	EphemerisSettings settings;
+	EphemerisSettings noSplits = settings;
+	noSplits.maxSplits = 0;
+	EphemerisSettings unchecked = settings;
+	unchecked.validateFit = false;
+
+	int failures = 0;
+	for (const Sample& sample : samples) {
+		Result unbounded = measure(sample, unchecked);
+		std::cout << sample.name << ": without validation max |dr| = " << unbounded.maxError << " km" << std::endl;
+
+		for (const EphemerisSettings* checked : { &settings, &noSplits }) {
+			Result bounded = measure(sample, *checked);
+			bool ok = bounded.failures == 0 && bounded.maxError <= checked->maxErrorKm * toleranceMargin;
+			std::cout << "  maxSplits " << checked->maxSplits << ": max |dr| = " << bounded.maxError
+				<< " km (tolerance " << checked->maxErrorKm << " km), " << bounded.stats.splits << " splits, "
+				<< bounded.stats.directSegments << " direct segments" << (ok ? "" : " FAILED") << std::endl;
+			if (!ok)
+				failures++;
+		}
+	}
+
+	return failures == 0 ? 0 : 1;
+}
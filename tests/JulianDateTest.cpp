@@ -0,0 +1,153 @@
+#include <iostream>
+#include <string>
+#include <random>
+#include <cmath>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#include "../src/time/JulianDate.h"
+
+// JulianDate и TimeScales: разбор эпохи TLE (век по двузначному году,
+// день года, доля суток), календарь и системные часы, таблица секунд
+// координации на каждом переключении и переходы UTC <-> TAI <-> UTC.
+// Даты секунд координации взяты из Bulletin C календарными датами, а не
+// из таблицы MJD в JulianDate.cpp. Код возврата 0 - все проверки прошли
+
+namespace {
+
+	int failures = 0;
+
+	void check(bool ok, const std::string& what)
+	{
+		if (!ok) {
+			std::cout << "FAILED: " << what << std::endl;
+			failures++;
+		}
+	}
+
+	// Первые сутки с новым TAI - UTC
+	struct LeapDate {
+		int year, month;
+		int taiMinusUtc;
+	};
+
+	const LeapDate leapDates[] = {
+		{ 1972, 1, 10 }, { 1972, 7, 11 }, { 1973, 1, 12 }, { 1974, 1, 13 }, { 1975, 1, 14 },
+		{ 1976, 1, 15 }, { 1977, 1, 16 }, { 1978, 1, 17 }, { 1979, 1, 18 }, { 1980, 1, 19 },
+		{ 1981, 7, 20 }, { 1982, 7, 21 }, { 1983, 7, 22 }, { 1985, 7, 23 }, { 1988, 1, 24 },
+		{ 1990, 1, 25 }, { 1991, 1, 26 }, { 1992, 7, 27 }, { 1993, 7, 28 }, { 1994, 7, 29 },
+		{ 1996, 1, 30 }, { 1997, 7, 31 }, { 1999, 1, 32 }, { 2006, 1, 33 }, { 2009, 1, 34 },
+		{ 2012, 7, 35 }, { 2015, 7, 36 }, { 2017, 1, 37 },
+	};
+
+	void checkLeapSeconds()
+	{
+		for (const LeapDate& leap : leapDates) {
+			std::string name = std::to_string(leap.year) + "-" + std::to_string(leap.month);
+			JulianDate midnight = JulianDate::fromCalendar(leap.year, leap.month, 1);
+			JulianDate before = midnight.addSeconds(-0.5);
+			check(TimeScales::leapSeconds(midnight) == leap.taiMinusUtc, "TAI - UTC from " + name);
+			if (leap.taiMinusUtc > 10)
+				check(TimeScales::leapSeconds(before) == leap.taiMinusUtc - 1, "TAI - UTC before " + name);
+
+			// Обратный переход точен по обе стороны от переключения
+			for (const JulianDate& utc : { before, midnight, midnight.addDays(0.25) }) {
+				JulianDate tai = TimeScales::utcToTai(utc);
+				double offset = tai.secondsSince(utc);
+				double back = TimeScales::taiToUtc(tai).secondsSince(utc);
+				check(std::fabs(offset - TimeScales::leapSeconds(utc)) < 1e-6, "UTC -> TAI at " + name);
+				check(std::fabs(back) < 1e-6, "UTC -> TAI -> UTC at " + name);
+			}
+		}
+
+		check(TimeScales::leapSeconds(JulianDate::fromCalendar(1960, 1, 1)) == 10, "TAI - UTC before 1972");
+		JulianDate utc = JulianDate::fromCalendar(2020, 6, 1);
+		check(std::fabs(TimeScales::utcToTt(utc).secondsSince(utc) - 69.184) < 1e-6, "TT - UTC in 2020");
+		check(std::fabs(TimeScales::ttToUtc(TimeScales::utcToTt(utc)).secondsSince(utc)) < 1e-6, "UTC -> TT -> UTC");
+	}
+
+	bool epochIs(const char* text, double day, double fraction)
+	{
+		JulianDate epoch;
+		return JulianDate::fromTleEpoch(text, std::string(text).size(), epoch)
+			&& epoch.day == day && epoch.fraction == fraction;
+	}
+
+	void checkTleEpochs()
+	{
+		// Эпохи образцов SGP4-VER (jdsatepoch у Вальядо)
+		check(epochIs("00179.78495062", 2451722.5, 0.78495062), "epoch 00179.78495062");
+		check(epochIs("08264.51782528", 2454729.5, 0.51782528), "epoch 08264.51782528");
+		check(epochIs("06176.46683397", 2453911.5, 0.46683397), "epoch 06176.46683397");
+
+		// Двузначный год: 57-99 - XX век, 00-56 - XXI
+		check(epochIs("57001.00000000", JulianDate::fromCalendar(1957, 1, 1).day, 0.0), "year 57 -> 1957");
+		check(epochIs("99365.50000000", JulianDate::fromCalendar(1999, 12, 31).day, 0.5), "year 99 -> 1999");
+		check(epochIs("00001.00000000", 2451544.5, 0.0), "year 00 -> 2000");
+		check(epochIs("56366.25000000", JulianDate::fromCalendar(2056, 12, 31).day, 0.25), "year 56 -> 2056");
+
+		// День года с пробелами вместо нулей и без дробной части
+		check(epochIs("24  1.5", JulianDate::fromCalendar(2024, 1, 1).day, 0.5), "space-padded day");
+		check(epochIs("24060", JulianDate::fromCalendar(2024, 2, 29).day, 0.0), "day without fraction");
+
+		JulianDate epoch;
+		check(!JulianDate::fromTleEpoch("a4001.5", 7, epoch), "reject non-digit year");
+		check(!JulianDate::fromTleEpoch("24000.5", 7, epoch), "reject day 0");
+		check(!JulianDate::fromTleEpoch("24367.5", 7, epoch), "reject day 367");
+		check(!JulianDate::fromTleEpoch("24", 2, epoch), "reject short text");
+
+		// Случайные эпохи против прежнего разбора через strtod: расхождение
+		// только в округлении одного double
+		std::mt19937 random(20240601);
+		std::uniform_int_distribution<int> years(0, 99), days(1, 365);
+		std::uniform_int_distribution<long long> fractions(0, 99999999);
+		double worst = 0.0;
+		for (int n = 0; n < 200000; n++) {
+			char text[16];
+			int yy = years(random), dayOfYear = days(random);
+			std::snprintf(text, sizeof(text), "%02d%03d.%08lld", yy, dayOfYear, fractions(random));
+			if (!JulianDate::fromTleEpoch(text, 14, epoch)) {
+				check(false, std::string("decode ") + text);
+				continue;
+			}
+			int year = yy < 57 ? 2000 + yy : 1900 + yy;
+			double reference = JulianDate::fromCalendar(year, 1, 1).value() - 1.0 + std::strtod(text + 2, nullptr);
+			worst = std::max(worst, std::fabs(epoch.value() - reference));
+		}
+		check(worst < 1e-9, "random epochs against strtod");
+		std::cout << "Random epochs: max difference from strtod " << worst * 86400e6 << " us" << std::endl;
+	}
+
+	void checkCalendar()
+	{
+		check(JulianDate::fromCalendar(2000, 1, 1, 12).value() == 2451545.0, "J2000");
+		check(JulianDate::fromSystemTime(std::chrono::system_clock::time_point()).value() == 2440587.5, "Unix epoch");
+
+		int year, month, day, hour, minute;
+		double second;
+		JulianDate::fromCalendar(2024, 2, 29, 13, 45, 30.25).toCalendar(year, month, day, hour, minute, second);
+		check(year == 2024 && month == 2 && day == 29 && hour == 13 && minute == 45 && std::fabs(second - 30.25) < 1e-6,
+			"calendar round trip");
+
+		// Системные часы, в том числе до 1970 года
+		using std::chrono::system_clock;
+		for (long long seconds : { 0LL, 1700000000LL, -86400LL * 365 - 1234 }) {
+			system_clock::time_point time = system_clock::time_point(std::chrono::seconds(seconds))
+				+ std::chrono::milliseconds(250);
+			auto back = JulianDate::fromSystemTime(time).toSystemTime();
+			double error = std::chrono::duration<double>(back - time).count();
+			check(std::fabs(error) < 1e-6, "system_clock round trip at " + std::to_string(seconds));
+		}
+	}
+
+}
+
+int main()
+{
+	checkLeapSeconds();
+	checkTleEpochs();
+	checkCalendar();
+	std::cout << "JulianDate: " << failures << " failed" << std::endl;
+	return failures == 0 ? 0 : 1;
+}
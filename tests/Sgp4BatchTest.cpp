@@ -0,0 +1,144 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+
+#include "../src/orbit/Sgp4Batch.h"
+
+// Векторные ветви Sgp4Batch против эталона propagateReference(): одни и те же
+// TLE проходят через скалярное ядро, AVX2 и AVX-512 (те, что поддерживает
+// процессор), сравниваются положение, скорость и код ошибки по каждому
+// объекту. Число объектов не кратно ширине вектора, чтобы задеть хвост
+// пакета; в наборе есть геостационар и "Молния" - они идут скалярным путём
+// SDP4 и должны совпадать с эталоном точно. Код возврата 0 - все ветви в допусках
+
+namespace {
+
+	// Векторный sincos и порядок операций с FMA дают расхождение в последних
+	// битах; на сутках распространения оно остаётся в пределах миллиметров
+	constexpr double positionToleranceKm = 1e-6;
+	constexpr double velocityToleranceKms = 1e-9;
+
+	struct Sample {
+		const char* line1;
+		const char* line2;
+	};
+
+	const Sample samples[] = {
+		// МКС: околоземный, почти круговой
+		{ "1 25544U 98067A   08264.51782528 -.00002182  00000-0 -11606-4 0  2927",
+		  "2 25544  51.6416 247.4627 0006703 130.5360 325.0288 15.72125391563537" },
+		// 00005: околоземный, e = 0.186
+		{ "1 00005U 58002B   00179.78495062  .00000023  00000-0  28098-4 0  4753",
+		  "2 00005  34.2682 348.7242 1859667 331.7664  19.3264 10.82419157413667" },
+		// Перигей ниже 220 км: упрощённая модель (isimp)
+		{ "1 25544U 98067A   08264.51782528 -.00002182  00000-0 -11606-4 0  2927",
+		  "2 25544  51.6416 247.4627 0006703 130.5360 325.0288 16.32125391563537" },
+		// 28626: геостационар, irez = 1
+		{ "1 28626U 05008A   06176.46683397 -.00000205  00000-0  10000-3 0  2190",
+		  "2 28626   0.0019 286.9433 0000335  13.7918  55.6504  1.00270176  4891" },
+		// 08195: "Молния", irez = 2
+		{ "1 08195U 75081A   06176.33215444  .00000099  00000-0  11873-3 0   813",
+		  "2 08195  64.1586 279.0717 6877146 264.7651  20.2257  2.00491383225656" },
+	};
+	constexpr int sampleCount = sizeof(samples) / sizeof(samples[0]);
+
+	// Копия образца со своим номером, сдвигом аномалии и общей эпохой
+	SatelliteTle makeSatellite(int noradId, const Sample& sample, double meanAnomaly)
+	{
+		SatelliteTle satellite{};
+		satellite.noradId = noradId;
+		satellite.name = "TEST " + std::to_string(noradId);
+		satellite.tleLine1 = sample.line1;
+		satellite.tleLine2 = sample.line2;
+
+		char field[16];
+		std::snprintf(field, sizeof(field), "%05d", noradId);
+		satellite.tleLine1.replace(2, 5, field);
+		satellite.tleLine2.replace(2, 5, field);
+		std::snprintf(field, sizeof(field), "%8.4f", meanAnomaly);
+		satellite.tleLine2.replace(43, 8, field);
+		satellite.tleLine1.replace(18, 14, "08264.51782528");
+		satellite.epoch = satellite.tleLine1.substr(18, 14);
+		return satellite;
+	}
+
+	struct Deviation {
+		double position = 0.0;
+		double velocity = 0.0;
+		size_t errorMismatches = 0;
+	};
+
+	Deviation compare(const Sgp4Batch::States& states, const Sgp4Batch::States& reference)
+	{
+		Deviation deviation;
+		for (size_t i = 0; i < reference.size(); i++) {
+			if (states.error[i] != reference.error[i]) {
+				deviation.errorMismatches++;
+				continue;
+			}
+			double dx = states.x[i] - reference.x[i];
+			double dy = states.y[i] - reference.y[i];
+			double dz = states.z[i] - reference.z[i];
+			double dvx = states.vx[i] - reference.vx[i];
+			double dvy = states.vy[i] - reference.vy[i];
+			double dvz = states.vz[i] - reference.vz[i];
+			deviation.position = std::max(deviation.position, std::sqrt(dx * dx + dy * dy + dz * dz));
+			deviation.velocity = std::max(deviation.velocity, std::sqrt(dvx * dvx + dvy * dvy + dvz * dvz));
+		}
+		return deviation;
+	}
+
+}
+
+int main()
+{
+	// 129 околоземных объектов: остаётся хвост и после AVX2, и после AVX-512
+	constexpr int count = 43 * sampleCount;
+	SatelliteCatalog catalog;
+	for (int i = 0; i < count; i++)
+		catalog.upsert(makeSatellite(i + 1, samples[i % sampleCount], std::fmod(i * 37.0, 360.0)));
+
+	Sgp4Batch batch;
+	batch.build(catalog);
+	std::cout << "Objects: " << batch.size() << " (" << batch.nearCount() << " near Earth, "
+		<< batch.deepCount() << " deep space), best ISA: " << Sgp4Batch::isaName(Sgp4Batch::detectIsa())
+		<< std::endl;
+
+	JulianDate epoch;
+	JulianDate::fromTleEpoch("08264.51782528", 14, epoch);
+	const double offsetsDays[] = { -1.0, 0.0, 0.37, 1.0, 3.5 };
+
+	int failures = 0;
+	Sgp4Batch::States reference, states;
+	for (SimdIsa isa : { SimdIsa::Scalar, SimdIsa::Avx2, SimdIsa::Avx512 }) {
+		if (isa > Sgp4Batch::detectIsa()) {
+			std::cout << Sgp4Batch::isaName(isa) << ": not supported, skipped" << std::endl;
+			continue;
+		}
+		batch.setIsa(isa);
+
+		Deviation worst;
+		for (double offset : offsetsDays) {
+			JulianDate jd = epoch.addDays(offset);
+			batch.propagateReference(jd, reference);
+			batch.propagate(jd, states);
+			Deviation deviation = compare(states, reference);
+			worst.position = std::max(worst.position, deviation.position);
+			worst.velocity = std::max(worst.velocity, deviation.velocity);
+			worst.errorMismatches += deviation.errorMismatches;
+		}
+
+		bool ok = worst.position <= positionToleranceKm && worst.velocity <= velocityToleranceKms &&
+			worst.errorMismatches == 0;
+		std::cout << Sgp4Batch::isaName(isa) << ": max |dr| = " << worst.position << " km, max |dv| = "
+			<< worst.velocity << " km/s, error code mismatches: " << worst.errorMismatches
+			<< (ok ? "" : " FAILED") << std::endl;
+		if (!ok)
+			failures++;
+	}
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "../src/orbit/Sgp4Batch.h"
+
+// Пропускная способность SGP4: распространений в секунду для скалярного
+// Sgp4::propagate() и Sgp4Batch на каждом доступном наборе инструкций.
+// Каталог синтетический: несколько реальных TLE размножены со сдвигом
+// средней аномалии и с общей эпохой, как у свежего каталога: резонансный
+// интегратор SDP4 идёт от эпохи, и со старыми эпохами замерялся бы он.
+// Аргументы: [число объектов] [шагов по времени]
+
+namespace {
+
+	using Clock = std::chrono::steady_clock;
+
+	const char* const sampleTles[][2] = {
+		{ "1 25544U 98067A   08264.51782528 -.00002182  00000-0 -11606-4 0  2927",
+		  "2 25544  51.6416 247.4627 0006703 130.5360 325.0288 15.72125391563537" },
+		{ "1 00005U 58002B   00179.78495062  .00000023  00000-0  28098-4 0  4753",
+		  "2 00005  34.2682 348.7242 1859667 331.7664  19.3264 10.82419157413667" },
+		{ "1 28626U 05008A   06176.46683397 -.00000205  00000-0  10000-3 0  2190",
+		  "2 28626   0.0019 286.9433 0000335  13.7918  55.6504  1.00270176  4891" },
+		{ "1 08195U 75081A   06176.33215444  .00000099  00000-0  11873-3 0   813",
+		  "2 08195  64.1586 279.0717 6877146 264.7651  20.2257  2.00491383225656" },
+	};
+
+	const char* const commonEpoch = "08264.51782528";
+
+	// Околоземных объектов в реальном каталоге большинство: на каждые
+	// nearPerDeep копий околоземных TLE приходится одна глубокого космоса
+	constexpr int nearPerDeep = 8;
+
+	SatelliteTle makeSatellite(int noradId, int sample, double meanAnomaly)
+	{
+		SatelliteTle satellite{};
+		satellite.noradId = noradId;
+		satellite.name = "BENCH " + std::to_string(noradId);
+		satellite.tleLine1 = sampleTles[sample][0];
+		satellite.tleLine2 = sampleTles[sample][1];
+
+		char field[16];
+		std::snprintf(field, sizeof(field), "%05d", noradId % 100000);
+		satellite.tleLine1.replace(2, 5, field);
+		satellite.tleLine2.replace(2, 5, field);
+		std::snprintf(field, sizeof(field), "%8.4f", meanAnomaly);
+		satellite.tleLine2.replace(43, 8, field);
+		satellite.tleLine1.replace(18, 14, commonEpoch);
+		satellite.epoch = commonEpoch;
+		return satellite;
+	}
+
+	void report(const std::string& name, size_t propagations, Clock::duration elapsed)
+	{
+		double seconds = std::chrono::duration<double>(elapsed).count();
+		std::cout << std::left << std::setw(24) << name << std::right << std::setw(12)
+			<< std::fixed << std::setprecision(0) << propagations / seconds << " prop/s  ("
+			<< std::setprecision(1) << seconds * 1e9 / propagations << " ns each)" << std::endl;
+	}
+
+}
+
+int main(int argc, char* argv[])
+{
+	int count = argc >= 2 ? std::atoi(argv[1]) : 20000;
+	int steps = argc >= 3 ? std::atoi(argv[2]) : 50;
+	if (count <= 0 || steps <= 0 || count > 99999) {
+		std::cerr << "Usage: Sgp4Benchmark [objects 1..99999] [steps]" << std::endl;
+		return 2;
+	}
+
+	SatelliteCatalog catalog;
+	for (int i = 0; i < count; i++) {
+		int sample = i % (nearPerDeep + 1) == nearPerDeep ? 2 + (i / (nearPerDeep + 1)) % 2 : i % 2;
+		catalog.upsert(makeSatellite(i + 1, sample, (i * 360.0) / count));
+	}
+
+	Sgp4Batch batch;
+	batch.build(catalog);
+	std::cout << "Objects: " << batch.size() << " (" << batch.nearCount() << " near Earth, "
+		<< batch.deepCount() << " deep space), steps: " << steps << std::endl;
+
+	// Сутки после эпохи, шаг 10 минут
+	JulianDate epoch;
+	JulianDate::fromTleEpoch(commonEpoch, 14, epoch);
+	auto timeAt = [epoch](int step) { return epoch.addDays(1.0 + step * 10.0 / 1440.0); };
+
+	// Скалярный путь: по одной записи, как без пакета
+	std::vector<Sgp4Record> records;
+	for (SatelliteCatalog::Slot slot : batch.slots()) {
+		Sgp4Record record;
+		Sgp4::initialize(catalog.elements(slot), record);
+		records.push_back(record);
+	}
+	double checksum = 0.0;
+	auto start = Clock::now();
+	for (int step = 0; step < steps; step++) {
+		JulianDate jd = timeAt(step);
+		for (const auto& record : records) {
+			glm::dvec3 position, velocity;
+			Sgp4::propagate(record, Sgp4::minutesSinceEpoch(record, jd), position, velocity);
+			checksum += position.x;
+		}
+	}
+	report("Sgp4::propagate", records.size() * steps, Clock::now() - start);
+
+	Sgp4Batch::States states;
+	states.resize(batch.size());
+	for (SimdIsa isa : { SimdIsa::Scalar, SimdIsa::Avx2, SimdIsa::Avx512 }) {
+		if (isa > Sgp4Batch::detectIsa())
+			break;
+		batch.setIsa(isa);
+		start = Clock::now();
+		for (int step = 0; step < steps; step++) {
+			batch.propagate(timeAt(step), states);
+			checksum += states.x[0];
+		}
+		report(std::string("Sgp4Batch ") + Sgp4Batch::isaName(isa), batch.size() * steps, Clock::now() - start);
+	}
+
+	// Не даёт компилятору выбросить расчёт
+	std::cout << "checksum " << std::setprecision(3) << checksum << std::endl;
+	return 0;
+}